@@ -0,0 +1,171 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "audioresampler.h"
+
+#include <QDebug>
+#include <QtMath>
+
+namespace olive {
+
+const int AudioResampler::kPhaseCount = 256;
+
+AudioResampler::AudioResampler(Quality quality) :
+  quality_(quality),
+  filter_speed_(0),
+  filter_radius_(0)
+{
+}
+
+void AudioResampler::set_quality(Quality quality)
+{
+  if (quality_ != quality) {
+    quality_ = quality;
+
+    // Invalidate filter so it's rebuilt on the next call
+    filter_radius_ = 0;
+  }
+}
+
+int AudioResampler::GetFilterRadius(double speed) const
+{
+  speed = qAbs(speed);
+
+  // When speeding up, the cutoff is lowered to the new Nyquist frequency which widens the kernel
+  return qCeil(GetZeroCrossings(quality_) * qMax(1.0, speed));
+}
+
+void AudioResampler::Process(const SampleBuffer *input, double start_position, double step, SampleBuffer *output, int output_offset, int output_count)
+{
+  if (!input->is_allocated() || !output->is_allocated()) {
+    qWarning() << "Tried to resample with an unallocated sample buffer";
+    return;
+  }
+
+  UpdateFilter(step);
+
+  const int input_count = input->sample_count();
+  const int channels = qMin(input->audio_params().channel_count(), output->audio_params().channel_count());
+  const int taps = filter_radius_ * 2;
+
+  for (int i=0; i<output_count; i++) {
+    double pos = start_position + static_cast<double>(i) * step;
+    double int_pos = std::floor(pos);
+    double phase = (pos - int_pos) * kPhaseCount;
+    int phase_index = static_cast<int>(phase);
+    float phase_t = static_cast<float>(phase - phase_index);
+
+    // Interpolate between the two nearest precomputed phases
+    const float* row_a = &filter_[phase_index * taps];
+    const float* row_b = row_a + taps;
+    for (int j=0; j<taps; j++) {
+      coefficients_[j] = row_a[j] + phase_t * (row_b[j] - row_a[j]);
+    }
+
+    // Clamp to the input, anything outside is silence
+    int64_t first = static_cast<int64_t>(int_pos) - filter_radius_ + 1;
+    int start_tap = static_cast<int>(qMax(int64_t(0), -first));
+    int end_tap = static_cast<int>(qMin(int64_t(taps), int64_t(input_count) - first));
+
+    for (int c=0; c<channels; c++) {
+      float sum = 0;
+
+      if (start_tap < end_tap) {
+        const float* src = input->data(c);
+
+        for (int j=start_tap; j<end_tap; j++) {
+          sum += src[first + j] * coefficients_[j];
+        }
+      }
+
+      output->data(c)[output_offset + i] = sum;
+    }
+  }
+}
+
+int AudioResampler::GetZeroCrossings(Quality quality)
+{
+  switch (quality) {
+  case kQualityFast:
+    return 8;
+  case kQualityStandard:
+    break;
+  case kQualityHigh:
+    return 32;
+  }
+
+  return 16;
+}
+
+void AudioResampler::UpdateFilter(double speed)
+{
+  speed = qAbs(speed);
+
+  int radius = GetFilterRadius(speed);
+
+  if (radius == filter_radius_ && qFuzzyCompare(speed, filter_speed_)) {
+    // Filter is already up to date
+    return;
+  }
+
+  filter_speed_ = speed;
+  filter_radius_ = radius;
+
+  const int taps = filter_radius_ * 2;
+  const double cutoff = 1.0 / qMax(1.0, speed);
+
+  // One extra row so the last phase can interpolate towards the next whole sample
+  filter_.resize((kPhaseCount + 1) * taps);
+  coefficients_.resize(taps);
+
+  for (int k=0; k<=kPhaseCount; k++) {
+    double frac = static_cast<double>(k) / kPhaseCount;
+    float* row = &filter_[k * taps];
+    double sum = 0;
+
+    for (int j=0; j<taps; j++) {
+      double x = (j - filter_radius_ + 1) - frac;
+
+      // Low-passed sinc
+      double sinc_x = M_PI * cutoff * x;
+      double sinc = qIsNull(sinc_x) ? 1.0 : std::sin(sinc_x) / sinc_x;
+
+      // Blackman window
+      double w = 0;
+      double n = x / filter_radius_;
+      if (qAbs(n) < 1.0) {
+        w = 0.42 + 0.5 * std::cos(M_PI * n) + 0.08 * std::cos(2.0 * M_PI * n);
+      }
+
+      double v = cutoff * sinc * w;
+      row[j] = static_cast<float>(v);
+      sum += v;
+    }
+
+    // Normalize for unity gain at DC
+    if (!qIsNull(sum)) {
+      for (int j=0; j<taps; j++) {
+        row[j] = static_cast<float>(row[j] / sum);
+      }
+    }
+  }
+}
+
+}
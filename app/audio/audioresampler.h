@@ -0,0 +1,102 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef AUDIORESAMPLER_H
+#define AUDIORESAMPLER_H
+
+#include <vector>
+
+#include "codec/samplebuffer.h"
+
+namespace olive {
+
+/**
+ * @brief Polyphase windowed-sinc resampler used for changing the speed of audio
+ *
+ * Output samples are addressed by their (fractional) position in the input buffer rather than by
+ * a running counter. Callers that render audio in chunks can therefore derive the start position
+ * of each chunk from its absolute time, and provided the input buffer includes GetFilterRadius()
+ * samples of context on either side, consecutive chunks join without any discontinuity, regardless
+ * of the order in which they were rendered.
+ *
+ * The filter table is kept between calls and only rebuilt when the speed or quality changes, and
+ * output is written into a caller-provided buffer, so processing does not allocate.
+ */
+class AudioResampler
+{
+public:
+  enum Quality {
+    /// 8 zero crossings per side
+    kQualityFast,
+
+    /// 16 zero crossings per side
+    kQualityStandard,
+
+    /// 32 zero crossings per side
+    kQualityHigh
+  };
+
+  AudioResampler(Quality quality = kQualityStandard);
+
+  Quality quality() const
+  {
+    return quality_;
+  }
+
+  void set_quality(Quality quality);
+
+  /**
+   * @brief Number of input samples the filter reads on either side of a position at this speed
+   */
+  int GetFilterRadius(double speed) const;
+
+  /**
+   * @brief Resample `input` into `output`
+   *
+   * Writes `output_count` samples per channel into `output`, starting at `output_offset`. Output
+   * sample `i` is the input evaluated at position `start_position + i * step`. A negative step
+   * reads the input backwards (for reversed clips). Positions outside the input are treated as
+   * silence.
+   */
+  void Process(const SampleBuffer* input, double start_position, double step,
+               SampleBuffer* output, int output_offset, int output_count);
+
+private:
+  static int GetZeroCrossings(Quality quality);
+
+  void UpdateFilter(double speed);
+
+  Quality quality_;
+
+  double filter_speed_;
+
+  int filter_radius_;
+
+  std::vector<float> filter_;
+
+  std::vector<float> coefficients_;
+
+  static const int kPhaseCount;
+
+};
+
+}
+
+#endif // AUDIORESAMPLER_H
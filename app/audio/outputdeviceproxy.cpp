@@ -26,13 +26,17 @@ namespace olive {
 
 AudioOutputDeviceProxy::AudioOutputDeviceProxy(QObject *parent) :
   QIODevice(parent),
-  device_(nullptr)
+  device_(nullptr),
+  tempo_processor_(nullptr)
 {
 }
 
 void AudioOutputDeviceProxy::SetParameters(const AudioParams &params)
 {
   params_ = params;
+
+  // Build tempo graphs for the common shuttle speeds now rather than when playback starts
+  tempo_pool_.SetParameters(params_);
 }
 
 void AudioOutputDeviceProxy::SetDevice(QIODevice* device, qint64 offset, int playback_speed)
@@ -55,8 +59,17 @@ void AudioOutputDeviceProxy::SetDevice(QIODevice* device, qint64 offset, int pla
 
   playback_speed_ = playback_speed;
 
+  // Any processor from a previous speed is holding audio from the previous position
+  ReleaseTempoProcessor();
+
   if (qAbs(playback_speed_) != 1) {
-    tempo_processor_.Open(params_, qAbs(playback_speed_));
+    // Prefer a prebuilt atempo graph, otherwise fall back to the cheaper time-stretch so we never
+    // build a filter graph on the audio thread
+    tempo_processor_ = tempo_pool_.Take(qAbs(playback_speed_));
+
+    if (!tempo_processor_) {
+      time_stretcher_.Open(params_, qAbs(playback_speed_));
+    }
   }
 }
 
@@ -67,9 +80,7 @@ void AudioOutputDeviceProxy::close()
   delete device_;
   device_ = nullptr;
 
-  if (tempo_processor_.IsOpen()) {
-    tempo_processor_.Close();
-  }
+  ReleaseTempoProcessor();
 }
 
 qint64 AudioOutputDeviceProxy::readData(char *data, qint64 maxlen)
@@ -78,34 +89,52 @@ qint64 AudioOutputDeviceProxy::readData(char *data, qint64 maxlen)
     return 0;
   }
 
-  qint64 read_count;
+  if (tempo_processor_) {
+    return ReadThroughProcessor(tempo_processor_, data, maxlen);
+  } else if (time_stretcher_.IsOpen()) {
+    return ReadThroughProcessor(&time_stretcher_, data, maxlen);
+  } else {
+    // If we aren't doing any tempo processing, simply passthrough the read signal
+    return ReverseAwareRead(data, maxlen);
+  }
+}
 
-  if (tempo_processor_.IsOpen()) {
+qint64 AudioOutputDeviceProxy::writeData(const char *data, qint64 maxSize)
+{
+  Q_UNUSED(data)
+  Q_UNUSED(maxSize)
 
-    while ((read_count = tempo_processor_.Pull(data, static_cast<int>(maxlen))) == 0) {
-      int dev_read = static_cast<int>(ReverseAwareRead(data, maxlen));
+  return 0;
+}
 
-      if (!dev_read) {
-        break;
-      }
+template<typename T>
+qint64 AudioOutputDeviceProxy::ReadThroughProcessor(T *processor, char *data, qint64 maxlen)
+{
+  qint64 read_count;
 
-      tempo_processor_.Push(data, dev_read);
+  while ((read_count = processor->Pull(data, static_cast<int>(maxlen))) == 0) {
+    int dev_read = static_cast<int>(ReverseAwareRead(data, maxlen));
+
+    if (!dev_read) {
+      break;
     }
 
-  } else {
-    // If we aren't doing any tempo processing, simply passthrough the read signal
-    read_count = ReverseAwareRead(data, maxlen);
+    processor->Push(data, dev_read);
   }
 
   return read_count;
 }
 
-qint64 AudioOutputDeviceProxy::writeData(const char *data, qint64 maxSize)
+void AudioOutputDeviceProxy::ReleaseTempoProcessor()
 {
-  Q_UNUSED(data)
-  Q_UNUSED(maxSize)
+  if (tempo_processor_) {
+    tempo_pool_.Return(tempo_processor_);
+    tempo_processor_ = nullptr;
+  }
 
-  return 0;
+  if (time_stretcher_.IsOpen()) {
+    time_stretcher_.Close();
+  }
 }
 
 qint64 AudioOutputDeviceProxy::ReverseAwareRead(char *data, qint64 maxlen)
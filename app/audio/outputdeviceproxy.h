@@ -24,7 +24,8 @@
 #include <QFile>
 
 #include "common/define.h"
-#include "tempoprocessor.h"
+#include "tempoprocessorpool.h"
+#include "timestretcher.h"
 
 namespace olive {
 
@@ -51,9 +52,18 @@ protected:
 private:
   qint64 ReverseAwareRead(char* data, qint64 maxlen);
 
+  template <typename T>
+  qint64 ReadThroughProcessor(T* processor, char* data, qint64 maxlen);
+
+  void ReleaseTempoProcessor();
+
   QIODevice* device_;
 
-  TempoProcessor tempo_processor_;
+  TempoProcessorPool tempo_pool_;
+
+  TempoProcessor* tempo_processor_;
+
+  TimeStretcher time_stretcher_;
 
   AudioParams params_;
 
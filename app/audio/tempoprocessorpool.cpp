@@ -0,0 +1,163 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "tempoprocessorpool.h"
+
+#include <QtConcurrent/QtConcurrent>
+
+namespace olive {
+
+const int TempoProcessorPool::kMaximumPooledSpeed = 4;
+
+TempoProcessorPool::TempoProcessorPool()
+{
+  // Speed 1 never needs tempo processing so we start at 2
+  for (int i=2; i<=kMaximumPooledSpeed; i++) {
+    Entry e;
+    e.ready = nullptr;
+    e.building = false;
+    entries_.insert(i, e);
+  }
+}
+
+TempoProcessorPool::~TempoProcessorPool()
+{
+  for (auto it=entries_.begin(); it!=entries_.end(); it++) {
+    if (it->building) {
+      stale_builds_.append(it->build);
+    }
+
+    if (it->ready) {
+      Destroy(it->ready);
+    }
+  }
+
+  foreach (const QFuture<TempoProcessor*>& f, stale_builds_) {
+    Destroy(f.result());
+  }
+}
+
+void TempoProcessorPool::SetParameters(const AudioParams &params)
+{
+  if (params_ == params) {
+    return;
+  }
+
+  params_ = params;
+
+  for (auto it=entries_.begin(); it!=entries_.end(); it++) {
+    // Graphs being built right now are for the old parameters, leave them to finish and discard
+    // them once they do
+    if (it->building) {
+      stale_builds_.append(it->build);
+      it->building = false;
+    }
+
+    if (it->ready) {
+      QtConcurrent::run(&TempoProcessorPool::Destroy, it->ready);
+      it->ready = nullptr;
+    }
+
+    StartBuild(&it.value(), it.key());
+  }
+}
+
+TempoProcessor *TempoProcessorPool::Take(int speed)
+{
+  CollectBuilds();
+
+  auto it = entries_.find(speed);
+  if (it == entries_.end() || !it->ready) {
+    return nullptr;
+  }
+
+  TempoProcessor* processor = it->ready;
+  it->ready = nullptr;
+
+  return processor;
+}
+
+void TempoProcessorPool::Return(TempoProcessor *processor)
+{
+  if (!processor) {
+    return;
+  }
+
+  int speed = qRound(processor->GetSpeed());
+
+  QtConcurrent::run(&TempoProcessorPool::Destroy, processor);
+
+  CollectBuilds();
+
+  auto it = entries_.find(speed);
+  if (it != entries_.end() && !it->ready && !it->building) {
+    StartBuild(&it.value(), speed);
+  }
+}
+
+TempoProcessor* TempoProcessorPool::Build(AudioParams params, int speed)
+{
+  TempoProcessor* processor = new TempoProcessor();
+
+  if (!processor->Open(params, speed)) {
+    delete processor;
+    return nullptr;
+  }
+
+  return processor;
+}
+
+void TempoProcessorPool::Destroy(TempoProcessor *processor)
+{
+  if (processor) {
+    processor->Close();
+    delete processor;
+  }
+}
+
+void TempoProcessorPool::StartBuild(Entry *entry, int speed)
+{
+  if (!params_.is_valid()) {
+    return;
+  }
+
+  entry->build = QtConcurrent::run(&TempoProcessorPool::Build, params_, speed);
+  entry->building = true;
+}
+
+void TempoProcessorPool::CollectBuilds()
+{
+  for (auto it=entries_.begin(); it!=entries_.end(); it++) {
+    if (it->building && it->build.isFinished()) {
+      it->ready = it->build.result();
+      it->building = false;
+    }
+  }
+
+  for (int i=0; i<stale_builds_.size(); i++) {
+    if (stale_builds_.at(i).isFinished()) {
+      QtConcurrent::run(&TempoProcessorPool::Destroy, stale_builds_.at(i).result());
+      stale_builds_.removeAt(i);
+      i--;
+    }
+  }
+}
+
+}
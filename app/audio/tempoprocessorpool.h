@@ -0,0 +1,111 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef TEMPOPROCESSORPOOL_H
+#define TEMPOPROCESSORPOOL_H
+
+#include <QFuture>
+#include <QMap>
+#include <QVector>
+
+#include "common/define.h"
+#include "tempoprocessor.h"
+
+namespace olive {
+
+/**
+ * @brief Set of ready-to-use TempoProcessors for the common shuttle speeds
+ *
+ * Building an atempo filter graph is too slow to do on the audio thread every time the playback
+ * speed changes. This pool builds one graph per common speed in the background whenever the
+ * audio parameters change. Taking a processor is instant, and when it's returned, a fresh graph is
+ * built in the background (a used graph still holds audio from its last position and can't be
+ * reset through the filter API).
+ *
+ * Graphs are built and destroyed on worker threads. A finished graph is only swapped into the pool
+ * the next time the owning thread calls in, so none of SetParameters(), Take() or Return() ever
+ * wait for a build. Only the destructor waits for builds that are still running.
+ *
+ * All functions must be called from the same thread.
+ */
+class TempoProcessorPool
+{
+public:
+  TempoProcessorPool();
+
+  ~TempoProcessorPool();
+
+  DISABLE_COPY_MOVE(TempoProcessorPool)
+
+  /**
+   * @brief Rebuild all processors for these audio parameters
+   *
+   * Processors for the old parameters are discarded straight away, so Take() returns nullptr
+   * until the new ones are ready.
+   */
+  void SetParameters(const AudioParams& params);
+
+  /**
+   * @brief Take a prebuilt processor for this speed
+   *
+   * Returns nullptr if this speed isn't pooled or its processor isn't ready yet, in which case
+   * the caller should fall back to a cheaper time-stretch.
+   */
+  TempoProcessor* Take(int speed);
+
+  /**
+   * @brief Return a processor obtained from Take() so it can be rebuilt for the next use
+   */
+  void Return(TempoProcessor* processor);
+
+  static const int kMaximumPooledSpeed;
+
+private:
+  struct Entry {
+    TempoProcessor* ready;
+    QFuture<TempoProcessor*> build;
+    bool building;
+  };
+
+  static TempoProcessor* Build(AudioParams params, int speed);
+
+  static void Destroy(TempoProcessor* processor);
+
+  void StartBuild(Entry* entry, int speed);
+
+  /**
+   * @brief Swap finished builds into the pool and discard any that were for old parameters
+   */
+  void CollectBuilds();
+
+  QMap<int, Entry> entries_;
+
+  /**
+   * @brief Builds for previous parameters that were still running when the parameters changed
+   */
+  QVector< QFuture<TempoProcessor*> > stale_builds_;
+
+  AudioParams params_;
+
+};
+
+}
+
+#endif // TEMPOPROCESSORPOOL_H
@@ -0,0 +1,155 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "timestretcher.h"
+
+#include <algorithm>
+#include <cstring>
+#include <QDebug>
+#include <QtMath>
+
+namespace olive {
+
+TimeStretcher::TimeStretcher() :
+  speed_(1.0),
+  open_(false),
+  grain_size_(0),
+  hop_size_(0),
+  input_position_(0),
+  output_read_index_(0)
+{
+}
+
+bool TimeStretcher::Open(const AudioParams &params, const double &speed)
+{
+  if (params.format() != AudioParams::kFormatFloat32) {
+    qWarning() << "TimeStretcher only supports packed float audio";
+    return false;
+  }
+
+  params_ = params;
+  speed_ = speed;
+
+  // 40ms grains overlapped by half, short enough to keep transients reasonably intact
+  grain_size_ = qMax(64, qRound(params_.sample_rate() * 0.04));
+  grain_size_ -= grain_size_ % 2;
+  hop_size_ = grain_size_ / 2;
+
+  // Periodic Hann window, which sums to exactly 1.0 at 50% overlap
+  window_.resize(grain_size_);
+  for (int i=0; i<grain_size_; i++) {
+    window_[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * M_PI * i / grain_size_));
+  }
+
+  int channels = params_.channel_count();
+
+  input_.clear();
+  input_.reserve(grain_size_ * channels * qMax(2, qCeil(speed_) * 2));
+  input_position_ = 0;
+
+  overlap_.assign(grain_size_ * channels, 0.0f);
+
+  output_.clear();
+  output_.reserve(grain_size_ * channels * 2);
+  output_read_index_ = 0;
+
+  open_ = true;
+
+  return true;
+}
+
+void TimeStretcher::Push(const char *data, int length)
+{
+  if (!open_) {
+    return;
+  }
+
+  const float* samples = reinterpret_cast<const float*>(data);
+  input_.insert(input_.end(), samples, samples + length / sizeof(float));
+}
+
+int TimeStretcher::Pull(char *data, int max_length)
+{
+  if (!open_) {
+    return 0;
+  }
+
+  const size_t channels = params_.channel_count();
+  const size_t max_samples = max_length / sizeof(float);
+
+  // Process as many grains as we have input for, or until we have enough output for this request
+  while (output_.size() - output_read_index_ < max_samples
+         && input_.size() / channels >= static_cast<size_t>(input_position_) + grain_size_) {
+    ProcessGrain();
+  }
+
+  size_t copy_count = qMin(max_samples, output_.size() - output_read_index_);
+
+  if (copy_count) {
+    memcpy(data, output_.data() + output_read_index_, copy_count * sizeof(float));
+    output_read_index_ += copy_count;
+
+    if (output_read_index_ == output_.size()) {
+      output_.clear();
+      output_read_index_ = 0;
+    }
+  }
+
+  return static_cast<int>(copy_count * sizeof(float));
+}
+
+void TimeStretcher::Close()
+{
+  open_ = false;
+
+  input_.clear();
+  overlap_.clear();
+  output_.clear();
+  output_read_index_ = 0;
+}
+
+void TimeStretcher::ProcessGrain()
+{
+  const int channels = params_.channel_count();
+  const float* src = input_.data() + static_cast<size_t>(input_position_) * channels;
+
+  // Overlap-add windowed grain
+  for (int i=0; i<grain_size_; i++) {
+    for (int j=0; j<channels; j++) {
+      overlap_[i * channels + j] += src[i * channels + j] * window_[i];
+    }
+  }
+
+  // The first hop is now complete, move it to the output
+  const int hop_samples = hop_size_ * channels;
+  output_.insert(output_.end(), overlap_.begin(), overlap_.begin() + hop_samples);
+
+  std::copy(overlap_.begin() + hop_samples, overlap_.end(), overlap_.begin());
+  std::fill(overlap_.end() - hop_samples, overlap_.end(), 0.0f);
+
+  // Advance the input by the hop scaled by speed and discard what we no longer need
+  input_position_ += hop_size_ * speed_;
+
+  size_t consumed = static_cast<size_t>(input_position_);
+  input_.erase(input_.begin(), input_.begin() + consumed * channels);
+  input_position_ -= consumed;
+}
+
+}
@@ -0,0 +1,84 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef TIMESTRETCHER_H
+#define TIMESTRETCHER_H
+
+#include <vector>
+
+#include "render/audioparams.h"
+
+namespace olive {
+
+/**
+ * @brief Lightweight overlap-add time stretcher for packed float audio
+ *
+ * Lower quality than FFmpeg's atempo, but opening, resetting and changing the speed only resize a
+ * few buffers, so it can be switched in on the audio thread for playback speeds that don't have a
+ * prebuilt TempoProcessor. Shares TempoProcessor's Push/Pull interface.
+ */
+class TimeStretcher
+{
+public:
+  TimeStretcher();
+
+  bool IsOpen() const
+  {
+    return open_;
+  }
+
+  bool Open(const AudioParams& params, const double &speed);
+
+  void Push(const char *data, int length);
+
+  int Pull(char* data, int max_length);
+
+  void Close();
+
+private:
+  void ProcessGrain();
+
+  AudioParams params_;
+
+  double speed_;
+
+  bool open_;
+
+  int grain_size_;
+
+  int hop_size_;
+
+  std::vector<float> window_;
+
+  std::vector<float> input_;
+
+  double input_position_;
+
+  std::vector<float> overlap_;
+
+  std::vector<float> output_;
+
+  size_t output_read_index_;
+
+};
+
+}
+
+#endif // TIMESTRETCHER_H
@@ -0,0 +1,235 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "imagesequencereader.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QtConcurrent/QtConcurrent>
+
+namespace olive {
+
+const int ImageSequenceReader::kReadThreadCount = 4;
+const int ImageSequenceReader::kPrefetchCount = 8;
+const int ImageSequenceReader::kMaxCursors = 4;
+
+ImageSequenceReader::ImageSequenceReader(const QString &decoder_id, const Decoder::CodecStream &stream,
+                                         int64_t first_frame, int64_t frame_count) :
+  decoder_id_(decoder_id),
+  stream_(stream),
+  first_frame_(first_frame),
+  frame_count_(frame_count),
+  last_accessed_(QDateTime::currentMSecsSinceEpoch()),
+  stats_()
+{
+  pool_.setMaxThreadCount(kReadThreadCount);
+}
+
+ImageSequenceReader::~ImageSequenceReader()
+{
+  pool_.waitForDone();
+}
+
+FramePtr ImageSequenceReader::GetFrame(int64_t frame_number, const Decoder::RetrieveVideoParams &params)
+{
+  QMutexLocker locker(&mutex_);
+
+  last_accessed_ = QDateTime::currentMSecsSinceEpoch();
+
+  Cursor* cursor = FindCursor(frame_number, params);
+
+  // Follow playback direction, staying put on repeated requests for the same frame
+  if (frame_number != cursor->last_frame) {
+    cursor->direction = (frame_number > cursor->last_frame) ? 1 : -1;
+    cursor->last_frame = frame_number;
+  }
+
+  cursor->last_accessed = last_accessed_;
+
+  // Drop frames that no consumer is near anymore, unless someone is still waiting for them
+  for (auto it=frames_.begin(); it!=frames_.end(); ) {
+    if (!it->waiters && !IsInWindow(it.key())) {
+      it = frames_.erase(it);
+    } else {
+      it++;
+    }
+  }
+
+  FrameKey key = {frame_number, params};
+
+  if (frames_.contains(key)) {
+    stats_.hits++;
+  } else {
+    stats_.misses++;
+    QueueRead(key);
+  }
+
+  for (int i=1; i<=kPrefetchCount; i++) {
+    FrameKey next = {frame_number + i * cursor->direction, params};
+
+    if (!FrameExists(next.frame)) {
+      break;
+    }
+
+    if (!frames_.contains(next)) {
+      QueueRead(next);
+    }
+  }
+
+  auto it = frames_.find(key);
+  it->waiters++;
+
+  while (!it->ready) {
+    frame_ready_.wait(&mutex_);
+
+    // The hash may have changed while we waited, but our entry can't have been removed
+    it = frames_.find(key);
+  }
+
+  it->waiters--;
+
+  return it->frame;
+}
+
+ImageSequenceReader::Statistics ImageSequenceReader::GetStatistics()
+{
+  QMutexLocker locker(&mutex_);
+
+  return stats_;
+}
+
+qint64 ImageSequenceReader::GetLastAccessedTime()
+{
+  QMutexLocker locker(&mutex_);
+
+  return last_accessed_;
+}
+
+ImageSequenceReader::Cursor *ImageSequenceReader::FindCursor(int64_t frame_number, const Decoder::RetrieveVideoParams &params)
+{
+  // Assumes mutex_ is locked
+  Cursor* nearest = nullptr;
+  int64_t nearest_distance = 0;
+
+  for (int i=0; i<cursors_.size(); i++) {
+    Cursor& c = cursors_[i];
+
+    if (c.params == params) {
+      int64_t distance = qAbs(frame_number - c.last_frame);
+
+      if (distance <= kPrefetchCount * 2 && (!nearest || distance < nearest_distance)) {
+        nearest = &c;
+        nearest_distance = distance;
+      }
+    }
+  }
+
+  if (nearest) {
+    return nearest;
+  }
+
+  // Too far from every consumer we know, treat it as a new one replacing the least recently used
+  Cursor c = {params, frame_number, 1, 0};
+
+  if (cursors_.size() < kMaxCursors) {
+    cursors_.append(c);
+    return &cursors_.last();
+  }
+
+  int oldest = 0;
+  for (int i=1; i<cursors_.size(); i++) {
+    if (cursors_.at(i).last_accessed < cursors_.at(oldest).last_accessed) {
+      oldest = i;
+    }
+  }
+
+  cursors_[oldest] = c;
+  return &cursors_[oldest];
+}
+
+bool ImageSequenceReader::IsInWindow(const FrameKey &key) const
+{
+  foreach (const Cursor& c, cursors_) {
+    if (c.params == key.params) {
+      int64_t distance = (key.frame - c.last_frame) * c.direction;
+
+      if (distance >= 0 && distance <= kPrefetchCount) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+void ImageSequenceReader::QueueRead(const FrameKey &key)
+{
+  // Assumes mutex_ is locked
+  frames_.insert(key, {nullptr, false, 0});
+
+  QtConcurrent::run(&pool_, this, &ImageSequenceReader::Read, key);
+}
+
+void ImageSequenceReader::Read(FrameKey key)
+{
+  QString filename = Decoder::TransformImageSequenceFileName(stream_.filename(), key.frame);
+
+  QElapsedTimer timer;
+  timer.start();
+
+  FramePtr frame = nullptr;
+  DecoderPtr decoder = Decoder::CreateFromID(decoder_id_);
+
+  if (decoder && decoder->Open(Decoder::CodecStream(filename, stream_.stream()))) {
+    frame = decoder->RetrieveVideo(Decoder::kAnyTimecode, key.params);
+    decoder->Close();
+  }
+
+  qint64 elapsed = timer.nsecsElapsed();
+  qint64 file_size = QFileInfo(filename).size();
+
+  QMutexLocker locker(&mutex_);
+
+  stats_.frames_read++;
+  stats_.bytes_read += file_size;
+  stats_.read_nsecs += elapsed;
+
+  auto it = frames_.find(key);
+
+  // The window may have moved on while we were reading, in which case this frame is dropped
+  if (it != frames_.end() && !it->ready) {
+    it->frame = frame;
+    it->ready = true;
+  }
+
+  frame_ready_.wakeAll();
+}
+
+bool ImageSequenceReader::FrameExists(int64_t frame_number) const
+{
+  if (frame_number < first_frame_) {
+    return false;
+  }
+
+  return frame_count_ <= 0 || frame_number < first_frame_ + frame_count_;
+}
+
+}
@@ -0,0 +1,188 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef IMAGESEQUENCEREADER_H
+#define IMAGESEQUENCEREADER_H
+
+#include <memory>
+#include <QHash>
+#include <QMutex>
+#include <QThreadPool>
+#include <QVector>
+#include <QWaitCondition>
+
+#include "codec/decoder.h"
+#include "common/define.h"
+
+namespace olive {
+
+/**
+ * @brief Reads frames of an image sequence ahead of playback on a pool of I/O threads
+ *
+ * Every frame of an image sequence is a separate file, so without read-ahead each frame costs a
+ * full open and read on the render thread, which is latency-bound on network or RAID storage.
+ * GetFrame() returns the requested frame and queues the next frames in the direction playback is
+ * moving, keeping a bounded window of read and in-flight frames around the last request.
+ *
+ * Frames are keyed by their retrieval parameters, and each consumer (e.g. the viewer and an export
+ * reading the same sequence) is tracked with its own cursor, so consumers never drop or overwrite
+ * each other's frames.
+ *
+ * All functions are thread safe.
+ */
+class ImageSequenceReader
+{
+public:
+  /**
+   * @param stream
+   *
+   * Stream whose filename is the sequence's pattern, as passed to
+   * Decoder::TransformImageSequenceFileName().
+   *
+   * @param first_frame, frame_count
+   *
+   * Frame numbers that exist in the sequence, prefetching won't go outside these. A frame_count of
+   * 0 means the length is unknown.
+   */
+  ImageSequenceReader(const QString& decoder_id, const Decoder::CodecStream& stream,
+                      int64_t first_frame, int64_t frame_count);
+
+  ~ImageSequenceReader();
+
+  DISABLE_COPY_MOVE(ImageSequenceReader)
+
+  /**
+   * @brief Return a frame of the sequence, waiting for it to be read if necessary
+   *
+   * Returns nullptr if the frame couldn't be read.
+   */
+  FramePtr GetFrame(int64_t frame_number, const Decoder::RetrieveVideoParams& params);
+
+  struct Statistics {
+    /// Frames read from disk, including ones that were prefetched but never requested
+    int frames_read;
+
+    /// Total size of the files read
+    qint64 bytes_read;
+
+    /// Time spent opening and decoding files, summed across all I/O threads
+    qint64 read_nsecs;
+
+    /// Requests for frames that were already read or being read
+    int hits;
+
+    /// Requests that had to start a read
+    int misses;
+
+    /**
+     * @brief Average read throughput of a single I/O thread in bytes per second
+     */
+    double GetBytesPerSecond() const
+    {
+      return read_nsecs ? static_cast<double>(bytes_read) * 1000000000.0 / static_cast<double>(read_nsecs) : 0.0;
+    }
+  };
+
+  Statistics GetStatistics();
+
+  qint64 GetLastAccessedTime();
+
+  static const int kReadThreadCount;
+
+  static const int kPrefetchCount;
+
+  static const int kMaxCursors;
+
+private:
+  struct FrameKey {
+    int64_t frame;
+    Decoder::RetrieveVideoParams params;
+
+    bool operator==(const FrameKey& rhs) const
+    {
+      return frame == rhs.frame && params == rhs.params;
+    }
+
+    friend uint qHash(const FrameKey& k, uint seed = 0)
+    {
+      return ::qHash(static_cast<qint64>(k.frame), seed) ^ ::qHash(k.params.divider, seed)
+          ^ ::qHash((k.params.src_interlacing << 8) | k.params.dst_interlacing, seed);
+    }
+  };
+
+  struct Entry {
+    FramePtr frame;
+    bool ready;
+
+    /// Number of GetFrame() calls waiting for this frame, it isn't dropped while there are any
+    int waiters;
+  };
+
+  /**
+   * @brief Position and playback direction of one consumer of the sequence
+   */
+  struct Cursor {
+    Decoder::RetrieveVideoParams params;
+    int64_t last_frame;
+    int direction;
+    qint64 last_accessed;
+  };
+
+  Cursor* FindCursor(int64_t frame_number, const Decoder::RetrieveVideoParams& params);
+
+  bool IsInWindow(const FrameKey& key) const;
+
+  void QueueRead(const FrameKey& key);
+
+  void Read(FrameKey key);
+
+  bool FrameExists(int64_t frame_number) const;
+
+  QString decoder_id_;
+
+  Decoder::CodecStream stream_;
+
+  int64_t first_frame_;
+
+  int64_t frame_count_;
+
+  QThreadPool pool_;
+
+  QMutex mutex_;
+
+  QWaitCondition frame_ready_;
+
+  /// Read and in-flight frames, kept within kPrefetchCount of a cursor
+  QHash<FrameKey, Entry> frames_;
+
+  /// Recently active consumers, at most kMaxCursors
+  QVector<Cursor> cursors_;
+
+  qint64 last_accessed_;
+
+  Statistics stats_;
+
+};
+
+using ImageSequenceReaderPtr = std::shared_ptr<ImageSequenceReader>;
+
+}
+
+#endif // IMAGESEQUENCEREADER_H
@@ -20,6 +20,7 @@
 
 #include "oiiodecoder.h"
 
+#include <algorithm>
 #include <OpenImageIO/imagebufalgo.h>
 #include <QDebug>
 #include <QDir>
@@ -37,7 +38,8 @@ QStringList OIIODecoder::supported_formats_;
 
 OIIODecoder::OIIODecoder() :
   image_(nullptr),
-  buffer_(nullptr)
+  buffer_(nullptr),
+  buffer_divider_(0)
 {
 }
 
@@ -110,33 +112,33 @@ FramePtr OIIODecoder::RetrieveVideoInternal(const rational &timecode, const Retr
 {
   Q_UNUSED(timecode)
 
+  const OIIO::ImageSpec& spec = image_->spec();
+
   FramePtr frame = Frame::Create();
 
-  frame->set_video_params(VideoParams(buffer_->spec().width,
-                                      buffer_->spec().height,
+  frame->set_video_params(VideoParams(spec.width,
+                                      spec.height,
                                       pix_fmt_,
                                       channel_count_,
-                                      OIIOUtils::GetPixelAspectRatioFromOIIO(buffer_->spec()),
+                                      OIIOUtils::GetPixelAspectRatioFromOIIO(spec),
                                       VideoParams::kInterlaceNone, // FIXME: Does OIIO deinterlace for us?
                                       divider.divider));
-  frame->allocate();
-
-  if (divider.divider == 1) {
-
-    OIIOUtils::BufferToFrame(buffer_, frame.get());
-
-  } else {
 
-    // Will need to resize the image
-    OIIO::ImageBuf dst(OIIO::ImageSpec(frame->width(), frame->height(), buffer_->spec().nchannels, buffer_->spec().format));
+  if (buffer_divider_ != divider.divider) {
+    // Stills are usually retrieved at the same divider over and over, so we only decode again when
+    // the divider changes
+    delete buffer_;
+    buffer_ = ReadImage(frame->width(), frame->height());
+    buffer_divider_ = buffer_ ? divider.divider : 0;
+  }
 
-    if (!OIIO::ImageBufAlgo::resample(dst, *buffer_)) {
-      qWarning() << "OIIO resize failed";
-    }
+  if (!buffer_) {
+    return nullptr;
+  }
 
-    OIIOUtils::BufferToFrame(&dst, frame.get());
+  frame->allocate();
 
-  }
+  OIIOUtils::BufferToFrame(buffer_, frame.get());
 
   return frame;
 }
@@ -200,12 +202,137 @@ bool OIIODecoder::OpenImageHandler(const QString &fn)
     return false;
   }
 
-  buffer_ = new OIIO::ImageBuf(OIIO::ImageSpec(spec.width, spec.height, spec.nchannels, type),
-                               OIIO::InitializePixels::No);
+  // Pixels are read on the first retrieve, once we know what resolution is wanted
+  return true;
+}
+
+OIIO::ImageBuf *OIIODecoder::ReadImage(int width, int height)
+{
+  OIIO::TypeDesc::BASETYPE type = OIIOUtils::GetOIIOBaseTypeFromFormat(pix_fmt_);
+
+  // Find the smallest MIP level that's still at least as big as the output
+  int miplevel = 0;
+  OIIO::ImageSpec spec = image_->spec();
+
+  while (image_->seek_subimage(0, miplevel + 1)) {
+    const OIIO::ImageSpec& level_spec = image_->spec();
+
+    if (level_spec.width < width || level_spec.height < height) {
+      break;
+    }
+
+    miplevel++;
+    spec = level_spec;
+  }
+
+  OIIO::ImageBuf* buf = new OIIO::ImageBuf(OIIO::ImageSpec(width, height, spec.nchannels, type),
+                                           OIIO::InitializePixels::No);
 
-  image_->read_image(type, buffer_->localpixels());
+  bool success;
 
-  return true;
+  if (spec.width == width && spec.height == height) {
+    // This level is exactly the size we want, which is always the case at full resolution
+    success = image_->read_image(0, miplevel, 0, spec.nchannels, type, buf->localpixels());
+  } else {
+    int factor = qMax(1, qMin(spec.width / width, spec.height / height));
+    success = ReadDownsampled(spec, miplevel, factor, buf);
+  }
+
+  // Return to the full resolution image so spec() describes it again
+  image_->seek_subimage(0, 0);
+
+  if (!success) {
+    qWarning() << "Failed to read image:" << QString::fromStdString(image_->geterror());
+    delete buf;
+    return nullptr;
+  }
+
+  return buf;
+}
+
+bool OIIODecoder::ReadDownsampled(const OIIO::ImageSpec &spec, int miplevel, int factor, OIIO::ImageBuf *dst)
+{
+  const int nch = spec.nchannels;
+  const int box_width = (spec.width + factor - 1) / factor;
+  const int box_height = (spec.height + factor - 1) / factor;
+
+  OIIO::ImageBuf boxed(OIIO::ImageSpec(box_width, box_height, nch, OIIO::TypeDesc::FLOAT));
+  float* boxed_pixels = static_cast<float*>(boxed.localpixels());
+
+  // Tiled images are read a row of tiles at a time, scanline images one output row at a time
+  const int band_height = spec.tile_width ? spec.tile_height : factor;
+  std::vector<float> band(static_cast<size_t>(spec.width) * band_height * nch);
+
+  std::vector<float> sum(static_cast<size_t>(box_width) * nch, 0.0f);
+  int summed_rows = 0;
+  int box_y = 0;
+
+  for (int y=0; y<spec.height; y+=band_height) {
+    int rows = qMin(band_height, spec.height - y);
+    int ybegin = spec.y + y;
+
+    bool read;
+    if (spec.tile_width) {
+      read = image_->read_tiles(0, miplevel,
+                                spec.x, spec.x + spec.width,
+                                ybegin, ybegin + rows,
+                                spec.z, spec.z + 1,
+                                0, nch, OIIO::TypeDesc::FLOAT, band.data());
+    } else {
+      read = image_->read_scanlines(0, miplevel, ybegin, ybegin + rows, spec.z,
+                                    0, nch, OIIO::TypeDesc::FLOAT, band.data());
+    }
+
+    if (!read) {
+      return false;
+    }
+
+    for (int r=0; r<rows; r++) {
+      const float* src = band.data() + static_cast<size_t>(r) * spec.width * nch;
+
+      for (int x=0; x<spec.width; x++) {
+        float* s = sum.data() + (x / factor) * nch;
+
+        for (int c=0; c<nch; c++) {
+          s[c] += src[x * nch + c];
+        }
+      }
+
+      summed_rows++;
+
+      if (summed_rows == factor || y + r + 1 == spec.height) {
+        // Finished a row of boxes, boxes on the right and bottom edges may be smaller
+        float* box_row = boxed_pixels + static_cast<size_t>(box_y) * box_width * nch;
+
+        for (int x=0; x<box_width; x++) {
+          int summed_columns = qMin(factor, spec.width - x * factor);
+          float weight = 1.0f / static_cast<float>(summed_columns * summed_rows);
+
+          for (int c=0; c<nch; c++) {
+            box_row[x * nch + c] = sum[x * nch + c] * weight;
+          }
+        }
+
+        std::fill(sum.begin(), sum.end(), 0.0f);
+        summed_rows = 0;
+        box_y++;
+      }
+    }
+  }
+
+  if (box_width == dst->spec().width && box_height == dst->spec().height) {
+    return dst->copy_pixels(boxed);
+  }
+
+  // Integer boxes got us close, resample the small remainder
+  OIIO::ImageBuf resized(OIIO::ImageSpec(dst->spec().width, dst->spec().height, nch, OIIO::TypeDesc::FLOAT));
+
+  if (!OIIO::ImageBufAlgo::resample(resized, boxed)) {
+    qWarning() << "OIIO resize failed";
+    return false;
+  }
+
+  return dst->copy_pixels(resized);
 }
 
 void OIIODecoder::CloseImageHandle()
@@ -219,6 +346,8 @@ void OIIODecoder::CloseImageHandle()
     delete buffer_;
     buffer_ = nullptr;
   }
+
+  buffer_divider_ = 0;
 }
 
 }
@@ -56,12 +56,29 @@ private:
 
   void CloseImageHandle();
 
+  /**
+   * @brief Decode the image at (or close to) this size
+   *
+   * Reads from the smallest MIP level that's at least this big, and box-filters the level down
+   * while it's being read if it's still bigger, so reduced resolution decodes don't need the full
+   * image in memory.
+   */
+  OIIO::ImageBuf* ReadImage(int width, int height);
+
+  /**
+   * @brief Read a MIP level, averaging each `factor` x `factor` block of pixels as it goes
+   */
+  bool ReadDownsampled(const OIIO::ImageSpec& spec, int miplevel, int factor, OIIO::ImageBuf* dst);
+
   VideoParams::Format pix_fmt_;
 
   int channel_count_;
 
+  /// Last decoded image and the divider it was decoded for
   OIIO::ImageBuf* buffer_;
 
+  int buffer_divider_;
+
   static QStringList supported_formats_;
 
 };
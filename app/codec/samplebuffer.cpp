@@ -72,6 +72,17 @@ SampleBufferPtr SampleBuffer::CreateFromPackedData(const AudioParams &audio_para
   return buffer;
 }
 
+SampleBufferPtr SampleBuffer::CreateCopy(const SampleBuffer &other)
+{
+  SampleBufferPtr buffer = Create();
+
+  buffer->audio_params_ = other.audio_params_;
+  buffer->sample_count_per_channel_ = other.sample_count_per_channel_;
+  buffer->data_ = other.data_;
+
+  return buffer;
+}
+
 const AudioParams &SampleBuffer::audio_params() const
 {
   return audio_params_;
@@ -153,33 +164,6 @@ void SampleBuffer::reverse()
   }
 }
 
-void SampleBuffer::speed(double speed)
-{
-  if (!is_allocated()) {
-    qWarning() << "Tried to speed an unallocated sample buffer";
-    return;
-  }
-
-  sample_count_per_channel_ = qRound(static_cast<double>(sample_count_per_channel_) / speed);
-
-  QVector< QVector<float> > output_data;
-
-  output_data.resize(audio_params_.channel_count());
-  for (int i=0; i<audio_params_.channel_count(); i++) {
-    output_data[i].resize(sample_count_per_channel_);
-  }
-
-  for (int i=0;i<sample_count_per_channel_;i++) {
-    int input_index = qFloor(static_cast<double>(i) * speed);
-
-    for (int j=0;j<audio_params_.channel_count();j++) {
-      output_data[j][i] = data_[j][input_index];
-    }
-  }
-
-  data_ = output_data;
-}
-
 void SampleBuffer::transform_volume(float f)
 {
   for (int i=0;i<audio_params().channel_count();i++) {
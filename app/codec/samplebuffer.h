@@ -48,6 +48,14 @@ public:
   static SampleBufferPtr CreateAllocated(const AudioParams& audio_params, int samples_per_channel);
   static SampleBufferPtr CreateFromPackedData(const AudioParams& audio_params, const QByteArray& bytes);
 
+  /**
+   * @brief Create a buffer with the same parameters and samples as `other`
+   *
+   * The sample data is implicitly shared and only duplicated once either buffer is written to, so
+   * this is cheap for buffers that are only read.
+   */
+  static SampleBufferPtr CreateCopy(const SampleBuffer& other);
+
   DISABLE_COPY_MOVE(SampleBuffer)
 
   const AudioParams& audio_params() const;
@@ -71,7 +79,6 @@ public:
   void destroy();
 
   void reverse();
-  void speed(double speed);
   void transform_volume(float f);
   void transform_volume_for_channel(int channel, float volume);
   void transform_volume_for_sample(int sample_index, float volume);
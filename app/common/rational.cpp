@@ -7,6 +7,16 @@ namespace olive {
 
 const rational rational::NaN = rational(0, 0);
 
+rational rational::fromReduced(const intType &numerator, const intType &denominator)
+{
+  rational r(numerator);
+
+  r.denom_ = denominator;
+  r.fix_signs();
+
+  return r;
+}
+
 rational rational::fromDouble(const double &flt, bool* ok)
 {
   if (qIsNaN(flt)) {
@@ -305,14 +315,12 @@ bool rational::operator<(const rational &rhs) const
     return false;
   }
 
-  if (rhs == RATIONAL_MAX
-      || *this == RATIONAL_MIN) {
+  if (rhs.is_max() || is_min()) {
     // We will always wither be LESS THAN (true) or EQUAL (false)
     return (*this != rhs);
   }
 
-  if (*this == RATIONAL_MAX
-      || rhs == RATIONAL_MIN) {
+  if (is_max() || rhs.is_min()) {
     // We will always be GREATER THAN (false) or EQUAL (false)
     return false;
   }
@@ -338,14 +346,12 @@ bool rational::operator<=(const rational &rhs) const
     return true;
   }
 
-  if (rhs == RATIONAL_MAX
-      || *this == RATIONAL_MIN) {
+  if (rhs.is_max() || is_min()) {
     // We will always wither be LESS THAN (true) or EQUAL (true)
     return true;
   }
 
-  if (*this == RATIONAL_MAX
-      || rhs == RATIONAL_MIN) {
+  if (is_max() || rhs.is_min()) {
     // We will always be GREATER THAN (false) or EQUAL (true)
     return rhs == *this;
   }
@@ -57,6 +57,14 @@ public:
     reduce();
   }
 
+  /**
+   * @brief Construct from a numerator and a positive denominator that are already in lowest terms
+   *
+   * Skips the gcd reduction every other constructor does, for callers that can reduce more
+   * cheaply themselves.
+   */
+  static rational fromReduced(const intType& numerator, const intType& denominator);
+
   static rational fromDouble(const double& flt, bool *ok = nullptr);
   static rational fromString(const QString& str, bool* ok = nullptr);
 
@@ -124,6 +132,17 @@ private:
   intType numer_;
   intType denom_;
 
+  // Cheaper than comparing against RATIONAL_MAX/RATIONAL_MIN, which constructs a rational each time
+  bool is_max() const
+  {
+    return numer_ == INT64_MAX && denom_ == 1;
+  }
+
+  bool is_min() const
+  {
+    return numer_ == INT64_MIN && denom_ == 1;
+  }
+
   //Function: ensures denom >= 0
   void fix_signs();
   //Function: ensures lowest form
@@ -0,0 +1,105 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "ticktime.h"
+
+#include "timecodefunctions.h"
+
+namespace olive {
+
+TickTime TickTime::fromRational(const rational &time, const rational &timebase, bool *exact)
+{
+  int64_t ticks = Timecode::time_to_timestamp_floor(time, timebase);
+
+  if (exact) {
+    *exact = (rational(ticks) * timebase == time);
+  }
+
+  return TickTime(ticks, timebase);
+}
+
+TickTime TickTime::rescaled(const rational &timebase) const
+{
+  if (timebase == timebase_) {
+    return *this;
+  }
+
+  return fromRational(toRational(), timebase);
+}
+
+rational TickTime::commonTimebase(const rational &a, const rational &b)
+{
+  // Any time lands on the timebase 1/denominator, so the least common multiple of both
+  // denominators works for both
+  int64_t x = a.denominator();
+  int64_t y = b.denominator();
+
+  while (y) {
+    int64_t r = x % y;
+    x = y;
+    y = r;
+  }
+
+  return rational(1, a.denominator() / x * b.denominator());
+}
+
+TickTimeConverter::TickTimeConverter(const rational &timebase) :
+  timebase_(timebase)
+{
+  int64_t remaining = timebase_.denominator();
+
+  for (int64_t p=2; p*p<=remaining; p++) {
+    int count = 0;
+
+    while (remaining % p == 0) {
+      remaining /= p;
+      count++;
+    }
+
+    if (count) {
+      factors_.append({p, count});
+    }
+  }
+
+  if (remaining > 1) {
+    factors_.append({remaining, 1});
+  }
+}
+
+rational TickTimeConverter::toRational(const int64_t &ticks) const
+{
+  // The timebase is already in lowest terms, so the only factors ticks * numerator can share with
+  // the denominator are the ones ticks shares with it
+  int64_t numerator = ticks;
+  int64_t denominator = timebase_.denominator();
+
+  for (int i=0; i<factors_.size(); i++) {
+    const QPair<int64_t, int>& f = factors_.at(i);
+
+    for (int j=0; j<f.second && numerator % f.first == 0; j++) {
+      numerator /= f.first;
+      denominator /= f.first;
+    }
+  }
+
+  return rational::fromReduced(numerator * timebase_.numerator(), denominator);
+}
+
+}
@@ -0,0 +1,205 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef TICKTIME_H
+#define TICKTIME_H
+
+#include <QPair>
+#include <QVector>
+
+#include "rational.h"
+
+namespace olive {
+
+/**
+ * @brief Time stored as a whole number of ticks of a fixed timebase
+ *
+ * rational reduces by its gcd after every operation, which adds up on paths that step through
+ * thousands of evenly spaced times (frames of a sequence, samples of an audio buffer). Within a
+ * single timebase, TickTime arithmetic and comparisons are plain integer operations, and
+ * converting to and from rational is exact for any time that lands on a tick.
+ *
+ * Comparing or subtracting TickTimes of different timebases is a programming error; rescale one
+ * of them first.
+ */
+class TickTime
+{
+public:
+  TickTime() :
+    ticks_(0)
+  {
+  }
+
+  TickTime(int64_t ticks, const rational& timebase) :
+    ticks_(ticks),
+    timebase_(timebase)
+  {
+  }
+
+  /**
+   * @brief Convert a rational to the tick at or before it
+   *
+   * @param exact
+   *
+   * If non-null, set to whether `time` landed exactly on a tick.
+   */
+  static TickTime fromRational(const rational& time, const rational& timebase, bool* exact = nullptr);
+
+  rational toRational() const
+  {
+    return rational(ticks_ * timebase_.numerator(), timebase_.denominator());
+  }
+
+  double toDouble() const
+  {
+    return static_cast<double>(ticks_) * timebase_.toDouble();
+  }
+
+  const int64_t& ticks() const
+  {
+    return ticks_;
+  }
+
+  const rational& timebase() const
+  {
+    return timebase_;
+  }
+
+  /**
+   * @brief Returns this time in another timebase, rounded down to the tick at or before it
+   */
+  TickTime rescaled(const rational& timebase) const;
+
+  /**
+   * @brief Returns a timebase that both `a` and `b` land exactly on
+   */
+  static rational commonTimebase(const rational& a, const rational& b);
+
+  TickTime operator+(int64_t ticks) const
+  {
+    return TickTime(ticks_ + ticks, timebase_);
+  }
+
+  TickTime operator-(int64_t ticks) const
+  {
+    return TickTime(ticks_ - ticks, timebase_);
+  }
+
+  const TickTime& operator+=(int64_t ticks)
+  {
+    ticks_ += ticks;
+    return *this;
+  }
+
+  const TickTime& operator-=(int64_t ticks)
+  {
+    ticks_ -= ticks;
+    return *this;
+  }
+
+  TickTime& operator++()
+  {
+    ticks_++;
+    return *this;
+  }
+
+  /**
+   * @brief Returns the number of ticks between two times of the same timebase
+   */
+  int64_t operator-(const TickTime& rhs) const
+  {
+    Q_ASSERT(timebase_ == rhs.timebase_);
+    return ticks_ - rhs.ticks_;
+  }
+
+  bool operator<(const TickTime& rhs) const
+  {
+    Q_ASSERT(timebase_ == rhs.timebase_);
+    return ticks_ < rhs.ticks_;
+  }
+
+  bool operator<=(const TickTime& rhs) const
+  {
+    Q_ASSERT(timebase_ == rhs.timebase_);
+    return ticks_ <= rhs.ticks_;
+  }
+
+  bool operator>(const TickTime& rhs) const
+  {
+    Q_ASSERT(timebase_ == rhs.timebase_);
+    return ticks_ > rhs.ticks_;
+  }
+
+  bool operator>=(const TickTime& rhs) const
+  {
+    Q_ASSERT(timebase_ == rhs.timebase_);
+    return ticks_ >= rhs.ticks_;
+  }
+
+  bool operator==(const TickTime& rhs) const
+  {
+    return ticks_ == rhs.ticks_ && timebase_ == rhs.timebase_;
+  }
+
+  bool operator!=(const TickTime& rhs) const
+  {
+    return !(*this == rhs);
+  }
+
+private:
+  int64_t ticks_;
+
+  rational timebase_;
+
+};
+
+/**
+ * @brief Converts many ticks of one timebase to rational without a gcd per conversion
+ *
+ * TickTime::toRational() reduces its result like any other rational construction. A common
+ * factor of a tick count and the timebase can only be made of the timebase's prime factors, so
+ * this finds those once and each conversion just tries dividing by them.
+ */
+class TickTimeConverter
+{
+public:
+  TickTimeConverter(const rational& timebase);
+
+  rational toRational(const int64_t& ticks) const;
+
+  rational toRational(const TickTime& time) const
+  {
+    Q_ASSERT(time.timebase() == timebase_);
+    return toRational(time.ticks());
+  }
+
+private:
+  rational timebase_;
+
+  /**
+   * @brief Prime factors of the timebase's denominator and how many times each divides it
+   */
+  QVector< QPair<int64_t, int> > factors_;
+
+};
+
+}
+
+#endif // TICKTIME_H
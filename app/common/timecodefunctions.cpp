@@ -285,6 +285,41 @@ int64_t Timecode::time_to_timestamp(const double &time, const rational &timebase
   return qRound64(time * timebase.flipped().toDouble());
 }
 
+int64_t Timecode::time_to_timestamp_floor(const rational &time, const rational &timebase)
+{
+  rational r = time / timebase;
+
+  if (r.denominator() == 0) {
+    return 0;
+  }
+
+  int64_t q = r.numerator() / r.denominator();
+
+  // Integer division truncates towards zero
+  if (q * r.denominator() > r.numerator()) {
+    q--;
+  }
+
+  return q;
+}
+
+int64_t Timecode::time_to_timestamp_ceil(const rational &time, const rational &timebase)
+{
+  rational r = time / timebase;
+
+  if (r.denominator() == 0) {
+    return 0;
+  }
+
+  int64_t q = r.numerator() / r.denominator();
+
+  if (q * r.denominator() < r.numerator()) {
+    q++;
+  }
+
+  return q;
+}
+
 int64_t Timecode::rescale_timestamp(const int64_t &ts, const rational &source, const rational &dest)
 {
   if (source == dest) {
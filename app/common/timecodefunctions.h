@@ -60,6 +60,12 @@ public:
   static int64_t time_to_timestamp(const rational& time, const rational& timebase);
   static int64_t time_to_timestamp(const double& time, const rational& timebase);
 
+  /**
+   * @brief Exact floor/ceiling of a time in units of `timebase`, without rounding through a double
+   */
+  static int64_t time_to_timestamp_floor(const rational& time, const rational& timebase);
+  static int64_t time_to_timestamp_ceil(const rational& time, const rational& timebase);
+
   static int64_t rescale_timestamp(const int64_t& ts, const rational& source, const rational& dest);
   static int64_t rescale_timestamp_ceil(const int64_t& ts, const rational& source, const rational& dest);
 
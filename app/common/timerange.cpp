@@ -20,9 +20,13 @@
 
 #include "timerange.h"
 
+#include <algorithm>
+#include <limits>
 #include <QtMath>
 #include <utility>
 
+#include "timecodefunctions.h"
+
 namespace olive {
 
 TimeRange::TimeRange(const rational &in, const rational &out) :
@@ -176,64 +180,98 @@ void TimeRange::normalize()
   length_ = out_ - in_;
 }
 
+// Comparisons for binary searching a TimeRangeList, which is sorted by both in and out points
+static bool RangeEndsBefore(const TimeRange& r, const rational& t)
+{
+  return r.out() < t;
+}
+
+static bool TimeIsBeforeRangeEnd(const rational& t, const TimeRange& r)
+{
+  return t < r.out();
+}
+
+static bool RangeStartsBefore(const TimeRange& r, const rational& t)
+{
+  return r.in() < t;
+}
+
+static bool TimeIsBeforeRangeStart(const rational& t, const TimeRange& r)
+{
+  return t < r.in();
+}
+
+TimeRangeList::TimeRangeList(std::initializer_list<TimeRange> r)
+{
+  for (const TimeRange& range : r) {
+    insert(range);
+  }
+}
+
 void TimeRangeList::insert(TimeRange range_to_add)
 {
-  // See if list contains this range
-  if (contains(range_to_add)) {
+  // Ranges touching this one are merged with it as well as ones overlapping it
+  auto first = std::lower_bound(array_.begin(), array_.end(), range_to_add.in(), RangeEndsBefore);
+  auto last = std::upper_bound(first, array_.end(), range_to_add.out(), TimeIsBeforeRangeStart);
+
+  if (first == last) {
+    array_.insert(first, range_to_add);
     return;
   }
 
-  // Does not contain range, so we'll almost certainly be adding it in some way
-  for (int i=0;i<size();i++) {
-    const TimeRange& compare = array_.at(i);
-
-    if (compare.OverlapsWith(range_to_add)) {
-      range_to_add = TimeRange::Combine(range_to_add, compare);
-      array_.removeAt(i);
-      i--;
-    }
+  if (last - first == 1 && first->Contains(range_to_add)) {
+    // Already in the list
+    return;
   }
 
-  array_.append(range_to_add);
+  *first = TimeRange(qMin(first->in(), range_to_add.in()),
+                     qMax((last - 1)->out(), range_to_add.out()));
+
+  array_.erase(first + 1, last);
 }
 
 void TimeRangeList::remove(const TimeRange &remove)
 {
-  int sz = this->size();
-
-  for (int i=0;i<sz;i++) {
-    TimeRange& compare = array_[i];
-
-    if (remove.Contains(compare)) {
-      // This element is entirely encompassed in this range, remove it
-      array_.removeAt(i);
-      i--;
-      sz--;
-    } else if (compare.Contains(remove, false, false)) {
-      // The remove range is within this element, only choice is to split the element into two
-      TimeRange new_range(remove.out(), compare.out());
-      compare.set_out(remove.in());
-      insert(new_range);
-      break;
-    } else if (compare.in() < remove.in() && compare.out() > remove.in()) {
-      // This element's out point overlaps the range's in, we'll trim it
-      compare.set_out(remove.in());
-    } else if (compare.in() < remove.out() && compare.out() > remove.out()) {
-      // This element's in point overlaps the range's out, we'll trim it
-      compare.set_in(remove.out());
-    }
+  if (remove.in() == remove.out()) {
+    return;
+  }
+
+  // Ranges that overlap the removed range, not counting ones that only touch it
+  auto first = std::upper_bound(array_.begin(), array_.end(), remove.in(), TimeIsBeforeRangeEnd);
+  auto last = std::lower_bound(first, array_.end(), remove.out(), RangeStartsBefore);
+
+  if (first == last) {
+    return;
+  }
+
+  // Parts of the first and last ranges either side of the removed range survive
+  TimeRange head(first->in(), remove.in());
+  TimeRange tail(remove.out(), (last - 1)->out());
+  bool keep_head = (first->in() < remove.in());
+  bool keep_tail = ((last - 1)->out() > remove.out());
+
+  int index = first - array_.begin();
+  array_.erase(first, last);
+
+  if (keep_tail) {
+    array_.insert(index, tail);
+  }
+
+  if (keep_head) {
+    array_.insert(index, head);
   }
 }
 
 bool TimeRangeList::contains(const TimeRange &range, bool in_inclusive, bool out_inclusive) const
 {
-  for (int i=0;i<size();i++) {
-    if (array_.at(i).Contains(range, in_inclusive, out_inclusive)) {
-      return true;
-    }
+  // Ranges don't touch, so the last one starting at or before this range is the only candidate
+  auto it = std::upper_bound(array_.cbegin(), array_.cend(), range.in(), TimeIsBeforeRangeStart);
+
+  if (it == array_.cbegin()) {
+    return false;
   }
 
-  return false;
+  return (it - 1)->Contains(range, in_inclusive, out_inclusive);
 }
 
 void TimeRangeList::shift(const rational &diff)
@@ -273,24 +311,94 @@ TimeRangeList TimeRangeList::Intersects(const TimeRange &range) const
 {
   TimeRangeList intersect_list;
 
-  for (int i=0;i<size();i++) {
-    const TimeRange& compare = array_.at(i);
-
-    if (compare.out() <= range.in() || compare.in() >= range.out()) {
-      // No intersect
-      continue;
-    } else {
-      // Crop the time range to the range and add it to the list
-      TimeRange cropped(qMax(range.in(), compare.in()),
-                        qMin(range.out(), compare.out()));
+  auto it = std::upper_bound(array_.cbegin(), array_.cend(), range.in(), TimeIsBeforeRangeEnd);
 
-      intersect_list.insert(cropped);
-    }
+  for (; it != array_.cend() && it->in() < range.out(); it++) {
+    // Crop the time range to the range, which keeps the list sorted and separated
+    intersect_list.array_.append(TimeRange(qMax(range.in(), it->in()),
+                                           qMin(range.out(), it->out())));
   }
 
   return intersect_list;
 }
 
+TimeRangeListFrameIterator::TimeRangeListFrameIterator() :
+  range_index_(0),
+  next_(0),
+  end_(0)
+{
+}
+
+TimeRangeListFrameIterator::TimeRangeListFrameIterator(const TimeRangeList &list, const rational &timebase) :
+  list_(list),
+  timebase_(timebase),
+  range_index_(0),
+  next_(std::numeric_limits<int64_t>::min()),
+  end_(std::numeric_limits<int64_t>::min())
+{
+  // If timebase is null, we'd never leave the first frame
+  Q_ASSERT(!timebase_.isNull());
+
+  SkipToNextRange();
+}
+
+bool TimeRangeListFrameIterator::GetNext(rational *time)
+{
+  if (!HasNext()) {
+    return false;
+  }
+
+  *time = Timecode::timestamp_to_time(next_, timebase_);
+
+  next_++;
+  SkipToNextRange();
+
+  return true;
+}
+
+QVector<rational> TimeRangeListFrameIterator::ToVector() const
+{
+  QVector<rational> times;
+  times.reserve(size());
+
+  TimeRangeListFrameIterator copy = *this;
+  rational t;
+  while (copy.GetNext(&t)) {
+    times.append(t);
+  }
+
+  return times;
+}
+
+int TimeRangeListFrameIterator::size() const
+{
+  int64_t count = qMax(int64_t(0), end_ - next_);
+  int64_t last_end = end_;
+
+  for (int i=range_index_; i<list_.size(); i++) {
+    const TimeRange& r = list_.at(i);
+
+    int64_t start = qMax(last_end, Timecode::time_to_timestamp_floor(r.in(), timebase_));
+    last_end = Timecode::time_to_timestamp_ceil(r.out(), timebase_);
+
+    count += qMax(int64_t(0), last_end - start);
+  }
+
+  return static_cast<int>(count);
+}
+
+void TimeRangeListFrameIterator::SkipToNextRange()
+{
+  while (next_ >= end_ && range_index_ < list_.size()) {
+    const TimeRange& r = list_.at(range_index_);
+    range_index_++;
+
+    // A frame shared with the previous range has already been yielded
+    next_ = qMax(next_, Timecode::time_to_timestamp_floor(r.in(), timebase_));
+    end_ = Timecode::time_to_timestamp_ceil(r.out(), timebase_);
+  }
+}
+
 uint qHash(const TimeRange &r, uint seed)
 {
   return qHash(r.in(), seed) ^ qHash(r.out(), seed);
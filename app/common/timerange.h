@@ -67,14 +67,18 @@ private:
 
 };
 
+/**
+ * @brief Set of times stored as ranges sorted by in point
+ *
+ * Overlapping and touching ranges are merged as they're inserted, so the ranges never overlap and
+ * their out points are sorted too. That lets insert(), remove(), contains() and Intersects() find
+ * the ranges they affect with a binary search instead of walking the whole list.
+ */
 class TimeRangeList {
 public:
   TimeRangeList() = default;
 
-  TimeRangeList(std::initializer_list<TimeRange> r) :
-    array_(r)
-  {
-  }
+  TimeRangeList(std::initializer_list<TimeRange> r);
 
   void insert(TimeRange range_to_add);
 
@@ -117,6 +121,11 @@ public:
     return array_.constEnd();
   }
 
+  const TimeRange& at(int index) const
+  {
+    return array_.at(index);
+  }
+
   const TimeRange& first() const
   {
     return array_.first();
@@ -137,6 +146,50 @@ private:
 
 };
 
+/**
+ * @brief Walks every frame touching a TimeRangeList in order
+ *
+ * A frame is yielded once even if it's shared by two ranges less than a frame apart. Frame numbers
+ * are worked out once per range so long ranges don't snap every frame through rational arithmetic.
+ */
+class TimeRangeListFrameIterator
+{
+public:
+  TimeRangeListFrameIterator();
+  TimeRangeListFrameIterator(const TimeRangeList& list, const rational& timebase);
+
+  bool GetNext(rational* time);
+
+  bool HasNext() const
+  {
+    return next_ < end_;
+  }
+
+  /**
+   * @brief Returns all remaining frames without advancing the iterator
+   */
+  QVector<rational> ToVector() const;
+
+  /**
+   * @brief Returns the number of remaining frames
+   */
+  int size() const;
+
+private:
+  void SkipToNextRange();
+
+  TimeRangeList list_;
+
+  rational timebase_;
+
+  int range_index_;
+
+  int64_t next_;
+
+  int64_t end_;
+
+};
+
 uint qHash(const TimeRange& r, uint seed = 0);
 
 }
@@ -27,6 +27,7 @@
 #include <QStandardPaths>
 #include <QXmlStreamWriter>
 
+#include "audio/audioresampler.h"
 #include "common/autoscroll.h"
 #include "common/filefunctions.h"
 #include "common/xmlutils.h"
@@ -97,6 +98,7 @@ void Config::SetDefaults()
   SetEntryInternal(QStringLiteral("UseSliderLadders"), NodeValue::kBoolean, true);
 
   SetEntryInternal(QStringLiteral("AutoCacheDelay"), NodeValue::kInt, 1000);
+  SetEntryInternal(QStringLiteral("RendererCount"), NodeValue::kInt, 2);
 
   SetEntryInternal(QStringLiteral("CatColor0"), NodeValue::kInt, 0);
   SetEntryInternal(QStringLiteral("CatColor1"), NodeValue::kInt, 1);
@@ -113,6 +115,7 @@ void Config::SetDefaults()
 
   SetEntryInternal(QStringLiteral("AudioOutput"), NodeValue::kText, QString());
   SetEntryInternal(QStringLiteral("AudioInput"), NodeValue::kText, QString());
+  SetEntryInternal(QStringLiteral("AudioResampleQuality"), NodeValue::kInt, AudioResampler::kQualityStandard);
 
   SetEntryInternal(QStringLiteral("DiskCacheBehind"), NodeValue::kRational, QVariant::fromValue(rational(1)));
   SetEntryInternal(QStringLiteral("DiskCacheAhead"), NodeValue::kRational, QVariant::fromValue(rational(5)));
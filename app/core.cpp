@@ -47,6 +47,7 @@
 #include "dialog/preferences/preferences.h"
 #include "node/color/colormanager/colormanager.h"
 #include "node/factory.h"
+#include "node/project/projectautorecovery.h"
 #include "panel/panelmanager.h"
 #include "panel/project/project.h"
 #include "panel/viewer/viewer.h"
@@ -466,6 +467,8 @@ bool Core::AddOpenProjectFromTask(Task *task)
     AddOpenProject(project);
     main_window_->LoadLayout(layout);
 
+    RenderManager::instance()->PrecompileShaders(project);
+
     return true;
   } else {
     delete project;
@@ -833,11 +836,21 @@ void Core::SaveAutorecovery()
       if (!p->has_autorecovery_been_saved()) {
         QDir project_autorecovery_dir(QDir(FileFunctions::GetAutoRecoveryRoot()).filePath(p->GetUuid().toString()));
         if (project_autorecovery_dir.mkpath(QStringLiteral("."))) {
-          QString this_autorecovery_path = project_autorecovery_dir.filePath(QStringLiteral("%1.ove").arg(QString::number(QDateTime::currentSecsSinceEpoch())));
+          ProjectAutorecovery* recovery = p->findChild<ProjectAutorecovery*>(QString(), Qt::FindDirectChildrenOnly);
+
+          if (!recovery) {
+            recovery = new ProjectAutorecovery(p);
+          }
 
-          SaveProjectInternal(p, this_autorecovery_path);
+          // Snapshots the project and writes it in the background
+          QString this_autorecovery_path = recovery->Save(project_autorecovery_dir);
+
+          if (this_autorecovery_path.isEmpty()) {
+            // Still writing the previous recovery, try again next time
+            continue;
+          }
 
-          p->set_autorecovery_saved(true);
+          // The recovery marks the project as saved itself once the write has succeeded
 
           // Keep track of projects that where the "newest" save is the recovery project
           if (!autorecovered_projects_.contains(p->GetUuid())) {
@@ -866,12 +879,20 @@ void Core::SaveAutorecovery()
             for (int i=0; i<recovery_files.size(); i++) {
               const QString& f = recovery_files.at(i);
 
-              if (f.endsWith(QStringLiteral(".ove"), Qt::CaseInsensitive)) {
+              if (ProjectAutorecovery::IsRecoveryFilename(f)) {
                 QString delete_full_path = project_autorecovery_dir.filePath(f);
                 qDebug() << "Deleted old recovery:" << delete_full_path;
                 QFile::remove(delete_full_path);
                 recovery_files.removeAt(i);
                 deleted = true;
+
+                // Deltas directly after a deleted checkpoint depended on it, so they go too
+                while (i < recovery_files.size() && ProjectAutorecovery::IsDeltaFilename(recovery_files.at(i))) {
+                  delete_full_path = project_autorecovery_dir.filePath(recovery_files.at(i));
+                  qDebug() << "Deleted old recovery:" << delete_full_path;
+                  QFile::remove(delete_full_path);
+                  recovery_files.removeAt(i);
+                }
                 break;
               }
             }
@@ -1027,16 +1048,17 @@ QString Core::GetProjectFilter(bool include_any_filter)
 {
   QString filters;
 
-#ifdef USE_OTIO
   if (include_any_filter) {
-    filters.append(QStringLiteral("All Supported Projects (*.ove *.otio);;"));
-  }
+#ifdef USE_OTIO
+    filters.append(QStringLiteral("All Supported Projects (*.ove *.ovb *.otio);;"));
 #else
-  Q_UNUSED(include_any_filter)
+    filters.append(QStringLiteral("All Supported Projects (*.ove *.ovb);;"));
 #endif
+  }
 
-  // Append standard filter
+  // Append standard filters
   filters.append(QStringLiteral("%1 (*.ove)").arg(tr("Olive Project")));
+  filters.append(QStringLiteral(";;%1 (*.ovb)").arg(tr("Olive Binary Project")));
 
 #ifdef USE_OTIO
   filters.append(QStringLiteral(";;%2 (*.otio)").arg(tr("OpenTimelineIO")));
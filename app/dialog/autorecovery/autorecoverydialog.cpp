@@ -28,6 +28,7 @@
 #include <QVBoxLayout>
 
 #include "core.h"
+#include "node/project/projectautorecovery.h"
 
 namespace olive {
 
@@ -105,7 +106,7 @@ void AutoRecoveryDialog::PopulateTree(const QStringList& recoveries, bool autoch
       for (int i=0; i<entries.size(); i++) {
         const QString& entry = entries.at(i);
 
-        if (entry.endsWith(QStringLiteral(".ove"), Qt::CaseInsensitive)) {
+        if (ProjectAutorecovery::IsRecoveryFilename(entry)) {
           QTreeWidgetItem* entry_item = new QTreeWidgetItem(top_level);
 
           bool ok;
@@ -25,6 +25,7 @@
 #include <QLabel>
 
 #include "audio/audiomanager.h"
+#include "audio/audioresampler.h"
 #include "config/config.h"
 
 namespace olive {
@@ -48,6 +49,17 @@ PreferencesAudioTab::PreferencesAudioTab()
     }
     main_layout->addWidget(audio_backend_combobox_, row, 1);
 
+    row++;
+
+    main_layout->addWidget(new QLabel(tr("Speed Resampling Quality:")), row, 0);
+
+    resample_quality_combobox_ = new QComboBox();
+    resample_quality_combobox_->addItem(tr("Fast"), AudioResampler::kQualityFast);
+    resample_quality_combobox_->addItem(tr("Standard"), AudioResampler::kQualityStandard);
+    resample_quality_combobox_->addItem(tr("High"), AudioResampler::kQualityHigh);
+    resample_quality_combobox_->setCurrentIndex(resample_quality_combobox_->findData(Config::Current()["AudioResampleQuality"]));
+    main_layout->addWidget(resample_quality_combobox_, row, 1);
+
     audio_tab_layout->addLayout(main_layout);
   }
 
@@ -119,6 +131,8 @@ void PreferencesAudioTab::Accept(MultiUndoCommand *command)
 {
   Q_UNUSED(command)
 
+  Config::Current()["AudioResampleQuality"] = resample_quality_combobox_->currentData();
+
   // FIXME: Qt documentation states that QAudioDeviceInfo::deviceName() is a "unique identifiers", which would make them
   //        ideal for saving in preferences, but in practice they don't actually appear to be unique.
   //        See: https://bugreports.qt.io/browse/QTBUG-16841
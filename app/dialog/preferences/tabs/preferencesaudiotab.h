@@ -60,6 +60,11 @@ private:
    */
   QPushButton* refresh_devices_btn_;
 
+  /**
+   * @brief UI widget for selecting the quality of audio resampling for clip speed changes
+   */
+  QComboBox* resample_quality_combobox_;
+
 private slots:
   void RefreshDevices();
 
@@ -235,4 +235,10 @@ void Block::Hash(const QString &, QCryptographicHash &, const rational &, const
   // A block does nothing by default, so we hash nothing
 }
 
+bool Block::IsStaticOverTime(const QString &) const
+{
+  // Blocks exist over a limited time and derivatives like transitions change over it
+  return false;
+}
+
 }
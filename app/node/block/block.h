@@ -155,6 +155,15 @@ public:
 
   virtual void Hash(const QString& output, QCryptographicHash &hash, const rational &time, const VideoParams& video_params) const override;
 
+  virtual bool IsStaticOverTime(const QString& output) const override;
+
+  /**
+   * @brief Convert a time relative to the start of this block into a time in its media
+   */
+  rational SequenceToMediaTime(const rational& sequence_time, bool ignore_reverse = false) const;
+
+  rational MediaToSequenceTime(const rational& media_time) const;
+
   static const QString kLengthInput;
   static const QString kMediaInInput;
   static const QString kEnabledInput;
@@ -169,10 +178,6 @@ signals:
   void LengthChanged();
 
 protected:
-  rational SequenceToMediaTime(const rational& sequence_time, bool ignore_reverse = false) const;
-
-  rational MediaToSequenceTime(const rational& media_time) const;
-
   virtual void InputValueChangedEvent(const QString& input, int element) override;
 
   virtual void LinkChangeEvent() override;
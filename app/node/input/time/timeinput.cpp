@@ -74,4 +74,10 @@ void TimeInput::Hash(const QString &output, QCryptographicHash &hash, const rati
   hash.addData(NodeValue::ValueToBytes(NodeValue::kRational, QVariant::fromValue(time)));
 }
 
+bool TimeInput::IsStaticOverTime(const QString &) const
+{
+  // Outputs the current time
+  return false;
+}
+
 }
@@ -44,6 +44,8 @@ public:
 
   virtual void Hash(const QString& output, QCryptographicHash& hash, const rational& time, const VideoParams& video_params) const override;
 
+  virtual bool IsStaticOverTime(const QString& output) const override;
+
 };
 
 }
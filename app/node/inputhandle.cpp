@@ -0,0 +1,87 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "inputhandle.h"
+
+namespace olive {
+
+const InputHandle InputHandleRegistry::kInvalidHandle;
+const InputHandle InputHandleRegistry::kGlobalHandle;
+
+InputHandleRegistry::InputHandleRegistry()
+{
+  // Reserve handle 0 for NodeTraverser's globals
+  handles_.insert(QStringLiteral("global"), kGlobalHandle);
+  ids_.append(QStringLiteral("global"));
+}
+
+InputHandleRegistry *InputHandleRegistry::instance()
+{
+  static InputHandleRegistry registry;
+  return &registry;
+}
+
+InputHandle InputHandleRegistry::Intern(const QString &id)
+{
+  InputHandleRegistry* r = instance();
+
+  {
+    QReadLocker locker(&r->lock_);
+
+    InputHandle existing = r->handles_.value(id, kInvalidHandle);
+    if (existing != kInvalidHandle) {
+      return existing;
+    }
+  }
+
+  QWriteLocker locker(&r->lock_);
+
+  // Another thread may have interned this between the two locks
+  InputHandle existing = r->handles_.value(id, kInvalidHandle);
+  if (existing != kInvalidHandle) {
+    return existing;
+  }
+
+  InputHandle handle = r->ids_.size();
+  r->ids_.append(id);
+  r->handles_.insert(id, handle);
+
+  return handle;
+}
+
+InputHandle InputHandleRegistry::Find(const QString &id)
+{
+  InputHandleRegistry* r = instance();
+
+  QReadLocker locker(&r->lock_);
+
+  return r->handles_.value(id, kInvalidHandle);
+}
+
+QString InputHandleRegistry::GetID(InputHandle handle)
+{
+  InputHandleRegistry* r = instance();
+
+  QReadLocker locker(&r->lock_);
+
+  return r->ids_.value(handle);
+}
+
+}
@@ -0,0 +1,83 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef INPUTHANDLE_H
+#define INPUTHANDLE_H
+
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QVector>
+
+namespace olive {
+
+/**
+ * @brief Small integer standing in for an input ID string
+ *
+ * The same ID always maps to the same handle for the lifetime of the application, regardless of
+ * which node it belongs to, so handles can index flat arrays (see NodeValueDatabase).
+ */
+using InputHandle = int;
+
+/**
+ * @brief Application-wide table of interned input IDs
+ *
+ * Nodes intern their input IDs when the inputs are added, so looking a handle up during rendering
+ * only ever takes the read lock. All functions are thread-safe.
+ */
+class InputHandleRegistry
+{
+public:
+  /**
+   * @brief Get the handle for an ID, assigning it a new one if it hasn't been seen before
+   */
+  static InputHandle Intern(const QString& id);
+
+  /**
+   * @brief Get the handle for an ID, or kInvalidHandle if it was never interned
+   */
+  static InputHandle Find(const QString& id);
+
+  /**
+   * @brief Get the ID string a handle was created from
+   */
+  static QString GetID(InputHandle handle);
+
+  static const InputHandle kInvalidHandle = -1;
+
+  /// Handle of the "global" table that NodeTraverser adds to every database
+  static const InputHandle kGlobalHandle = 0;
+
+private:
+  InputHandleRegistry();
+
+  static InputHandleRegistry* instance();
+
+  QReadWriteLock lock_;
+
+  QHash<QString, InputHandle> handles_;
+
+  QVector<QString> ids_;
+
+};
+
+}
+
+#endif // INPUTHANDLE_H
@@ -28,7 +28,8 @@ namespace olive {
 
 NodeInputImmediate::NodeInputImmediate(NodeValue::Type type, const SplitValue &default_val) :
   default_value_(default_val),
-  keyframing_(false)
+  keyframing_(false),
+  data_type_(type)
 {
   set_data_type(type);
 }
@@ -179,10 +180,34 @@ void NodeInputImmediate::set_data_type(NodeValue::Type type)
 {
   int track_size = NodeValue::get_number_of_keyframe_tracks(type);
 
+  data_type_ = type;
+
   keyframe_tracks_.resize(track_size);
   standard_value_.resize(track_size);
 
   set_split_standard_value(default_value_);
+
+  invalidate_keyframe_curves();
+}
+
+KeyframeCurvePtr NodeInputImmediate::get_keyframe_curve(int track) const
+{
+  QMutexLocker locker(&keyframe_curve_lock_);
+
+  KeyframeCurvePtr& curve = keyframe_curves_[track];
+
+  if (!curve) {
+    curve = std::make_shared<KeyframeCurve>(keyframe_tracks_.at(track), data_type_);
+  }
+
+  return curve;
+}
+
+void NodeInputImmediate::invalidate_keyframe_curves()
+{
+  QMutexLocker locker(&keyframe_curve_lock_);
+
+  keyframe_curves_.fill(KeyframeCurvePtr(), keyframe_tracks_.size());
 }
 
 NodeKeyframe *NodeInputImmediate::get_earliest_keyframe() const
@@ -254,6 +279,8 @@ void NodeInputImmediate::insert_keyframe(NodeKeyframe* key)
   if (next) {
     next->set_previous(key);
   }
+
+  invalidate_keyframe_curves();
 }
 
 void NodeInputImmediate::remove_keyframe(NodeKeyframe *key)
@@ -270,6 +297,8 @@ void NodeInputImmediate::remove_keyframe(NodeKeyframe *key)
   key->set_next(nullptr);
 
   keyframe_tracks_[key->track()].removeOne(key);
+
+  invalidate_keyframe_curves();
 }
 
 void NodeInputImmediate::delete_all_keyframes(QObject* parent)
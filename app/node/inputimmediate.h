@@ -21,9 +21,12 @@
 #ifndef NODEINPUTIMMEDIATE_H
 #define NODEINPUTIMMEDIATE_H
 
+#include <QMutex>
+
 #include "common/timerange.h"
 #include "common/xmlutils.h"
 #include "node/keyframe.h"
+#include "node/keyframecurve.h"
 #include "node/value.h"
 #include "splitvalue.h"
 
@@ -153,6 +156,21 @@ public:
 
   void set_data_type(NodeValue::Type type);
 
+  /**
+   * @brief Get the compiled curve of a keyframe track for evaluation
+   *
+   * The curve is built on first use after the track changes. Safe to call from several threads.
+   */
+  KeyframeCurvePtr get_keyframe_curve(int track) const;
+
+  /**
+   * @brief Discard compiled curves so they're rebuilt from the keyframes on next use
+   *
+   * Insertions and removals do this automatically, but changes to a keyframe's value, type or
+   * bezier handles need to call this.
+   */
+  void invalidate_keyframe_curves();
+
 private:
   /**
    * @brief Non-keyframed value
@@ -176,6 +194,15 @@ private:
    */
   bool keyframing_;
 
+  NodeValue::Type data_type_;
+
+  /**
+   * @brief Lazily compiled version of each keyframe track, null if out of date
+   */
+  mutable QVector<KeyframeCurvePtr> keyframe_curves_;
+
+  mutable QMutex keyframe_curve_lock_;
+
 };
 
 }
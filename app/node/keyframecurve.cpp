@@ -0,0 +1,265 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "keyframecurve.h"
+
+#include <algorithm>
+#include <QtMath>
+
+#include "common/clamp.h"
+#include "common/lerp.h"
+
+namespace olive {
+
+namespace {
+
+double Polynomial(const double* c, double t)
+{
+  return ((c[3] * t + c[2]) * t + c[1]) * t + c[0];
+}
+
+void CubicCoefficients(double a, double b, double c, double d, double* out)
+{
+  out[0] = a;
+  out[1] = 3.0 * (b - a);
+  out[2] = 3.0 * (a - 2.0 * b + c);
+  out[3] = d - a + 3.0 * (b - c);
+}
+
+}
+
+KeyframeCurve::KeyframeCurve(const NodeKeyframeTrack &track, NodeValue::Type type) :
+  type_(type)
+{
+  const bool interpolate = NodeValue::type_can_be_interpolated(type_);
+
+  times_.reserve(track.size());
+  seconds_.reserve(track.size());
+  values_.reserve(track.size());
+  raw_values_.reserve(track.size());
+
+  foreach (NodeKeyframe* key, track) {
+    times_.push_back(key->time());
+    seconds_.push_back(key->time().toDouble());
+    raw_values_.append(key->value());
+
+    if (!interpolate) {
+      values_.push_back(0.0);
+    } else if (type_ == NodeValue::kRational) {
+      values_.push_back(key->value().value<rational>().toDouble());
+    } else {
+      values_.push_back(key->value().toDouble());
+    }
+  }
+
+  if (track.size() > 1) {
+    segments_.resize(track.size() - 1);
+  }
+
+  for (size_t i=0; i<segments_.size(); i++) {
+    Segment& s = segments_[i];
+    NodeKeyframe* before = track.at(static_cast<int>(i));
+    NodeKeyframe* after = track.at(static_cast<int>(i) + 1);
+
+    double before_time = seconds_[i];
+    double after_time = seconds_[i+1];
+    double before_val = values_[i];
+    double after_val = values_[i+1];
+
+    std::fill(s.x, s.x + 4, 0.0);
+    std::fill(s.y, s.y + 4, 0.0);
+
+    if (!interpolate || before->type() == NodeKeyframe::kHold) {
+
+      s.type = kSegmentHold;
+
+    } else if (before->type() == NodeKeyframe::kBezier && after->type() == NodeKeyframe::kBezier) {
+
+      s.type = kSegmentCubic;
+
+      QPointF out = before->valid_bezier_control_out();
+      QPointF in = after->valid_bezier_control_in();
+
+      CubicCoefficients(before_time, before_time + out.x(), after_time + in.x(), after_time, s.x);
+      CubicCoefficients(before_val, before_val + out.y(), after_val + in.y(), after_val, s.y);
+
+    } else if (before->type() == NodeKeyframe::kBezier || after->type() == NodeKeyframe::kBezier) {
+
+      s.type = kSegmentQuadratic;
+
+      double control_time, control_value;
+
+      if (before->type() == NodeKeyframe::kBezier) {
+        QPointF control = before->valid_bezier_control_out();
+        control_time = before_time + control.x();
+        control_value = before_val + control.y();
+      } else {
+        QPointF control = after->valid_bezier_control_in();
+        control_time = after_time + control.x();
+        control_value = after_val + control.y();
+      }
+
+      s.x[0] = before_time - control_time;
+      s.x[1] = before_time - 2.0 * control_time + after_time;
+      s.x[2] = control_time * control_time - before_time * after_time;
+      s.x[3] = before_time;
+
+      s.y[0] = before_val;
+      s.y[1] = 2.0 * (control_value - before_val);
+      s.y[2] = before_val - 2.0 * control_value + after_val;
+
+    } else {
+
+      s.type = kSegmentLinear;
+
+      s.x[0] = before_time;
+      s.x[1] = 1.0 / (after_time - before_time);
+
+      s.y[0] = before_val;
+      s.y[1] = after_val;
+
+    }
+  }
+}
+
+QVariant KeyframeCurve::ValueAt(const rational &time) const
+{
+  double seconds = time.toDouble();
+
+  return Evaluate(FindSegment(seconds), time, seconds);
+}
+
+QVector<QVariant> KeyframeCurve::ValuesAt(const QVector<rational> &times) const
+{
+  QVector<QVariant> values(times.size());
+
+  int segment = 0;
+  double last_seconds = 0;
+
+  for (int i=0; i<times.size(); i++) {
+    const rational& time = times.at(i);
+    double seconds = time.toDouble();
+
+    if (i == 0 || seconds < last_seconds) {
+      segment = FindSegment(seconds);
+    } else {
+      // Times are ascending, step forward from the last segment
+      while (segment < static_cast<int>(segments_.size()) - 1 && seconds_[segment+1] <= seconds) {
+        segment++;
+      }
+    }
+
+    values[i] = Evaluate(segment, time, seconds);
+    last_seconds = seconds;
+  }
+
+  return values;
+}
+
+int KeyframeCurve::FindSegment(double seconds) const
+{
+  if (segments_.empty()) {
+    return 0;
+  }
+
+  // Index of the last keyframe at or before this time, clamped to a valid segment
+  int index = static_cast<int>(std::upper_bound(seconds_.cbegin(), seconds_.cend(), seconds) - seconds_.cbegin()) - 1;
+
+  return clamp(index, 0, static_cast<int>(segments_.size()) - 1);
+}
+
+QVariant KeyframeCurve::Evaluate(int segment, const rational &time, double seconds) const
+{
+  if (seconds <= seconds_.front()) {
+    // This time precedes any keyframe, so we just return the first value
+    return raw_values_.first();
+  }
+
+  if (seconds >= seconds_.back()) {
+    // This time is after any keyframes so we return the last value
+    return raw_values_.last();
+  }
+
+  // Time == keyframe time, so value is precise
+  if (times_[segment] == time) {
+    return raw_values_.at(segment);
+  } else if (times_[segment+1] == time) {
+    return raw_values_.at(segment+1);
+  }
+
+  const Segment& s = segments_[segment];
+
+  switch (s.type) {
+  case kSegmentHold:
+    break;
+  case kSegmentLinear:
+    return FromDouble(lerp(s.y[0], s.y[1], (seconds - s.x[0]) * s.x[1]));
+  case kSegmentQuadratic:
+  {
+    double t;
+
+    if (qFuzzyIsNull(s.x[1])) {
+      // Control point is exactly halfway so time is linear in T
+      t = (seconds - s.x[3]) / (-2.0 * s.x[0]);
+    } else {
+      t = (s.x[0] + qSqrt(s.x[1] * seconds + s.x[2])) / s.x[1];
+    }
+
+    return FromDouble((s.y[2] * t + s.y[1]) * t + s.y[0]);
+  }
+  case kSegmentCubic:
+  {
+    // Bisect for the T that reaches this time, matching the tolerance of Bezier::CubicXtoT()
+    const double tolerance = 0.0001;
+    const int max_iterations = 64;
+
+    double lower = 0.0;
+    double upper = 1.0;
+    double t = 0.5;
+    double x = Polynomial(s.x, t);
+
+    for (int i=0; i<max_iterations && qAbs(seconds - x) > tolerance; i++) {
+      if (seconds > x) {
+        lower = t;
+      } else {
+        upper = t;
+      }
+
+      t = (upper + lower) * 0.5;
+      x = Polynomial(s.x, t);
+    }
+
+    return FromDouble(Polynomial(s.y, t));
+  }
+  }
+
+  return raw_values_.at(segment);
+}
+
+QVariant KeyframeCurve::FromDouble(double value) const
+{
+  if (type_ == NodeValue::kRational) {
+    return QVariant::fromValue(rational::fromDouble(value));
+  } else {
+    return value;
+  }
+}
+
+}
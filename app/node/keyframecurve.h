@@ -0,0 +1,123 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef KEYFRAMECURVE_H
+#define KEYFRAMECURVE_H
+
+#include <memory>
+#include <vector>
+
+#include "node/keyframe.h"
+#include "node/value.h"
+
+namespace olive {
+
+/**
+ * @brief Read-only copy of a keyframe track laid out for fast evaluation
+ *
+ * Keyframe times and values are unpacked from their NodeKeyframe objects into flat arrays once,
+ * and the interpolation between each pair of keyframes is reduced to polynomial coefficients, so
+ * evaluating the curve is a binary search plus a few multiplications instead of a scan over the
+ * keyframes converting rationals and QVariants at every step.
+ *
+ * A curve is never modified after it's built. NodeInputImmediate rebuilds it whenever the track
+ * changes, which makes it safe to share between render threads.
+ */
+class KeyframeCurve
+{
+public:
+  KeyframeCurve(const NodeKeyframeTrack& track, NodeValue::Type type);
+
+  bool isEmpty() const
+  {
+    return times_.empty();
+  }
+
+  int count() const
+  {
+    return static_cast<int>(times_.size());
+  }
+
+  /**
+   * @brief Get the value of this curve at a certain time
+   *
+   * Matches the value Node::GetSplitValueAtTimeOnTrack() would calculate from the keyframes. Must
+   * not be called on an empty curve.
+   */
+  QVariant ValueAt(const rational& time) const;
+
+  /**
+   * @brief Get the values of this curve at several times at once
+   *
+   * When `times` is sorted, each time's keyframes are found by stepping forward from the previous
+   * time's instead of searching again, which makes evaluating a run of audio samples linear.
+   *
+   * Times are evaluated as doubles against segments prepared up front, so this doesn't take
+   * TickTimes. The only rational operation left is checking whether a time is exactly on a
+   * keyframe, and keyframes can be anywhere rather than on any one timebase.
+   */
+  QVector<QVariant> ValuesAt(const QVector<rational>& times) const;
+
+private:
+  enum SegmentType {
+    kSegmentHold,
+    kSegmentLinear,
+    kSegmentQuadratic,
+    kSegmentCubic
+  };
+
+  /**
+   * @brief Interpolation between keyframe `i` and `i+1`
+   *
+   * Coefficients are ordered from the constant term up. Linear segments use `x[1]` as the
+   * reciprocal of the segment's duration. Quadratic segments use `x` for the terms of the closed
+   * form time to T solution (see Bezier::QuadraticXtoT()).
+   */
+  struct Segment {
+    SegmentType type;
+    double x[4];
+    double y[4];
+  };
+
+  int FindSegment(double seconds) const;
+
+  QVariant Evaluate(int segment, const rational& time, double seconds) const;
+
+  QVariant FromDouble(double value) const;
+
+  NodeValue::Type type_;
+
+  std::vector<rational> times_;
+
+  std::vector<double> seconds_;
+
+  std::vector<double> values_;
+
+  QVector<QVariant> raw_values_;
+
+  std::vector<Segment> segments_;
+
+};
+
+using KeyframeCurvePtr = std::shared_ptr<const KeyframeCurve>;
+
+}
+
+#endif // KEYFRAMECURVE_H
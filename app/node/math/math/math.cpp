@@ -88,6 +88,12 @@ ShaderCode MathNode::GetShaderCode(const QString &shader_id) const
   return GetShaderCodeInternal(shader_id, kParamAIn, kParamBIn);
 }
 
+QStringList MathNode::GetPrecompileShaderIDs() const
+{
+  // Shader IDs encode the operation and value types, which aren't known until render time
+  return QStringList();
+}
+
 NodeValueTable MathNode::Value(const QString &output, NodeValueDatabase &value) const
 {
   Q_UNUSED(output)
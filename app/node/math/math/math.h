@@ -43,6 +43,7 @@ public:
   virtual void Retranslate() override;
 
   virtual ShaderCode GetShaderCode(const QString &shader_id) const override;
+  virtual QStringList GetPrecompileShaderIDs() const override;
 
   Operation GetOperation() const
   {
@@ -25,8 +25,6 @@
 #include <QDebug>
 #include <QFile>
 
-#include "common/bezier.h"
-#include "common/lerp.h"
 #include "common/timecodefunctions.h"
 #include "common/xmlutils.h"
 #include "core.h"
@@ -590,108 +588,40 @@ SplitValue Node::GetSplitValueAtTime(const QString &input, const rational &time,
 QVariant Node::GetSplitValueAtTimeOnTrack(const QString &input, const rational &time, int track, int element) const
 {
   if (!IsUsingStandardValue(input, track, element)) {
-    const NodeKeyframeTrack& key_track = GetKeyframeTracks(input, element).at(track);
-
-    if (key_track.first()->time() >= time) {
-      // This time precedes any keyframe, so we just return the first value
-      return key_track.first()->value();
-    }
-
-    if (key_track.last()->time() <= time) {
-      // This time is after any keyframes so we return the last value
-      return key_track.last()->value();
-    }
-
-    NodeValue::Type type = GetInputDataType(input);
-
-    // If we're here, the time must be somewhere in between the keyframes
-    for (int i=0;i<key_track.size()-1;i++) {
-      NodeKeyframe* before = key_track.at(i);
-      NodeKeyframe* after = key_track.at(i+1);
-
-      if (before->time() == time
-          || !NodeValue::type_can_be_interpolated(type)
-          || (before->type() == NodeKeyframe::kHold && after->time() > time)) {
-
-        // Time == keyframe time, so value is precise
-        return before->value();
-
-      } else if (after->time() == time) {
-
-        // Time == keyframe time, so value is precise
-        return after->value();
-
-      } else if (before->time() < time && after->time() > time) {
-        // We must interpolate between these keyframes
-
-        double before_val, after_val, interpolated;
-        if (type == NodeValue::kRational) {
-          before_val = before->value().value<rational>().toDouble();
-          after_val = after->value().value<rational>().toDouble();
-        } else {
-          before_val = before->value().toDouble();
-          after_val = after->value().toDouble();
-        }
-
-        if (before->type() == NodeKeyframe::kBezier && after->type() == NodeKeyframe::kBezier) {
-          // Perform a cubic bezier with two control points
-
-          double t = Bezier::CubicXtoT(time.toDouble(),
-                                       before->time().toDouble(),
-                                       before->time().toDouble() + before->valid_bezier_control_out().x(),
-                                       after->time().toDouble() + after->valid_bezier_control_in().x(),
-                                       after->time().toDouble());
-
-          double y = Bezier::CubicTtoY(before_val,
-                                       before_val + before->valid_bezier_control_out().y(),
-                                       after_val + after->valid_bezier_control_in().y(),
-                                       after_val,
-                                       t);
-
-          interpolated = y;
-
-        } else if (before->type() == NodeKeyframe::kBezier || after->type() == NodeKeyframe::kBezier) {
-          // Perform a quadratic bezier with only one control point
-
-          QPointF control_point;
-          double control_point_time;
-          double control_point_value;
-
-          if (before->type() == NodeKeyframe::kBezier) {
-            control_point = before->valid_bezier_control_out();
-            control_point_time = before->time().toDouble() + control_point.x();
-            control_point_value = before_val + control_point.y();
-          } else {
-            control_point = after->valid_bezier_control_in();
-            control_point_time = after->time().toDouble() + control_point.x();
-            control_point_value = after_val + control_point.y();
-          }
+    return GetImmediate(input, element)->get_keyframe_curve(track)->ValueAt(time);
+  }
 
-          // Generate T from time values - used to determine bezier progress
-          double t = Bezier::QuadraticXtoT(time.toDouble(), before->time().toDouble(), control_point_time, after->time().toDouble());
+  return GetSplitStandardValueOnTrack(input, track, element);
+}
 
-          // Generate value using T
-          double y = Bezier::QuadraticTtoY(before_val, control_point_value, after_val, t);
+QVector<QVariant> Node::GetValuesAtTimes(const QString &input, const QVector<rational> &times, int element) const
+{
+  NodeValue::Type type = GetInputDataType(input);
+  int nb_tracks = GetNumberOfKeyframeTracks(input);
 
-          interpolated = y;
+  // Evaluate each track over all times, then combine them per time
+  QVector< QVector<QVariant> > track_values(nb_tracks);
 
-        } else {
-          // To have arrived here, the keyframes must both be linear
-          qreal period_progress = (time.toDouble() - before->time().toDouble()) / (after->time().toDouble() - before->time().toDouble());
+  for (int i=0; i<nb_tracks; i++) {
+    if (IsUsingStandardValue(input, i, element)) {
+      track_values[i].fill(GetSplitStandardValueOnTrack(input, i, element), times.size());
+    } else {
+      track_values[i] = GetImmediate(input, element)->get_keyframe_curve(i)->ValuesAt(times);
+    }
+  }
 
-          interpolated = lerp(before_val, after_val, period_progress);
-        }
+  QVector<QVariant> values(times.size());
+  SplitValue split(nb_tracks);
 
-        if (type == NodeValue::kRational) {
-          return QVariant::fromValue(rational::fromDouble(interpolated));
-        } else {
-          return interpolated;
-        }
-      }
+  for (int i=0; i<times.size(); i++) {
+    for (int j=0; j<nb_tracks; j++) {
+      split[j] = track_values.at(j).at(i);
     }
+
+    values[i] = NodeValue::combine_track_values_into_normal_value(type, split);
   }
 
-  return GetSplitStandardValueOnTrack(input, track, element);
+  return values;
 }
 
 QVariant Node::GetDefaultValue(const QString &input) const
@@ -1282,6 +1212,7 @@ void Node::InsertInput(const QString &id, NodeValue::Type type, const QVariant &
   i.array_size = 0;
 
   input_ids_.insert(index, id);
+  input_handles_.insert(index, InputHandleRegistry::Intern(id));
   input_data_.insert(index, i);
 
   if (!standard_immediates_.value(id, nullptr)) {
@@ -1301,6 +1232,7 @@ void Node::RemoveInput(const QString &id)
   }
 
   input_ids_.removeAt(index);
+  input_handles_.removeAt(index);
   input_data_.removeAt(index);
 
   emit InputRemoved(id);
@@ -1475,6 +1407,30 @@ void Node::Hash(const QString &output, QCryptographicHash &hash, const rational&
   }
 }
 
+bool Node::IsStaticOverTime(const QString &output) const
+{
+  auto inputs = inputs_for_output(output);
+
+  foreach (const QString& input, inputs) {
+    int nb_tracks = GetNumberOfKeyframeTracks(input);
+    int arr_sz = InputArraySize(input);
+
+    for (int i=-1; i<arr_sz; i++) {
+      if (IsInputConnected(input, i)) {
+        continue;
+      }
+
+      for (int j=0; j<nb_tracks; j++) {
+        if (!IsUsingStandardValue(input, j, i)) {
+          return false;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
 void Node::CopyInputs(const Node *source, Node *destination, bool include_connections)
 {
   Q_ASSERT(source->id() == destination->id());
@@ -1633,6 +1589,11 @@ ShaderCode Node::GetShaderCode(const QString &shader_id) const
   return ShaderCode(QString(), QString());
 }
 
+QStringList Node::GetPrecompileShaderIDs() const
+{
+  return {QString()};
+}
+
 void Node::ProcessSamples(NodeValueDatabase &, const SampleBufferPtr, SampleBufferPtr, int) const
 {
 }
@@ -2208,6 +2169,8 @@ void Node::childEvent(QChildEvent *event)
 void Node::InvalidateFromKeyframeBezierInChange()
 {
   NodeKeyframe* key = static_cast<NodeKeyframe*>(sender());
+  GetImmediate(key->input(), key->element())->invalidate_keyframe_curves();
+
   const NodeKeyframeTrack& track = GetTrackFromKeyframe(key);
   int keyframe_index = track.indexOf(key);
 
@@ -2224,6 +2187,8 @@ void Node::InvalidateFromKeyframeBezierInChange()
 void Node::InvalidateFromKeyframeBezierOutChange()
 {
   NodeKeyframe* key = static_cast<NodeKeyframe*>(sender());
+  GetImmediate(key->input(), key->element())->invalidate_keyframe_curves();
+
   const NodeKeyframeTrack& track = GetTrackFromKeyframe(key);
   int keyframe_index = track.indexOf(key);
 
@@ -2243,6 +2208,10 @@ void Node::InvalidateFromKeyframeTimeChange()
   NodeInputImmediate* immediate = GetImmediate(key->input(), key->element());
   TimeRange original_range = GetRangeAffectedByKeyframe(key);
 
+  // Neighboring bezier handles are limited by this keyframe's time so recompile even if it stays
+  // in order
+  immediate->invalidate_keyframe_curves();
+
   TimeRangeList invalidate_range;
   invalidate_range.insert(original_range);
 
@@ -2267,12 +2236,15 @@ void Node::InvalidateFromKeyframeTimeChange()
 void Node::InvalidateFromKeyframeValueChange()
 {
   NodeKeyframe* key = static_cast<NodeKeyframe*>(sender());
+  GetImmediate(key->input(), key->element())->invalidate_keyframe_curves();
   ParameterValueChanged(key->key_track_ref().input(), GetRangeAffectedByKeyframe(key));
 }
 
 void Node::InvalidateFromKeyframeTypeChanged()
 {
   NodeKeyframe* key = static_cast<NodeKeyframe*>(sender());
+  GetImmediate(key->input(), key->element())->invalidate_keyframe_curves();
+
   const NodeKeyframeTrack& track = GetTrackFromKeyframe(key);
 
   if (track.size() == 1) {
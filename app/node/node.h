@@ -34,6 +34,7 @@
 #include "common/timerange.h"
 #include "common/xmlutils.h"
 #include "node/keyframe.h"
+#include "node/inputhandle.h"
 #include "node/inputimmediate.h"
 #include "node/param.h"
 #include "render/audioparams.h"
@@ -189,6 +190,23 @@ public:
     return input_ids_;
   }
 
+  /**
+   * @brief Interned handles of inputs(), in the same order
+   */
+  const QVector<InputHandle>& input_handles() const
+  {
+    return input_handles_;
+  }
+
+  /**
+   * @brief Get the interned handle of one of this node's inputs
+   */
+  InputHandle GetInputHandle(const QString& id) const
+  {
+    int index = input_ids_.indexOf(id);
+    return (index == -1) ? InputHandleRegistry::kInvalidHandle : input_handles_.at(index);
+  }
+
   virtual QVector<QString> inputs_for_output(const QString& output) const
   {
     Q_UNUSED(output)
@@ -343,6 +361,13 @@ public:
     return GetSplitValueAtTimeOnTrack(input.input(), time, input.track());
   }
 
+  /**
+   * @brief Equivalent to calling GetValueAtTime() for each time, but faster for many times
+   *
+   * Intended for per-sample evaluation, where `times` is ascending.
+   */
+  QVector<QVariant> GetValuesAtTimes(const QString& input, const QVector<rational>& times, int element = -1) const;
+
   QVariant GetDefaultValue(const QString& input) const;
   SplitValue GetSplitDefaultValue(const QString& input) const;
   QVariant GetSplitDefaultValueOnTrack(const QString& input, int track) const;
@@ -531,6 +556,14 @@ public:
    */
   virtual ShaderCode GetShaderCode(const QString& shader_id) const;
 
+  /**
+   * @brief Shader IDs this node always uses, which can be compiled before anything is rendered
+   *
+   * Defaults to the empty ID used by nodes with a single shader. Nodes whose shader IDs depend on
+   * their inputs should return an empty list.
+   */
+  virtual QStringList GetPrecompileShaderIDs() const;
+
   /**
    * @brief If Value() pushes a ShaderJob, this is the function that will process them.
    */
@@ -735,6 +768,16 @@ public:
 
   virtual void Hash(const QString& output, QCryptographicHash& hash, const rational &time, const VideoParams& video_params) const;
 
+  /**
+   * @brief Returns whether this node's own contribution to an output is the same at any time
+   *
+   * Connected inputs aren't considered, NodeTraverser checks those itself to find whole subgraphs
+   * that render the same on every frame. By default, a node is static if none of the inputs it uses
+   * for this output are keyframed. Nodes that change over time in other ways (e.g. by reading the
+   * time global or decoding a video) must override this.
+   */
+  virtual bool IsStaticOverTime(const QString& output) const;
+
   void InvalidateAll(const QString& input, int element = -1);
 
   bool HasLinks() const
@@ -1201,6 +1244,7 @@ private:
   QVector<Node*> links_;
 
   QVector<QString> input_ids_;
+  QVector<InputHandle> input_handles_;
   QVector<Input> input_data_;
 
   QVector<QString> outputs_;
@@ -602,6 +602,12 @@ void Track::Hash(const QString &output, QCryptographicHash &hash, const rational
   }
 }
 
+bool Track::IsStaticOverTime(const QString &) const
+{
+  // Switches between blocks over time
+  return false;
+}
+
 void Track::EndOperation()
 {
   super::EndOperation();
@@ -103,34 +103,7 @@ void Footage::InputValueChangedEvent(const QString &input, int element)
       // Grab timestamp
       set_timestamp(info.lastModified().toMSecsSinceEpoch());
 
-      // Determine if we've already cached the metadata of this file
-      QString meta_cache_file = QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath(FileFunctions::GetUniqueFileIdentifier(filename()));
-
-      FootageDescription footage_info;
-
-      if (QFileInfo::exists(meta_cache_file)) {
-
-        // Load meta cache file
-        footage_info.Load(meta_cache_file);
-
-      } else {
-
-        // Probe and create cache
-        QVector<DecoderPtr> decoder_list = Decoder::ReceiveListOfAllDecoders();
-
-        foreach (DecoderPtr decoder, decoder_list) {
-          footage_info = decoder->Probe(filename(), cancelled_);
-
-          if (footage_info.IsValid()) {
-            break;
-          }
-        }
-
-        if (!footage_info.Save(meta_cache_file)) {
-          qWarning() << "Failed to save stream cache, footage will have to be re-probed";
-        }
-
-      }
+      FootageDescription footage_info = ProbeFile(filename(), cancelled_);
 
       if (footage_info.IsValid()) {
         decoder_ = footage_info.decoder();
@@ -192,6 +165,40 @@ void Footage::InputValueChangedEvent(const QString &input, int element)
   }
 }
 
+FootageDescription Footage::ProbeFile(const QString &filename, const QAtomicInt *cancelled)
+{
+  // Determine if we've already cached the metadata of this file
+  QString meta_cache_file = QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath(FileFunctions::GetUniqueFileIdentifier(filename));
+
+  FootageDescription footage_info;
+
+  if (QFileInfo::exists(meta_cache_file)) {
+
+    // Load meta cache file
+    footage_info.Load(meta_cache_file);
+
+  } else {
+
+    // Probe and create cache
+    QVector<DecoderPtr> decoder_list = Decoder::ReceiveListOfAllDecoders();
+
+    foreach (DecoderPtr decoder, decoder_list) {
+      footage_info = decoder->Probe(filename, cancelled);
+
+      if (footage_info.IsValid()) {
+        break;
+      }
+    }
+
+    if (!footage_info.Save(meta_cache_file)) {
+      qWarning() << "Failed to save stream cache, footage will have to be re-probed";
+    }
+
+  }
+
+  return footage_info;
+}
+
 rational Footage::VerifyLengthInternal(Track::Type type) const
 {
   if (type == Track::kVideo) {
@@ -368,6 +375,16 @@ void Footage::Hash(const QString& output, QCryptographicHash &hash, const ration
   }
 }
 
+bool Footage::IsStaticOverTime(const QString &output) const
+{
+  // Only still images are the same at every time
+  Track::Reference ref = Track::Reference::FromString(output);
+
+  return ref.type() == Track::kVideo
+      && GetVideoParams(ref.index()).video_type() == VideoParams::kVideoTypeStill
+      && super::IsStaticOverTime(output);
+}
+
 NodeValueTable Footage::Value(const QString &output, NodeValueDatabase &value) const
 {
   Track::Reference ref = Track::Reference::FromString(output);
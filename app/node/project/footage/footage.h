@@ -183,10 +183,20 @@ public:
 
   virtual void Hash(const QString& output, QCryptographicHash &hash, const rational &time, const VideoParams& video_params) const override;
 
+  virtual bool IsStaticOverTime(const QString& output) const override;
+
   virtual NodeValueTable Value(const QString &output, NodeValueDatabase& value) const override;
 
   static QString GetStreamTypeName(Track::Type type);
 
+  /**
+   * @brief Retrieve the streams of a file from the metadata cache, probing it if it isn't cached
+   *
+   * Doesn't touch any Footage so it can be called from any thread. A Footage created for the same
+   * file afterwards will find the result in the cache rather than probing again.
+   */
+  static FootageDescription ProbeFile(const QString& filename, const QAtomicInt* cancelled);
+
   virtual NodeOutput GetConnectedTextureOutput() override;
 
   virtual NodeOutput GetConnectedSampleOutput() override;
@@ -20,8 +20,10 @@
 
 #include "project.h"
 
+#include <QDataStream>
 #include <QDir>
 #include <QFileInfo>
+#include <QtConcurrent/QtConcurrent>
 
 #include "common/xmlutils.h"
 #include "core.h"
@@ -89,46 +91,10 @@ void Project::Load(QXmlStreamReader *reader, MainWindowLayoutInfo* layout, uint
 
       while (XMLReadNextStartElement(reader)) {
         if (reader->name() == QStringLiteral("node")) {
-          bool is_root = false;
-          bool is_cm = false;
-          bool is_settings = false;
-          QString id;
-
-          {
-            XMLAttributeLoop(reader, attr) {
-              if (attr.name() == QStringLiteral("id")) {
-                id = attr.value().toString();
-              } else if (attr.name() == QStringLiteral("root") && attr.value() == QStringLiteral("1")) {
-                is_root = true;
-              } else if (attr.name() == QStringLiteral("cm") && attr.value() == QStringLiteral("1")) {
-                is_cm = true;
-              } else if (attr.name() == QStringLiteral("settings") && attr.value() == QStringLiteral("1")) {
-                is_settings = true;
-              }
-            }
-          }
+          Node* node = LoadNode(reader, xml_node_data, version, cancelled);
 
-          if (id.isEmpty()) {
-            qWarning() << "Failed to load node with empty ID";
-          } else {
-            Node* node;
-
-            if (is_root) {
-              node = root_;
-            } else if (is_cm) {
-              node = color_manager_;
-            } else if (is_settings) {
-              node = settings_;
-            } else {
-              node = NodeFactory::CreateFromID(id);
-            }
-
-            if (!node) {
-              qWarning() << "Failed to find node with ID" << id;
-            } else {
-              node->Load(reader, xml_node_data, version, cancelled);
-              node->setParent(this);
-            }
+          if (node) {
+            node->setParent(this);
           }
         } else {
           reader->skipCurrentElement();
@@ -157,28 +123,230 @@ void Project::Save(QXmlStreamWriter *writer) const
   writer->writeStartElement(QStringLiteral("nodes"));
 
   foreach (Node* node, nodes()) {
-    writer->writeStartElement(QStringLiteral("node"));
-
-    if (node == root_) {
-      writer->writeAttribute(QStringLiteral("root"), QStringLiteral("1"));
-    } else if (node == color_manager_) {
-      writer->writeAttribute(QStringLiteral("cm"), QStringLiteral("1"));
-    } else if (node == settings_) {
-      writer->writeAttribute(QStringLiteral("settings"), QStringLiteral("1"));
+    SaveNode(writer, node);
+  }
+
+  writer->writeEndElement(); // nodes
+
+  // Save main window project layout
+  MainWindowLayoutInfo main_window_info = Core::instance()->main_window()->SaveLayout();
+  main_window_info.toXml(writer);
+}
+
+void Project::Load(ProjectContainer::Reader *reader, MainWindowLayoutInfo *layout, uint version, const QAtomicInt *cancelled)
+{
+  XMLNodeData xml_node_data;
+  QVector< QFuture<LoadedNode> > node_loads;
+  int layout_chunk = -1;
+
+  for (int i=0; i<reader->chunks().size(); i++) {
+    switch (static_cast<ProjectContainer::ChunkType>(reader->chunks().at(i).type)) {
+    case ProjectContainer::kChunkProject:
+    {
+      QByteArray data = reader->ReadChunk(i);
+      QDataStream stream(data);
+      stream >> uuid_;
+      break;
     }
+    case ProjectContainer::kChunkProjectNode:
+    {
+      // These nodes already exist in this thread so they're loaded here
+      QByteArray data = reader->ReadChunk(i);
+      QXmlStreamReader xml(data);
+
+      if (XMLReadNextStartElement(&xml)) {
+        LoadNode(&xml, xml_node_data, version, cancelled);
+      }
+      break;
+    }
+    case ProjectContainer::kChunkNode:
+      node_loads.append(QtConcurrent::run(this, &Project::LoadNodeChunk, reader, i, version, cancelled));
+      break;
+    case ProjectContainer::kChunkLayout:
+      layout_chunk = i;
+      break;
+    case ProjectContainer::kChunkInfo:
+    case ProjectContainer::kChunkBase:
+    case ProjectContainer::kChunkRemoved:
+      break;
+    }
+  }
 
-    writer->writeAttribute(QStringLiteral("id"), node->id());
+  // Add nodes in the order they were saved so the project comes out the same every time
+  foreach (const QFuture<LoadedNode>& f, node_loads) {
+    LoadedNode l = f.result();
 
-    node->Save(writer);
+    if (l.node) {
+      l.node->setParent(this);
 
-    writer->writeEndElement(); // node
+      for (auto it=l.xml_node_data.node_ptrs.cbegin(); it!=l.xml_node_data.node_ptrs.cend(); it++) {
+        xml_node_data.node_ptrs.insert(it.key(), it.value());
+      }
+      xml_node_data.desired_connections.append(l.xml_node_data.desired_connections);
+      xml_node_data.block_links.append(l.xml_node_data.block_links);
+    }
   }
 
-  writer->writeEndElement(); // nodes
+  // Layout refers to nodes so it's loaded once they all are
+  if (layout_chunk >= 0) {
+    QByteArray data = reader->ReadChunk(layout_chunk);
+    QXmlStreamReader xml(data);
+
+    if (XMLReadNextStartElement(&xml)) {
+      *layout = MainWindowLayoutInfo::fromXml(&xml, xml_node_data);
+    }
+  }
+
+  // Make connections
+  XMLConnectNodes(xml_node_data);
+
+  // Link blocks
+  XMLLinkBlocks(xml_node_data);
+}
+
+bool Project::Save(ProjectContainer::Writer *writer) const
+{
+  if (!writer->AddChunk(ProjectContainer::kChunkProject, SaveProjectChunk())) {
+    return false;
+  }
+
+  foreach (Node* node, nodes()) {
+    if (!writer->AddChunk(GetNodeChunkType(node), SaveNodeChunk(node), GetNodeChunkKey(node))) {
+      return false;
+    }
+  }
 
   // Save main window project layout
+  return writer->AddChunk(ProjectContainer::kChunkLayout, SaveLayoutChunk());
+}
+
+QByteArray Project::SaveNodeChunk(Node *node) const
+{
+  QByteArray data;
+  QXmlStreamWriter xml(&data);
+
+  SaveNode(&xml, node);
+
+  return data;
+}
+
+ProjectContainer::ChunkType Project::GetNodeChunkType(Node *node) const
+{
+  if (node == root_ || node == color_manager_ || node == settings_) {
+    return ProjectContainer::kChunkProjectNode;
+  } else {
+    return ProjectContainer::kChunkNode;
+  }
+}
+
+QByteArray Project::SaveProjectChunk() const
+{
+  QByteArray data;
+  QDataStream stream(&data, QIODevice::WriteOnly);
+
+  stream << uuid_;
+
+  return data;
+}
+
+QByteArray Project::SaveLayoutChunk()
+{
+  QByteArray data;
+  QXmlStreamWriter xml(&data);
+
   MainWindowLayoutInfo main_window_info = Core::instance()->main_window()->SaveLayout();
-  main_window_info.toXml(writer);
+  main_window_info.toXml(&xml);
+
+  return data;
+}
+
+Node *Project::LoadNode(QXmlStreamReader *reader, XMLNodeData &xml_node_data, uint version, const QAtomicInt *cancelled) const
+{
+  bool is_root = false;
+  bool is_cm = false;
+  bool is_settings = false;
+  QString id;
+
+  {
+    XMLAttributeLoop(reader, attr) {
+      if (attr.name() == QStringLiteral("id")) {
+        id = attr.value().toString();
+      } else if (attr.name() == QStringLiteral("root") && attr.value() == QStringLiteral("1")) {
+        is_root = true;
+      } else if (attr.name() == QStringLiteral("cm") && attr.value() == QStringLiteral("1")) {
+        is_cm = true;
+      } else if (attr.name() == QStringLiteral("settings") && attr.value() == QStringLiteral("1")) {
+        is_settings = true;
+      }
+    }
+  }
+
+  if (id.isEmpty()) {
+    qWarning() << "Failed to load node with empty ID";
+    reader->skipCurrentElement();
+    return nullptr;
+  }
+
+  Node* node;
+
+  if (is_root) {
+    node = root_;
+  } else if (is_cm) {
+    node = color_manager_;
+  } else if (is_settings) {
+    node = settings_;
+  } else {
+    node = NodeFactory::CreateFromID(id);
+  }
+
+  if (!node) {
+    qWarning() << "Failed to find node with ID" << id;
+    reader->skipCurrentElement();
+    return nullptr;
+  }
+
+  node->Load(reader, xml_node_data, version, cancelled);
+
+  return node;
+}
+
+Project::LoadedNode Project::LoadNodeChunk(ProjectContainer::Reader *reader, int chunk, uint version, const QAtomicInt *cancelled) const
+{
+  LoadedNode l;
+  l.node = nullptr;
+
+  QByteArray data = reader->ReadChunk(chunk);
+  QXmlStreamReader xml(data);
+
+  if (XMLReadNextStartElement(&xml)) {
+    l.node = LoadNode(&xml, l.xml_node_data, version, cancelled);
+
+    if (l.node) {
+      // Created in a worker thread, hand it over to the project's thread to be parented there
+      l.node->moveToThread(thread());
+    }
+  }
+
+  return l;
+}
+
+void Project::SaveNode(QXmlStreamWriter *writer, Node *node) const
+{
+  writer->writeStartElement(QStringLiteral("node"));
+
+  if (node == root_) {
+    writer->writeAttribute(QStringLiteral("root"), QStringLiteral("1"));
+  } else if (node == color_manager_) {
+    writer->writeAttribute(QStringLiteral("cm"), QStringLiteral("1"));
+  } else if (node == settings_) {
+    writer->writeAttribute(QStringLiteral("settings"), QStringLiteral("1"));
+  }
+
+  writer->writeAttribute(QStringLiteral("id"), node->id());
+
+  node->Save(writer);
+
+  writer->writeEndElement(); // node
 }
 
 Folder *Project::root()
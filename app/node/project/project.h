@@ -28,6 +28,7 @@
 #include "node/color/colormanager/colormanager.h"
 #include "node/output/viewer/viewer.h"
 #include "node/project/footage/footage.h"
+#include "node/project/projectcontainer.h"
 #include "node/project/projectsettings/projectsettings.h"
 #include "window/mainwindow/mainwindowlayoutinfo.h"
 
@@ -54,6 +55,35 @@ public:
 
   void Save(QXmlStreamWriter* writer) const;
 
+  /**
+   * @brief Load a binary project
+   *
+   * Every node is stored in its own chunk in the same XML as Load() reads, so apart from the nodes
+   * the project creates itself, they're loaded in parallel and only connected once all are loaded.
+   */
+  void Load(ProjectContainer::Reader* reader, MainWindowLayoutInfo *layout, uint version, const QAtomicInt* cancelled);
+
+  /**
+   * @brief Save a binary project, writing each node to the container as soon as it's serialized
+   */
+  bool Save(ProjectContainer::Writer* writer) const;
+
+  /**
+   * @brief Serialize one node the way it's stored in a binary project's chunk
+   */
+  QByteArray SaveNodeChunk(Node* node) const;
+
+  ProjectContainer::ChunkType GetNodeChunkType(Node* node) const;
+
+  static quint64 GetNodeChunkKey(Node* node)
+  {
+    return reinterpret_cast<quintptr>(node);
+  }
+
+  QByteArray SaveProjectChunk() const;
+
+  static QByteArray SaveLayoutChunk();
+
   Folder* root();
 
   QString name() const;
@@ -88,6 +118,17 @@ signals:
   void ModifiedChanged(bool e);
 
 private:
+  struct LoadedNode {
+    Node* node;
+    XMLNodeData xml_node_data;
+  };
+
+  Node* LoadNode(QXmlStreamReader* reader, XMLNodeData &xml_node_data, uint version, const QAtomicInt* cancelled) const;
+
+  LoadedNode LoadNodeChunk(ProjectContainer::Reader* reader, int chunk, uint version, const QAtomicInt* cancelled) const;
+
+  void SaveNode(QXmlStreamWriter* writer, Node* node) const;
+
   QUuid uuid_;
 
   Folder* root_;
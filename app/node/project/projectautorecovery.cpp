@@ -0,0 +1,288 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+#include "projectautorecovery.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QtConcurrent/QtConcurrent>
+
+#include "common/filefunctions.h"
+#include "core.h"
+#include "node/output/track/track.h"
+#include "node/output/viewer/viewer.h"
+
+namespace olive {
+
+const int ProjectAutorecovery::kCheckpointInterval = 10;
+
+ProjectAutorecovery::ProjectAutorecovery(Project *project) :
+  QObject(project),
+  project_(project),
+  modified_during_write_(false),
+  deltas_since_checkpoint_(0)
+{
+  foreach (Node* node, project_->nodes()) {
+    NodeAdded(node);
+  }
+
+  connect(project_, &Project::NodeAdded, this, &ProjectAutorecovery::NodeAdded);
+  connect(project_, &Project::ModifiedChanged, this, &ProjectAutorecovery::ProjectModified);
+  connect(&write_, &QFutureWatcher<bool>::finished, this, &ProjectAutorecovery::WriteFinished);
+}
+
+ProjectAutorecovery::~ProjectAutorecovery()
+{
+  write_.waitForFinished();
+}
+
+QString ProjectAutorecovery::Save(const QDir &dir)
+{
+  if (write_.isRunning()) {
+    return QString();
+  }
+
+  // Start over with a checkpoint every so often, or if the last one is gone (e.g. it failed to
+  // write or was deleted as an old recovery)
+  bool checkpoint = checkpoint_filename_.isEmpty()
+      || deltas_since_checkpoint_ >= kCheckpointInterval
+      || QFileInfo(checkpoint_filename_).absolutePath() != dir.absolutePath()
+      || !QFileInfo::exists(checkpoint_filename_);
+
+  Snapshot snapshot;
+
+  snapshot.filename = dir.filePath(QStringLiteral("%1.%2").arg(QString::number(QDateTime::currentSecsSinceEpoch()),
+                                                               checkpoint ? QStringLiteral("ovb") : QStringLiteral("ovd")));
+  snapshot.project = project_->SaveProjectChunk();
+  snapshot.layout = Project::SaveLayoutChunk();
+
+  if (checkpoint) {
+    changed_.clear();
+    checkpoint_keys_.clear();
+
+    foreach (Node* node, project_->nodes()) {
+      quint64 key = Project::GetNodeChunkKey(node);
+
+      snapshot.nodes.append({project_->GetNodeChunkType(node), key, project_->SaveNodeChunk(node)});
+      checkpoint_keys_.insert(key);
+    }
+
+    checkpoint_filename_ = snapshot.filename;
+    deltas_since_checkpoint_ = 0;
+  } else {
+    QSet<Node*> current;
+
+    foreach (Node* node, project_->nodes()) {
+      current.insert(node);
+
+      // Only serialize what changed since the last save, reusing what was serialized then for
+      // anything else that changed since the checkpoint
+      if (dirty_.contains(node)
+          || (!changed_.contains(node) && !checkpoint_keys_.contains(Project::GetNodeChunkKey(node)))) {
+        changed_.insert(node, project_->SaveNodeChunk(node));
+      }
+
+      auto it = changed_.constFind(node);
+      if (it != changed_.constEnd()) {
+        snapshot.nodes.append({project_->GetNodeChunkType(node), Project::GetNodeChunkKey(node), it.value()});
+      }
+    }
+
+    for (auto it=changed_.begin(); it!=changed_.end(); ) {
+      if (current.contains(it.key())) {
+        it++;
+      } else {
+        it = changed_.erase(it);
+      }
+    }
+
+    QSet<quint64> current_keys;
+    foreach (Node* node, current) {
+      current_keys.insert(Project::GetNodeChunkKey(node));
+    }
+
+    foreach (quint64 key, checkpoint_keys_) {
+      if (!current_keys.contains(key)) {
+        snapshot.removed.append(key);
+      }
+    }
+
+    snapshot.base = QFileInfo(checkpoint_filename_).fileName();
+    deltas_since_checkpoint_++;
+  }
+
+  dirty_.clear();
+
+  modified_during_write_ = false;
+  write_.setFuture(QtConcurrent::run(&ProjectAutorecovery::WriteSnapshot, snapshot));
+
+  return snapshot.filename;
+}
+
+bool ProjectAutorecovery::IsRecoveryFilename(const QString &filename)
+{
+  // Recoveries used to be saved as XML projects
+  return filename.endsWith(QStringLiteral(".ove"), Qt::CaseInsensitive)
+      || filename.endsWith(QStringLiteral(".ovb"), Qt::CaseInsensitive)
+      || IsDeltaFilename(filename);
+}
+
+bool ProjectAutorecovery::IsDeltaFilename(const QString &filename)
+{
+  return filename.endsWith(QStringLiteral(".ovd"), Qt::CaseInsensitive);
+}
+
+bool ProjectAutorecovery::WriteSnapshot(Snapshot snapshot)
+{
+  // Write to a temporary file first so a recovery is never left half-written
+  QString temp_save = FileFunctions::GetSafeTemporaryFilename(snapshot.filename);
+
+  QFile file(temp_save);
+
+  if (!file.open(QFile::WriteOnly)) {
+    qWarning() << "Failed to open auto-recovery file" << temp_save << "for writing";
+    return false;
+  }
+
+  ProjectContainer::Writer writer(&file);
+
+  QByteArray info;
+  {
+    QDataStream stream(&info, QIODevice::WriteOnly);
+    stream << snapshot.filename;
+  }
+
+  bool success = writer.Start(Core::kProjectVersion)
+      && writer.AddChunk(ProjectContainer::kChunkInfo, info);
+
+  if (success && !snapshot.base.isEmpty()) {
+    QByteArray base, removed;
+
+    {
+      QDataStream stream(&base, QIODevice::WriteOnly);
+      stream << snapshot.base;
+    }
+
+    {
+      QDataStream stream(&removed, QIODevice::WriteOnly);
+      stream << snapshot.removed;
+    }
+
+    success = writer.AddChunk(ProjectContainer::kChunkBase, base)
+        && writer.AddChunk(ProjectContainer::kChunkRemoved, removed);
+  }
+
+  success = success && writer.AddChunk(ProjectContainer::kChunkProject, snapshot.project);
+
+  foreach (const Snapshot::NodeChunk& c, snapshot.nodes) {
+    success = success && writer.AddChunk(c.type, c.data, c.key);
+  }
+
+  success = success
+      && writer.AddChunk(ProjectContainer::kChunkLayout, snapshot.layout)
+      && writer.Finish();
+
+  file.close();
+
+  if (!success || !FileFunctions::RenameFileAllowOverwrite(temp_save, snapshot.filename)) {
+    qWarning() << "Failed to write auto-recovery" << snapshot.filename;
+    QFile::remove(temp_save);
+    return false;
+  }
+
+  return true;
+}
+
+void ProjectAutorecovery::NodeAdded(Node *node)
+{
+  dirty_.insert(node);
+
+  // Anything that changes what Node::Save() writes
+  connect(node, &Node::PositionChanged, this, &ProjectAutorecovery::NodeChanged, Qt::UniqueConnection);
+  connect(node, &Node::LabelChanged, this, &ProjectAutorecovery::NodeChanged, Qt::UniqueConnection);
+  connect(node, &Node::ColorChanged, this, &ProjectAutorecovery::NodeChanged, Qt::UniqueConnection);
+  connect(node, &Node::ValueChanged, this, &ProjectAutorecovery::NodeChanged, Qt::UniqueConnection);
+  connect(node, &Node::InputConnected, this, &ProjectAutorecovery::NodeChanged, Qt::UniqueConnection);
+  connect(node, &Node::InputDisconnected, this, &ProjectAutorecovery::NodeChanged, Qt::UniqueConnection);
+  connect(node, &Node::InputPropertyChanged, this, &ProjectAutorecovery::NodeChanged, Qt::UniqueConnection);
+  connect(node, &Node::LinksChanged, this, &ProjectAutorecovery::NodeChanged, Qt::UniqueConnection);
+  connect(node, &Node::InputArraySizeChanged, this, &ProjectAutorecovery::NodeChanged, Qt::UniqueConnection);
+  connect(node, &Node::KeyframeAdded, this, &ProjectAutorecovery::NodeChanged, Qt::UniqueConnection);
+  connect(node, &Node::KeyframeRemoved, this, &ProjectAutorecovery::NodeChanged, Qt::UniqueConnection);
+  connect(node, &Node::KeyframeTimeChanged, this, &ProjectAutorecovery::NodeChanged, Qt::UniqueConnection);
+  connect(node, &Node::KeyframeEnableChanged, this, &ProjectAutorecovery::NodeChanged, Qt::UniqueConnection);
+
+  // Anything that changes what the node writes in SaveCustom()
+  if (Track* track = dynamic_cast<Track*>(node)) {
+    connect(track, &Track::TrackHeightChangedInPixels, this, &ProjectAutorecovery::NodeChanged, Qt::UniqueConnection);
+  } else if (ViewerOutput* viewer = dynamic_cast<ViewerOutput*>(node)) {
+    TimelinePoints* points = viewer->GetTimelinePoints();
+
+    // These aren't nodes themselves, so they mark their viewer through lambdas. Duplicate
+    // connections if a node is added again only mark it twice.
+    connect(points->workarea(), &TimelineWorkArea::EnabledChanged, this, [this, viewer]{
+      dirty_.insert(viewer);
+    });
+    connect(points->workarea(), &TimelineWorkArea::RangeChanged, this, [this, viewer]{
+      dirty_.insert(viewer);
+    });
+    connect(points->markers(), &TimelineMarkerList::MarkerAdded, this, [this, viewer](TimelineMarker* marker){
+      dirty_.insert(viewer);
+      WatchMarker(viewer, marker);
+    });
+    connect(points->markers(), &TimelineMarkerList::MarkerRemoved, this, [this, viewer]{
+      dirty_.insert(viewer);
+    });
+
+    foreach (TimelineMarker* marker, points->markers()->list()) {
+      WatchMarker(viewer, marker);
+    }
+  }
+}
+
+void ProjectAutorecovery::WatchMarker(ViewerOutput *viewer, TimelineMarker *marker)
+{
+  connect(marker, &TimelineMarker::TimeChanged, this, [this, viewer]{
+    dirty_.insert(viewer);
+  });
+  connect(marker, &TimelineMarker::NameChanged, this, [this, viewer]{
+    dirty_.insert(viewer);
+  });
+}
+
+void ProjectAutorecovery::NodeChanged()
+{
+  dirty_.insert(static_cast<Node*>(sender()));
+}
+
+void ProjectAutorecovery::ProjectModified()
+{
+  modified_during_write_ = true;
+}
+
+void ProjectAutorecovery::WriteFinished()
+{
+  // If the write failed, the project stays marked as unsaved so the next save tries again. Changes
+  // made while writing aren't in this recovery, so those also leave it unsaved.
+  if (write_.result() && !modified_during_write_) {
+    project_->set_autorecovery_saved(true);
+  }
+}
+
+}
@@ -0,0 +1,138 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+#ifndef PROJECTAUTORECOVERY_H
+#define PROJECTAUTORECOVERY_H
+
+#include <QDir>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+
+#include "node/project/project.h"
+
+namespace olive {
+
+class TimelineMarker;
+class ViewerOutput;
+
+/**
+ * @brief Writes a project's auto-recoveries as full checkpoints followed by deltas
+ *
+ * Every kCheckpointInterval saves, the whole project is written as a regular binary project. In
+ * between, only nodes that changed since that checkpoint are written, along with the nodes that
+ * were removed, in a delta that ProjectLoadTask combines with the checkpoint when it's opened.
+ *
+ * Nodes are marked as changed through their signals (including the state they save in
+ * Node::SaveCustom(), such as a viewer's markers and work area) and only those are serialized for a
+ * delta. Serialization has to happen on the GUI thread since that's where nodes live; only
+ * compressing and writing the resulting snapshot happen on a worker thread. A checkpoint therefore
+ * still serializes every node on the GUI thread, which is what limits them to every
+ * kCheckpointInterval saves, and is what picks up any change that doesn't emit one of the signals.
+ *
+ * The project is only marked as auto-recovered once a write succeeds and nothing was modified
+ * while it was being written, so a failed write is retried at the next save.
+ */
+class ProjectAutorecovery : public QObject
+{
+  Q_OBJECT
+public:
+  ProjectAutorecovery(Project* project);
+
+  virtual ~ProjectAutorecovery() override;
+
+  /**
+   * @brief Snapshot the project and write it into this directory in the background
+   *
+   * Returns the filename being written, or an empty string if the previous save is still being
+   * written, in which case these changes will be included in the next save instead.
+   */
+  QString Save(const QDir& dir);
+
+  /**
+   * @brief Returns true if this file in an auto-recovery directory is a recovery that can be opened
+   */
+  static bool IsRecoveryFilename(const QString& filename);
+
+  /**
+   * @brief Returns true if this auto-recovery file is a delta depending on an earlier checkpoint
+   */
+  static bool IsDeltaFilename(const QString& filename);
+
+  static const int kCheckpointInterval;
+
+private:
+  struct Snapshot {
+    struct NodeChunk {
+      ProjectContainer::ChunkType type;
+      quint64 key;
+      QByteArray data;
+    };
+
+    QString filename;
+
+    /// Checkpoint this snapshot is a delta of, empty if this is a checkpoint itself
+    QString base;
+
+    QVector<quint64> removed;
+
+    QByteArray project;
+
+    QVector<NodeChunk> nodes;
+
+    QByteArray layout;
+  };
+
+  static bool WriteSnapshot(Snapshot snapshot);
+
+  void WatchMarker(ViewerOutput* viewer, TimelineMarker* marker);
+
+  Project* project_;
+
+  QFutureWatcher<bool> write_;
+
+  bool modified_during_write_;
+
+  /// Nodes changed since the last save
+  QSet<Node*> dirty_;
+
+  /// Latest serialization of every node changed since the last checkpoint
+  QHash<Node*, QByteArray> changed_;
+
+  QSet<quint64> checkpoint_keys_;
+
+  QString checkpoint_filename_;
+
+  int deltas_since_checkpoint_;
+
+private slots:
+  void NodeAdded(Node* node);
+
+  void NodeChanged();
+
+  void ProjectModified();
+
+  void WriteFinished();
+
+};
+
+}
+
+#endif // PROJECTAUTORECOVERY_H
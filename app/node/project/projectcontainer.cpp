@@ -0,0 +1,256 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+#include "projectcontainer.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QSet>
+
+namespace olive {
+
+const quint32 ProjectContainer::kContainerVersion = 1;
+const char ProjectContainer::kHeaderMagic[] = "OVEB";
+const char ProjectContainer::kTrailerMagic[] = "OVEI";
+const int ProjectContainer::kMagicSize = 4;
+
+bool ProjectContainer::IsContainerFile(const QString &filename)
+{
+  QFile f(filename);
+
+  if (!f.open(QFile::ReadOnly)) {
+    return false;
+  }
+
+  return f.read(kMagicSize) == QByteArray(kHeaderMagic, kMagicSize);
+}
+
+bool ProjectContainer::ApplyDelta(Reader *base, Reader *delta, Writer *output)
+{
+  QSet<quint64> replaced;
+
+  for (int i=0; i<delta->chunks().size(); i++) {
+    const Chunk& c = delta->chunks().at(i);
+
+    if (c.type == kChunkRemoved) {
+      QByteArray data = delta->ReadChunk(i);
+      QDataStream stream(data);
+      QVector<quint64> removed;
+      stream >> removed;
+
+      foreach (quint64 key, removed) {
+        replaced.insert(key);
+      }
+    } else if (c.type == kChunkNode || c.type == kChunkProjectNode) {
+      replaced.insert(c.key);
+    }
+  }
+
+  for (int i=0; i<base->chunks().size(); i++) {
+    const Chunk& c = base->chunks().at(i);
+
+    if ((c.type == kChunkNode || c.type == kChunkProjectNode) && !replaced.contains(c.key)) {
+      QByteArray compressed = base->ReadCompressedChunk(i);
+
+      if (compressed.isEmpty() || !output->AddCompressedChunk(c.type, compressed, c.key)) {
+        return false;
+      }
+    }
+  }
+
+  for (int i=0; i<delta->chunks().size(); i++) {
+    const Chunk& c = delta->chunks().at(i);
+
+    if (c.type != kChunkBase && c.type != kChunkRemoved) {
+      QByteArray compressed = delta->ReadCompressedChunk(i);
+
+      if (compressed.isEmpty() || !output->AddCompressedChunk(c.type, compressed, c.key)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+ProjectContainer::Writer::Writer(QIODevice *device) :
+  device_(device)
+{
+}
+
+bool ProjectContainer::Writer::Start(quint32 project_version)
+{
+  chunks_.clear();
+
+  QDataStream stream(device_);
+  stream.writeRawData(kHeaderMagic, kMagicSize);
+  stream << kContainerVersion << project_version;
+
+  return stream.status() == QDataStream::Ok;
+}
+
+bool ProjectContainer::Writer::AddChunk(ChunkType type, const QByteArray &data, quint64 key)
+{
+  return AddCompressedChunk(type, qCompress(data), key);
+}
+
+bool ProjectContainer::Writer::AddCompressedChunk(quint32 type, const QByteArray &compressed, quint64 key)
+{
+  Chunk c = {type, key, static_cast<quint64>(device_->pos()), static_cast<quint32>(compressed.size())};
+
+  if (device_->write(compressed) != compressed.size()) {
+    return false;
+  }
+
+  chunks_.append(c);
+
+  return true;
+}
+
+bool ProjectContainer::Writer::Finish()
+{
+  quint64 index_offset = device_->pos();
+
+  QDataStream stream(device_);
+
+  stream << static_cast<quint32>(chunks_.size());
+
+  foreach (const Chunk& c, chunks_) {
+    stream << c.type << c.key << c.offset << c.size;
+  }
+
+  stream << index_offset;
+  stream.writeRawData(kTrailerMagic, kMagicSize);
+
+  return stream.status() == QDataStream::Ok;
+}
+
+ProjectContainer::Reader::Reader(QIODevice *device) :
+  device_(device),
+  project_version_(0)
+{
+}
+
+bool ProjectContainer::Reader::Open()
+{
+  QMutexLocker locker(&device_lock_);
+
+  chunks_.clear();
+
+  // Header
+  if (!device_->seek(0) || device_->read(kMagicSize) != QByteArray(kHeaderMagic, kMagicSize)) {
+    return false;
+  }
+
+  QDataStream stream(device_);
+
+  quint32 container_version;
+  stream >> container_version >> project_version_;
+
+  if (stream.status() != QDataStream::Ok || container_version > kContainerVersion) {
+    qWarning() << "Unsupported project container version" << container_version;
+    return false;
+  }
+
+  // Trailer
+  const qint64 trailer_size = static_cast<qint64>(sizeof(quint64)) + kMagicSize;
+
+  if (device_->size() < trailer_size || !device_->seek(device_->size() - trailer_size)) {
+    return false;
+  }
+
+  quint64 index_offset;
+  stream >> index_offset;
+
+  if (stream.status() != QDataStream::Ok
+      || device_->read(kMagicSize) != QByteArray(kTrailerMagic, kMagicSize)
+      || !device_->seek(index_offset)) {
+    // Trailer is missing, most likely because the file wasn't written to the end
+    return false;
+  }
+
+  // Index
+  quint32 count;
+  stream >> count;
+
+  for (quint32 i=0; i<count && stream.status() == QDataStream::Ok; i++) {
+    Chunk c;
+    stream >> c.type >> c.key >> c.offset >> c.size;
+
+    if (c.offset + c.size > index_offset) {
+      stream.setStatus(QDataStream::ReadCorruptData);
+    } else {
+      chunks_.append(c);
+    }
+  }
+
+  if (stream.status() != QDataStream::Ok) {
+    chunks_.clear();
+    return false;
+  }
+
+  return true;
+}
+
+int ProjectContainer::Reader::FindChunk(ChunkType type) const
+{
+  for (int i=0; i<chunks_.size(); i++) {
+    if (chunks_.at(i).type == static_cast<quint32>(type)) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+QByteArray ProjectContainer::Reader::ReadChunk(int index)
+{
+  QByteArray compressed = ReadCompressedChunk(index);
+
+  if (compressed.isEmpty()) {
+    return QByteArray();
+  }
+
+  return qUncompress(compressed);
+}
+
+QByteArray ProjectContainer::Reader::ReadCompressedChunk(int index)
+{
+  const Chunk& c = chunks_.at(index);
+  QByteArray compressed;
+
+  {
+    QMutexLocker locker(&device_lock_);
+
+    if (!device_->seek(c.offset)) {
+      return QByteArray();
+    }
+
+    compressed = device_->read(c.size);
+  }
+
+  if (compressed.size() != static_cast<int>(c.size)) {
+    return QByteArray();
+  }
+
+  return compressed;
+}
+
+}
@@ -0,0 +1,184 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+#ifndef PROJECTCONTAINER_H
+#define PROJECTCONTAINER_H
+
+#include <QIODevice>
+#include <QMutex>
+#include <QVector>
+
+#include "common/define.h"
+
+namespace olive {
+
+/**
+ * @brief Chunked binary container that binary (.ovb) projects are stored in
+ *
+ * The file starts with a header (magic, container version and project version), followed by
+ * compressed chunks written back to back, an index of every chunk's type, offset and size, and
+ * a trailer pointing to the index.
+ *
+ * Each chunk is written as soon as it's added, so the project never has to be held in memory as
+ * a whole. The index lets a reader read any chunk without reading the ones before it, so several
+ * chunks can be decompressed and parsed at the same time.
+ *
+ * A container can also be a delta, holding only the node chunks that changed since another
+ * container (see ApplyDelta()). Node chunks are matched between the two by their key.
+ */
+class ProjectContainer
+{
+public:
+  enum ChunkType {
+    /// Information about the file itself, e.g. the URL it was saved to
+    kChunkInfo,
+
+    /// Project-wide data, e.g. the project's UUID
+    kChunkProject,
+
+    /// A node that the project creates itself (root folder, color manager, settings)
+    kChunkProjectNode,
+
+    /// Any other node
+    kChunkNode,
+
+    /// Main window layout
+    kChunkLayout,
+
+    /// Filename of the container a delta applies to, relative to the delta
+    kChunkBase,
+
+    /// Keys of the base's node chunks that a delta removes
+    kChunkRemoved
+  };
+
+  struct Chunk {
+    quint32 type;
+    quint64 key;
+    quint64 offset;
+    quint32 size;
+  };
+
+  class Reader;
+  class Writer;
+
+  /**
+   * @brief Returns true if this file starts like a project container
+   */
+  static bool IsContainerFile(const QString& filename);
+
+  /**
+   * @brief Write the result of applying a delta to its base into a started writer
+   *
+   * Node chunks of the base that the delta neither replaces nor removes are copied first in their
+   * original order, followed by every other chunk of the delta. Chunks are copied still
+   * compressed.
+   */
+  static bool ApplyDelta(Reader* base, Reader* delta, Writer* output);
+
+  static const quint32 kContainerVersion;
+
+  class Writer
+  {
+  public:
+    Writer(QIODevice* device);
+
+    DISABLE_COPY_MOVE(Writer)
+
+    bool Start(quint32 project_version);
+
+    bool AddChunk(ChunkType type, const QByteArray& data, quint64 key = 0);
+
+    /**
+     * @brief Add a chunk that's already compressed, e.g. from Reader::ReadCompressedChunk()
+     */
+    bool AddCompressedChunk(quint32 type, const QByteArray& compressed, quint64 key = 0);
+
+    /**
+     * @brief Write the index, after which no more chunks can be added
+     */
+    bool Finish();
+
+  private:
+    QIODevice* device_;
+
+    QVector<Chunk> chunks_;
+
+  };
+
+  /**
+   * @brief Reads a container, ReadChunk() can be called from several threads at once
+   */
+  class Reader
+  {
+  public:
+    Reader(QIODevice* device);
+
+    DISABLE_COPY_MOVE(Reader)
+
+    /**
+     * @brief Read the header and index, returns false if this isn't a valid container
+     */
+    bool Open();
+
+    quint32 project_version() const
+    {
+      return project_version_;
+    }
+
+    const QVector<Chunk>& chunks() const
+    {
+      return chunks_;
+    }
+
+    /**
+     * @brief Returns the index of the first chunk of this type, or -1 if there isn't one
+     */
+    int FindChunk(ChunkType type) const;
+
+    /**
+     * @brief Read and decompress a chunk, returns an empty array on failure
+     */
+    QByteArray ReadChunk(int index);
+
+    QByteArray ReadCompressedChunk(int index);
+
+  private:
+    QIODevice* device_;
+
+    QMutex device_lock_;
+
+    quint32 project_version_;
+
+    QVector<Chunk> chunks_;
+
+  };
+
+private:
+  static const char kHeaderMagic[];
+
+  static const char kTrailerMagic[];
+
+  static const int kMagicSize;
+
+};
+
+}
+
+#endif // PROJECTCONTAINER_H
@@ -26,22 +26,50 @@
 
 namespace olive {
 
+NodeTraverser::NodeTraverser() :
+  memo_depth_(0),
+  no_memo_depth_(0),
+  invariant_depth_(0)
+#ifndef QT_NO_DEBUG
+  , memo_hits_(0),
+  memo_misses_(0)
+#endif
+{
+}
+
 NodeValueDatabase NodeTraverser::GenerateDatabase(const Node* node, const QString& output, const TimeRange &range)
 {
+  EnterMemoScope();
+
   NodeValueDatabase database;
 
   // We need to insert tables into the database for each input
   auto inputs = node->inputs_for_output(output);
-  foreach (const QString& input, inputs) {
+
+  // Most nodes return inputs() itself, whose handles are kept in the same order by
+  // input_handles(). Sharing the same data proves that's what we got, rather than just a list of
+  // the same length. Anything else has its handles looked up individually.
+  const QVector<InputHandle>& all_handles = node->input_handles();
+  bool using_all_inputs = (inputs.constData() == node->inputs().constData());
+
+  database.reserve(inputs.size() + 1);
+
+  for (int i=0; i<inputs.size(); i++) {
     if (IsCancelled()) {
+      memo_depth_--;
       return NodeValueDatabase();
     }
 
-    database.Insert(input, ProcessInput(node, input, range));
+    const QString& input = inputs.at(i);
+    InputHandle handle = using_all_inputs ? all_handles.at(i) : node->GetInputHandle(input);
+
+    database.Insert(handle, ProcessInput(node, input, range));
   }
 
   AddGlobalsToDatabase(database, range);
 
+  memo_depth_--;
+
   return database;
 }
 
@@ -122,23 +150,92 @@ NodeValueTable NodeTraverser::ProcessInput(const Node* node, const QString& inpu
   }
 }
 
+NodeValueTable NodeTraverser::ProcessInputForSample(const Node *node, const QString &input, const rational &time)
+{
+  no_memo_depth_++;
+
+  NodeValueTable table = ProcessInput(node, input, TimeRange(time, time));
+
+  no_memo_depth_--;
+
+  return table;
+}
+
 NodeValueTable NodeTraverser::GenerateTable(const Node *n, const QString& output, const TimeRange& range)
 {
+  EnterMemoScope();
+
+  // Nodes feeding several inputs are reached once per input, reuse the result if we've already
+  // generated it for this frame
+  bool use_memo = !no_memo_depth_;
+  MemoKey key = {n, output, range};
+  if (use_memo) {
+    auto memoized = memo_.constFind(key);
+    if (memoized != memo_.constEnd()) {
+#ifndef QT_NO_DEBUG
+      memo_hits_++;
+#endif
+      memo_depth_--;
+      return CopyMemoTable(memoized.value());
+    }
+
+#ifndef QT_NO_DEBUG
+    memo_misses_++;
+#endif
+  }
+
+  NodeValueTable table;
+
+  // The top node of a subgraph that renders the same at any time can reuse its texture from
+  // another frame. Nodes inside such a subgraph don't need caching themselves.
+  QByteArray invariant_hash;
+  bool cache_invariant = (CanCacheFrames() && !invariant_depth_ && IsTimeInvariant(n, output));
+
+  if (cache_invariant) {
+    invariant_hash = RenderManager::Hash(n, output, GetCacheVideoParams(), range.in());
+
+    QVariant cached_texture = GetCachedTexture(invariant_hash);
+    if (!cached_texture.isNull()) {
+      table.Push(NodeValue::kTexture, cached_texture, n);
+      if (use_memo) {
+        memo_.insert(key, table);
+      }
+      memo_depth_--;
+      return table;
+    }
+
+    invariant_depth_++;
+  }
+
   const Track* track = dynamic_cast<const Track*>(n);
   if (track) {
     // If the range is not wholly contained in this Block, we'll need to do some extra processing
-    return GenerateBlockTable(track, range);
+    table = GenerateBlockTable(track, range);
+  } else {
+    // Generate database of input values of node
+    NodeValueDatabase database = GenerateDatabase(n, output, range);
+
+    // By this point, the node should have all the inputs it needs to render correctly
+    table = n->Value(output, database);
+
+    PostProcessTable(n, output, range, table);
   }
 
-  // FIXME: Cache certain values here if we've already processed them before
+  if (cache_invariant) {
+    invariant_depth_--;
 
-  // Generate database of input values of node
-  NodeValueDatabase database = GenerateDatabase(n, output, range);
+    // Only tables that are just a texture can be restored from the cache without losing anything
+    if (!IsCancelled() && table.Count() == 1 && table.at(0).type() == NodeValue::kTexture) {
+      SaveCachedTexture(invariant_hash, table.at(0).data());
+    }
+  }
 
-  // By this point, the node should have all the inputs it needs to render correctly
-  NodeValueTable table = n->Value(output, database);
+  // Don't keep partial results from a cancelled traversal
+  if (use_memo && !IsCancelled()) {
+    memo_.insert(key, CopyMemoTable(table));
+  }
 
-  PostProcessTable(n, output, range, table);
+  memo_depth_--;
 
   return table;
 }
@@ -226,7 +323,80 @@ void NodeTraverser::AddGlobalsToDatabase(NodeValueDatabase &db, const TimeRange&
   global.Push(NodeValue::kFloat, range.out().toDouble(), nullptr, false, QStringLiteral("time_out"));
   global.Push(NodeValue::kVec2, GenerateResolution(), nullptr, false, QStringLiteral("resolution"));
 
-  db.Insert(QStringLiteral("global"), global);
+  db.Insert(InputHandleRegistry::kGlobalHandle, global);
+}
+
+bool NodeTraverser::IsTimeInvariant(const Node *n, const QString &output)
+{
+  // The graph doesn't change during a traversal, so each result is valid for this traverser's
+  // lifetime
+  QPair<const Node*, QString> key(n, output);
+
+  auto it = time_invariant_.constFind(key);
+  if (it != time_invariant_.constEnd()) {
+    return it.value();
+  }
+
+  bool invariant = n->IsStaticOverTime(output);
+
+  if (invariant) {
+    auto inputs = n->inputs_for_output(output);
+
+    foreach (const QString& input, inputs) {
+      int arr_sz = n->InputArraySize(input);
+
+      for (int i=-1; i<arr_sz && invariant; i++) {
+        if (n->IsInputConnected(input, i)) {
+          NodeOutput connected = n->GetConnectedOutput(input, i);
+          invariant = IsTimeInvariant(connected.node(), connected.output());
+        }
+      }
+
+      if (!invariant) {
+        break;
+      }
+    }
+  }
+
+  time_invariant_.insert(key, invariant);
+
+  return invariant;
+}
+
+void NodeTraverser::EnterMemoScope()
+{
+  if (!memo_depth_) {
+    // Entering from outside a traversal means this is a new frame, so previous results are stale
+    memo_.clear();
+  }
+
+  memo_depth_++;
+}
+
+NodeValueTable NodeTraverser::CopyMemoTable(const NodeValueTable &table)
+{
+  if (!table.Has(NodeValue::kSamples)) {
+    return table;
+  }
+
+  NodeValueTable copy;
+
+  for (int i=0; i<table.Count(); i++) {
+    const NodeValue& v = table.at(i);
+
+    if (v.type() == NodeValue::kSamples) {
+      SampleBufferPtr samples = v.data().value<SampleBufferPtr>();
+
+      if (samples) {
+        copy.Push(v.type(), QVariant::fromValue(SampleBuffer::CreateCopy(*samples)), v.source(), v.array(), v.tag());
+        continue;
+      }
+    }
+
+    copy.Push(v);
+  }
+
+  return copy;
 }
 
 QVector2D NodeTraverser::GenerateResolution() const
@@ -339,11 +509,6 @@ void NodeTraverser::PostProcessTable(const Node *node, const QString& output, co
       output_params.Push(NodeValue::kSamples, value, node);
     }
   }
-
-  if (CanCacheFrames() && node->GetCacheTextures() && !got_cached_frame) {
-    // Save cached texture
-    SaveCachedTexture(cached_node_hash, output_params.Get(NodeValue::kTexture));
-  }
 }
 
 }
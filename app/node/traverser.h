@@ -21,6 +21,7 @@
 #ifndef NODETRAVERSER_H
 #define NODETRAVERSER_H
 
+#include <QHash>
 #include <QVector2D>
 
 #include "codec/decoder.h"
@@ -34,7 +35,7 @@ namespace olive {
 class NodeTraverser : public CancelableObject
 {
 public:
-  NodeTraverser() = default;
+  NodeTraverser();
 
   NodeValueTable GenerateTable(const Node *n, const QString &output, const TimeRange &range);
   NodeValueTable GenerateTable(const NodeOutput& output, const TimeRange &range)
@@ -56,9 +57,35 @@ public:
 
   static int GetChannelCountFromJob(const GenerateJob& job);
 
+#ifndef QT_NO_DEBUG
+  /**
+   * @brief Number of GenerateTable() calls answered from results already generated for the frame
+   */
+  int GetMemoHitCount() const
+  {
+    return memo_hits_;
+  }
+
+  /**
+   * @brief Number of GenerateTable() calls that looked in the memo and had to generate their result
+   */
+  int GetMemoMissCount() const
+  {
+    return memo_misses_;
+  }
+#endif
+
 protected:
   NodeValueTable ProcessInput(const Node *node, const QString &input, const TimeRange &range);
 
+  /**
+   * @brief ProcessInput() for a single audio sample
+   *
+   * Inputs are evaluated once per sample, so results generated here aren't memoized. Each sample
+   * time is only asked for once and memoizing them would just fill the memo with single-use tables.
+   */
+  NodeValueTable ProcessInputForSample(const Node *node, const QString &input, const rational &time);
+
   virtual NodeValueTable GenerateBlockTable(const Track *track, const TimeRange& range);
 
   virtual QVariant ProcessVideoFootage(const FootageJob &stream, const rational &input_time);
@@ -87,8 +114,73 @@ protected:
 private:
   void PostProcessTable(const Node *node, const QString &output, const TimeRange &range, NodeValueTable &output_params);
 
+  /**
+   * @brief Start a GenerateTable() or GenerateDatabase() call, decrement memo_depth_ when it ends
+   */
+  void EnterMemoScope();
+
+  /**
+   * @brief Returns whether this output and everything connected to it is static over time
+   *
+   * If so, its hash is the same at any time and the texture it renders can be reused across
+   * frames through GetCachedTexture() and SaveCachedTexture().
+   */
+  bool IsTimeInvariant(const Node* n, const QString& output);
+
+  /**
+   * @brief Returns a table that can be handed out from or stored in the memo
+   *
+   * Consumers may write to sample buffers they receive, so each one gets its own copy rather than
+   * the buffer kept in the memo.
+   */
+  static NodeValueTable CopyMemoTable(const NodeValueTable& table);
+
+  struct MemoKey {
+    const Node* node;
+    QString output;
+    TimeRange range;
+
+    bool operator==(const MemoKey& rhs) const
+    {
+      return node == rhs.node && output == rhs.output && range == rhs.range;
+    }
+
+    friend uint qHash(const MemoKey& k, uint seed = 0)
+    {
+      return ::qHash(k.node, seed) ^ ::qHash(k.output, seed) ^ olive::qHash(k.range, seed);
+    }
+  };
+
   VideoParams video_params_;
 
+  /**
+   * @brief Tables already generated for the current frame
+   *
+   * Cleared whenever a new traversal starts from outside, so results are only shared between
+   * branches of the same frame.
+   */
+  QHash<MemoKey, NodeValueTable> memo_;
+
+  int memo_depth_;
+
+  /**
+   * @brief Greater than zero while generating tables for a single audio sample
+   */
+  int no_memo_depth_;
+
+  QHash<QPair<const Node*, QString>, bool> time_invariant_;
+
+  /**
+   * @brief Greater than zero while generating inside a time-invariant subgraph that will be cached
+   */
+  int invariant_depth_;
+
+#ifndef QT_NO_DEBUG
+  int memo_hits_;
+
+  int memo_misses_;
+#endif
+
 };
 
 }
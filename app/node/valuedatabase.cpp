@@ -24,12 +24,16 @@ namespace olive {
 
 NodeValueTable NodeValueDatabase::Merge() const
 {
-  QHash<QString, NodeValueTable> copy = tables_;
+  QList<NodeValueTable> tables;
 
-  // Kinda hacky, but we don't need this table to slipstream
-  copy.remove(QStringLiteral("global"));
+  for (int i=0; i<handles_.size(); i++) {
+    // Kinda hacky, but we don't need this table to slipstream
+    if (handles_.at(i) != InputHandleRegistry::kGlobalHandle) {
+      tables.append(tables_.at(i));
+    }
+  }
 
-  return NodeValueTable::Merge(copy.values());
+  return NodeValueTable::Merge(tables);
 }
 
 }
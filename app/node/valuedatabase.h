@@ -21,47 +21,156 @@
 #ifndef NODEVALUEDATABASE_H
 #define NODEVALUEDATABASE_H
 
+#include "inputhandle.h"
 #include "param.h"
 #include "value.h"
 
 namespace olive {
 
+/**
+ * @brief Tables of values for each input of a node, addressed by InputHandle
+ *
+ * Tables are stored densely in order of insertion, with a hash from handle to slot, so inserting
+ * and looking them up during traversal doesn't involve any string hashing and a database only
+ * takes as much memory as the inputs it holds. The QString overloads intern the ID and are kept for
+ * compatibility.
+ */
 class NodeValueDatabase
 {
 public:
   NodeValueDatabase() = default;
 
+  NodeValueTable& operator[](InputHandle handle)
+  {
+    auto it = table_index_.constFind(handle);
+
+    if (it != table_index_.constEnd()) {
+      return tables_[it.value()];
+    }
+
+    table_index_.insert(handle, tables_.size());
+    handles_.append(handle);
+    tables_.append(NodeValueTable());
+
+    return tables_.last();
+  }
+
   NodeValueTable& operator[](const QString& input_id)
   {
-    return tables_[input_id];
+    return (*this)[InputHandleRegistry::Intern(input_id)];
+  }
+
+  void Insert(InputHandle handle, const NodeValueTable &value)
+  {
+    (*this)[handle] = value;
   }
 
   void Insert(const QString& key, const NodeValueTable &value)
   {
-    tables_.insert(key, value);
+    (*this)[key] = value;
   }
 
   NodeValueTable Merge() const;
 
-  using const_iterator = QHash<QString, NodeValueTable>::const_iterator;
+  /**
+   * @brief Allocate space for this many inputs up front
+   */
+  void reserve(int size)
+  {
+    table_index_.reserve(size);
+    handles_.reserve(size);
+    tables_.reserve(size);
+  }
+
+  class const_iterator
+  {
+  public:
+    const_iterator() :
+      db_(nullptr),
+      index_(0)
+    {
+    }
+
+    const_iterator(const NodeValueDatabase* db, int index) :
+      db_(db),
+      index_(index)
+    {
+    }
+
+    InputHandle handle() const
+    {
+      return db_->handles_.at(index_);
+    }
+
+    QString key() const
+    {
+      return InputHandleRegistry::GetID(handle());
+    }
+
+    const NodeValueTable& value() const
+    {
+      return db_->tables_.at(index_);
+    }
+
+    const_iterator& operator++()
+    {
+      index_++;
+      return *this;
+    }
+
+    const_iterator operator++(int)
+    {
+      const_iterator old = *this;
+      index_++;
+      return old;
+    }
+
+    bool operator==(const const_iterator& other) const
+    {
+      return db_ == other.db_ && index_ == other.index_;
+    }
+
+    bool operator!=(const const_iterator& other) const
+    {
+      return !(*this == other);
+    }
+
+  private:
+    const NodeValueDatabase* db_;
+
+    int index_;
+
+  };
+
+  inline const_iterator begin() const
+  {
+    return const_iterator(this, 0);
+  }
 
-  inline QHash<QString, NodeValueTable>::const_iterator begin() const
+  inline const_iterator end() const
   {
-    return tables_.cbegin();
+    return const_iterator(this, handles_.size());
   }
 
-  inline QHash<QString, NodeValueTable>::const_iterator end() const
+  inline bool contains(InputHandle handle) const
   {
-    return tables_.cend();
+    return table_index_.contains(handle);
   }
 
   inline bool contains(const QString& s) const
   {
-    return tables_.contains(s);
+    return contains(InputHandleRegistry::Find(s));
   }
 
 private:
-  QHash<QString, NodeValueTable> tables_;
+  /// Index of each handle's table in `tables_`
+  QHash<InputHandle, int> table_index_;
+
+  /// Handles that have been inserted, in order of insertion
+  QVector<InputHandle> handles_;
+
+  /// Table of each handle in `handles_`, in the same order
+  QVector<NodeValueTable> tables_;
 
 };
 
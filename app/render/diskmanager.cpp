@@ -20,11 +20,14 @@
 
 #include "diskmanager.h"
 
+#include <algorithm>
+#include <iterator>
 #include <QDataStream>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
 #include <QMessageBox>
+#include <QSaveFile>
 #include <QStandardPaths>
 
 #include "common/filefunctions.h"
@@ -184,8 +187,12 @@ void DiskManager::ShowDiskCacheSettingsDialog(const QString &path, QWidget *pare
   ShowDiskCacheSettingsDialog(folder, parent);
 }
 
+const qint64 DiskCacheFolder::kMinimumCompactRecords = 4096;
+
 DiskCacheFolder::DiskCacheFolder(const QString &path, QObject *parent) :
-  QObject(parent)
+  QObject(parent),
+  journal_stream_(&journal_buffer_, QIODevice::WriteOnly),
+  journal_record_count_(0)
 {
   SetPath(path);
 
@@ -211,7 +218,8 @@ bool DiskCacheFolder::ClearCache()
 
     if (QFile::remove(ht.file_name) || !QFileInfo::exists(ht.file_name)) {
       emit DeletedFrame(path_, i.key());
-      i = disk_data_.erase(i);
+      BeginJournalRecord(kJournalDeleted) << i.key();
+      i = RemoveEntry(i);
     } else {
       qWarning() << "Failed to delete" << i->file_name;
       deleted_files = false;
@@ -224,24 +232,31 @@ bool DiskCacheFolder::ClearCache()
 
 void DiskCacheFolder::Accessed(const QByteArray &hash)
 {
-  if (!disk_data_.contains(hash)) {
+  auto it = disk_data_.find(hash);
+
+  if (it == disk_data_.end()) {
     return;
   }
 
-  disk_data_[hash].access_time = QDateTime::currentMSecsSinceEpoch();
+  qint64 access_time = QDateTime::currentMSecsSinceEpoch();
+
+  TouchEntry(it, access_time);
+
+  BeginJournalRecord(kJournalAccessed) << hash << access_time;
 }
 
 void DiskCacheFolder::CreatedFile(const QString &file_name, const QByteArray &hash)
 {
   qint64 file_size = QFile(file_name).size();
+  qint64 access_time = QDateTime::currentMSecsSinceEpoch();
 
-  disk_data_.insert(hash, {file_name, file_size, QDateTime::currentMSecsSinceEpoch()});
+  InsertEntry(hash, file_name, file_size, access_time);
 
-  consumption_ += file_size;
+  BeginJournalRecord(kJournalCreated) << hash << file_name << file_size << access_time;
 
   QList<QByteArray> deleted_hashes;
 
-  while (consumption_ > limit_) {
+  while (consumption_ > limit_ && !lru_.empty()) {
     deleted_hashes.append(DeleteLeastRecent());
   }
 
@@ -261,6 +276,7 @@ void DiskCacheFolder::SetPath(const QString &path)
       emit DeletedFrame(path_, it.key());
     }
     disk_data_.clear();
+    lru_.clear();
   }
 
   // Set defaults
@@ -268,6 +284,11 @@ void DiskCacheFolder::SetPath(const QString &path)
   consumption_ = 0;
   limit_ = 21474836480; // Default to 20 GB
 
+  // Anything still buffered belonged to the old folder
+  journal_buffer_.clear();
+  journal_stream_.device()->reset();
+  journal_record_count_ = 0;
+
   // Set path
   path_ = path;
 
@@ -276,52 +297,24 @@ void DiskCacheFolder::SetPath(const QString &path)
   path_dir.mkpath(QStringLiteral("."));
 
   index_path_ = path_dir.filePath(QStringLiteral("index"));
+  journal_path_ = path_dir.filePath(QStringLiteral("index.journal"));
 
-  // Try to load any current cache index from file
-  QFile cache_index_file(index_path_);
-
-  if (cache_index_file.open(QFile::ReadOnly)) {
-    QDataStream ds(&cache_index_file);
-
-    ds >> limit_;
-    ds >> clear_on_close_;
-
-    while (!cache_index_file.atEnd()) {
-      QByteArray hash;
-      HashTime h;
-
-      ds >> h.file_name;
-      ds >> hash;
-      ds >> h.file_size;
-      ds >> h.access_time;
-
-      if (QFileInfo::exists(h.file_name)) {
-        consumption_ += h.file_size;
-        disk_data_.insert(hash, h);
-      }
-    }
-
-    cache_index_file.close();
-  }
+  // Try to load any current cache index from file, then apply the changes made since
+  LoadSnapshot();
+  ReplayJournal();
 }
 
 QByteArray DiskCacheFolder::DeleteLeastRecent()
 {
-  auto hash_to_delete = disk_data_.begin();
+  QByteArray hash = lru_.front();
 
-  for (auto it=disk_data_.begin()+1; it!=disk_data_.end(); it++) {
-    if (it->access_time < hash_to_delete->access_time) {
-      hash_to_delete = it;
-    }
-  }
+  auto it = disk_data_.find(hash);
 
-  QByteArray hash = hash_to_delete.key();
-  HashTime ht = hash_to_delete.value();
-  disk_data_.erase(hash_to_delete);
+  QFile::remove(it->file_name);
 
-  QFile::remove(ht.file_name);
+  RemoveEntry(it);
 
-  consumption_ -= ht.file_size;
+  BeginJournalRecord(kJournalDeleted) << hash;
 
   return hash;
 }
@@ -339,31 +332,233 @@ void DiskCacheFolder::CloseCacheFolder()
   }
 
   // Save current cache index
-  SaveDiskCacheIndex();
+  CompactIndex();
 }
 
-void DiskCacheFolder::SaveDiskCacheIndex()
+void DiskCacheFolder::InsertEntry(const QByteArray &hash, const QString &file_name, qint64 file_size, qint64 access_time)
+{
+  auto existing = disk_data_.find(hash);
+  if (existing != disk_data_.end()) {
+    RemoveEntry(existing);
+  }
+
+  lru_.push_back(hash);
+
+  disk_data_.insert(hash, {file_name, file_size, access_time, std::prev(lru_.end())});
+
+  consumption_ += file_size;
+}
+
+void DiskCacheFolder::TouchEntry(QHash<QByteArray, HashTime>::iterator it, qint64 access_time)
+{
+  // Splicing keeps the iterator valid, so the entry doesn't need updating
+  lru_.splice(lru_.end(), lru_, it->lru_position);
+
+  it->access_time = access_time;
+}
+
+QHash<QByteArray, DiskCacheFolder::HashTime>::iterator DiskCacheFolder::RemoveEntry(QHash<QByteArray, HashTime>::iterator it)
+{
+  consumption_ -= it->file_size;
+
+  lru_.erase(it->lru_position);
+
+  return disk_data_.erase(it);
+}
+
+void DiskCacheFolder::LoadSnapshot()
 {
   QFile cache_index_file(index_path_);
 
+  if (!cache_index_file.open(QFile::ReadOnly)) {
+    return;
+  }
+
+  QDataStream ds(&cache_index_file);
+
+  ds >> limit_;
+  ds >> clear_on_close_;
+
+  struct LoadedEntry {
+    QByteArray hash;
+    HashTime h;
+  };
+
+  QVector<LoadedEntry> entries;
+
+  while (!cache_index_file.atEnd()) {
+    LoadedEntry e;
+
+    ds >> e.h.file_name;
+    ds >> e.hash;
+    ds >> e.h.file_size;
+    ds >> e.h.access_time;
+
+    if (QFileInfo::exists(e.h.file_name)) {
+      entries.append(e);
+    }
+  }
+
+  cache_index_file.close();
+
+  // Snapshots are written in access order, but older indexes were sorted by hash
+  std::stable_sort(entries.begin(), entries.end(), [](const LoadedEntry& a, const LoadedEntry& b){
+    return a.h.access_time < b.h.access_time;
+  });
+
+  foreach (const LoadedEntry& e, entries) {
+    InsertEntry(e.hash, e.h.file_name, e.h.file_size, e.h.access_time);
+  }
+}
+
+void DiskCacheFolder::ReplayJournal()
+{
+  QFile journal_file(journal_path_);
+
+  if (!journal_file.open(QFile::ReadOnly)) {
+    return;
+  }
+
+  QDataStream ds(&journal_file);
+
+  while (!journal_file.atEnd()) {
+    quint8 type = 0;
+    QByteArray hash;
+    QString file_name;
+    qint64 file_size = 0;
+    qint64 access_time = 0;
+    qint64 limit = 0;
+    bool clear_on_close = false;
+
+    ds >> type;
+
+    switch (type) {
+    case kJournalSettings:
+      ds >> limit >> clear_on_close;
+      break;
+    case kJournalCreated:
+      ds >> hash >> file_name >> file_size >> access_time;
+      break;
+    case kJournalAccessed:
+      ds >> hash >> access_time;
+      break;
+    case kJournalDeleted:
+      ds >> hash;
+      break;
+    default:
+      ds.setStatus(QDataStream::ReadCorruptData);
+    }
+
+    // A record cut short (e.g. by a crash while appending) ends the journal
+    if (ds.status() != QDataStream::Ok) {
+      qWarning() << "Ignoring incomplete disk cache journal record in" << journal_path_;
+      break;
+    }
+
+    switch (type) {
+    case kJournalSettings:
+      limit_ = limit;
+      clear_on_close_ = clear_on_close;
+      break;
+    case kJournalCreated:
+      if (QFileInfo::exists(file_name)) {
+        InsertEntry(hash, file_name, file_size, access_time);
+      }
+      break;
+    case kJournalAccessed:
+    {
+      auto it = disk_data_.find(hash);
+      if (it != disk_data_.end()) {
+        TouchEntry(it, access_time);
+      }
+      break;
+    }
+    case kJournalDeleted:
+    {
+      auto it = disk_data_.find(hash);
+      if (it != disk_data_.end()) {
+        RemoveEntry(it);
+      }
+      break;
+    }
+    }
+
+    journal_record_count_++;
+  }
+
+  journal_file.close();
+}
+
+QDataStream &DiskCacheFolder::BeginJournalRecord(JournalRecord type)
+{
+  journal_record_count_++;
+
+  journal_stream_ << static_cast<quint8>(type);
+
+  return journal_stream_;
+}
+
+void DiskCacheFolder::JournalSettings()
+{
+  BeginJournalRecord(kJournalSettings) << limit_ << clear_on_close_;
+}
+
+void DiskCacheFolder::CompactIndex()
+{
+  QSaveFile cache_index_file(index_path_);
+
   if (cache_index_file.open(QFile::WriteOnly)) {
     QDataStream ds(&cache_index_file);
 
     ds << limit_;
     ds << clear_on_close_;
 
-    for (auto it=disk_data_.cbegin(); it!=disk_data_.cend(); it++) {
-      const HashTime& ht = it.value();
+    // Written least recently used first so loading can rebuild the order as is
+    for (auto it=lru_.cbegin(); it!=lru_.cend(); it++) {
+      const HashTime& ht = disk_data_.constFind(*it).value();
 
       ds << ht.file_name;
-      ds << it.key();
+      ds << *it;
       ds << ht.file_size;
       ds << ht.access_time;
     }
 
-    cache_index_file.close();
+    if (cache_index_file.commit()) {
+      // Everything in the journal is now in the snapshot
+      QFile::remove(journal_path_);
+
+      journal_buffer_.clear();
+      journal_stream_.device()->reset();
+      journal_record_count_ = 0;
+      return;
+    }
+  }
+
+  qWarning() << "Failed to write cache index:" << index_path_;
+}
+
+void DiskCacheFolder::SaveDiskCacheIndex()
+{
+  // Once replaying the journal would take longer than loading the index, fold it back in
+  if (journal_record_count_ > qMax(kMinimumCompactRecords, static_cast<qint64>(disk_data_.size()))) {
+    CompactIndex();
+    return;
+  }
+
+  if (journal_buffer_.isEmpty()) {
+    return;
+  }
+
+  QFile journal_file(journal_path_);
+
+  if (journal_file.open(QFile::WriteOnly | QFile::Append)) {
+    journal_file.write(journal_buffer_);
+    journal_file.close();
+
+    journal_buffer_.clear();
+    journal_stream_.device()->reset();
   } else {
-    qWarning() << "Failed to write cache index:" << index_path_;
+    qWarning() << "Failed to write cache journal:" << journal_path_;
   }
 }
 
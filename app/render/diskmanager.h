@@ -21,7 +21,9 @@
 #ifndef DISKMANAGER_H
 #define DISKMANAGER_H
 
-#include <QMap>
+#include <list>
+#include <QDataStream>
+#include <QHash>
 #include <QMutex>
 #include <QObject>
 #include <QTimer>
@@ -31,6 +33,16 @@
 
 namespace olive {
 
+/**
+ * @brief Index of the frames stored in one disk cache folder, evicting the least recently used
+ *
+ * Entries are kept in a hash for lookup and a list ordered by access time, so marking a frame as
+ * accessed and evicting the oldest one are both constant time.
+ *
+ * The index is persisted as a snapshot plus an append-only journal of the changes since. Changes
+ * are buffered in memory and appended to the journal on a timer, and the journal is folded back
+ * into the snapshot once it grows larger than the index itself or when the folder is closed.
+ */
 class DiskCacheFolder : public QObject
 {
   Q_OBJECT
@@ -65,32 +77,83 @@ public:
   void SetLimit(qint64 l)
   {
     limit_ = l;
+    JournalSettings();
   }
 
   void SetClearOnClose(bool e)
   {
     clear_on_close_ = e;
+    JournalSettings();
   }
 
 signals:
   void DeletedFrame(const QString& path, const QByteArray& hash);
 
 private:
+  enum JournalRecord {
+    kJournalSettings,
+    kJournalCreated,
+    kJournalAccessed,
+    kJournalDeleted
+  };
+
+  struct HashTime {
+    QString file_name;
+    qint64 file_size;
+    qint64 access_time;
+    std::list<QByteArray>::iterator lru_position;
+  };
+
   QByteArray DeleteLeastRecent();
 
   void CloseCacheFolder();
 
+  /**
+   * @brief Add an entry as the most recently used, replacing any existing entry for this hash
+   */
+  void InsertEntry(const QByteArray& hash, const QString& file_name, qint64 file_size, qint64 access_time);
+
+  /**
+   * @brief Mark an existing entry as the most recently used
+   */
+  void TouchEntry(QHash<QByteArray, HashTime>::iterator it, qint64 access_time);
+
+  QHash<QByteArray, HashTime>::iterator RemoveEntry(QHash<QByteArray, HashTime>::iterator it);
+
+  void LoadSnapshot();
+
+  void ReplayJournal();
+
+  /**
+   * @brief Start a journal record of this type, returning the stream to write its fields to
+   */
+  QDataStream& BeginJournalRecord(JournalRecord type);
+
+  void JournalSettings();
+
+  /**
+   * @brief Rewrite the snapshot from the current index and empty the journal
+   */
+  void CompactIndex();
+
   QString path_;
 
   QString index_path_;
 
-  struct HashTime {
-    QString file_name;
-    qint64 file_size;
-    qint64 access_time;
-  };
+  QString journal_path_;
+
+  QHash<QByteArray, HashTime> disk_data_;
+
+  /// Hashes from least to most recently used
+  std::list<QByteArray> lru_;
 
-  QMap<QByteArray, HashTime> disk_data_;
+  /// Journal records not yet written to disk
+  QByteArray journal_buffer_;
+
+  QDataStream journal_stream_;
+
+  /// Number of records written or waiting to be written since the journal was last compacted
+  qint64 journal_record_count_;
 
   qint64 consumption_;
 
@@ -100,6 +163,8 @@ private:
 
   QTimer save_timer_;
 
+  static const qint64 kMinimumCompactRecords;
+
 private slots:
   void SaveDiskCacheIndex();
 
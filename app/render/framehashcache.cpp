@@ -27,11 +27,13 @@
 #include <OpenEXR/ImfIntAttribute.h>
 #include <OpenEXR/ImfOutputFile.h>
 #include <OpenEXR/ImfChannelList.h>
+#include <algorithm>
 #include <QDir>
 #include <QFileInfo>
 
 #include "codec/frame.h"
 #include "common/filefunctions.h"
+#include "common/ticktime.h"
 #include "common/timecodefunctions.h"
 #include "render/diskmanager.h"
 
@@ -40,8 +42,12 @@ namespace olive {
 QMutex FrameHashCache::currently_saving_frames_mutex_;
 QMap<QByteArray, FramePtr> FrameHashCache::currently_saving_frames_;
 
+const int FrameHashCache::kDigestSize;
+
 FrameHashCache::FrameHashCache(QObject *parent) :
-  PlaybackCache(parent)
+  PlaybackCache(parent),
+  frame_offset_(0),
+  hash_frame_map_valid_(true)
 {
   if (DiskManager::instance()) {
     connect(DiskManager::instance(), &DiskManager::DeletedFrame, this, &FrameHashCache::HashDeleted);
@@ -51,7 +57,13 @@ FrameHashCache::FrameHashCache(QObject *parent) :
 
 QByteArray FrameHashCache::GetHash(const rational &time)
 {
-  return time_hash_map_.value(time);
+  if (timebase_.isNull()) {
+    return QByteArray();
+  }
+
+  const FrameDigest* digest = GetDigest(Timecode::time_to_timestamp_floor(time, timebase_));
+
+  return digest ? FromDigest(*digest) : QByteArray();
 }
 
 void FrameHashCache::SetHash(const rational &time, const QByteArray &hash, const qint64& job_time, bool frame_exists)
@@ -66,7 +78,17 @@ void FrameHashCache::SetHash(const rational &time, const QByteArray &hash, const
     }
   }
 
-  time_hash_map_.insert(time, hash);
+  if (timebase_.isNull()) {
+    return;
+  }
+
+  FrameDigest digest;
+  if (!ToDigest(hash, &digest)) {
+    qWarning() << "Tried to set hash of unexpected size" << hash.size() << "in frame cache";
+    return;
+  }
+
+  InsertHash(Timecode::time_to_timestamp_floor(time, timebase_), digest);
 
   TimeRange validated_range;
   if (frame_exists) {
@@ -77,20 +99,48 @@ void FrameHashCache::SetHash(const rational &time, const QByteArray &hash, const
 
 void FrameHashCache::SetTimebase(const rational &tb)
 {
+  if (timebase_ == tb) {
+    return;
+  }
+
+  std::vector<FrameDigest> old_frames;
+  old_frames.swap(frames_);
+
+  int64_t old_offset = frame_offset_;
+  rational old_timebase = timebase_;
+
+  ClearHashes();
+
   timebase_ = tb;
+
+  if (old_timebase.isNull() || timebase_.isNull()) {
+    return;
+  }
+
+  // Keep the hashes of frames that still start on a frame in the new timebase
+  for (size_t i=0; i<old_frames.size(); i++) {
+    if (!old_frames[i].isNull()) {
+      rational new_index = Timecode::timestamp_to_time(old_offset + static_cast<int64_t>(i), old_timebase) / timebase_;
+
+      if (new_index.denominator() == 1) {
+        InsertHash(new_index.numerator(), old_frames[i]);
+      }
+    }
+  }
 }
 
 void FrameHashCache::ValidateFramesWithHash(const QByteArray &hash)
 {
   const TimeRangeList& invalidated_ranges = GetInvalidatedRanges();
 
-  for (auto iterator=time_hash_map_.begin();iterator!=time_hash_map_.end();iterator++) {
-    if (iterator.value() == hash) {
-      TimeRange frame_range(iterator.key(), iterator.key() + timebase_);
+  QVector<int64_t> frames = GetFrameIndicesWithHash(hash);
 
-      if (invalidated_ranges.contains(frame_range)) {
-        Validate(frame_range);
-      }
+  foreach (int64_t i, frames) {
+    rational t = GetFrameTime(i);
+    TimeRange frame_range(t, t + timebase_);
+
+    if (invalidated_ranges.contains(frame_range)) {
+      Validate(frame_range);
     }
   }
 }
@@ -99,10 +149,10 @@ QList<rational> FrameHashCache::GetFramesWithHash(const QByteArray &hash)
 {
   QList<rational> times;
 
-  for (auto iterator=time_hash_map_.begin();iterator!=time_hash_map_.end();iterator++) {
-    if (iterator.value() == hash) {
-      times.append(iterator.key());
-    }
+  QVector<int64_t> frames = GetFrameIndicesWithHash(hash);
+
+  foreach (int64_t i, frames) {
+    times.append(GetFrameTime(i));
   }
 
   return times;
@@ -113,17 +163,15 @@ QList<rational> FrameHashCache::TakeFramesWithHash(const QByteArray &hash)
   TimeRangeList range_to_invalidate;
   QList<rational> times;
 
-  auto iterator = time_hash_map_.begin();
+  QVector<int64_t> frames = GetFrameIndicesWithHash(hash);
 
-  while (iterator != time_hash_map_.end()) {
-    if (iterator.value() == hash) {
-      times.append(iterator.key());
-      range_to_invalidate.insert(TimeRange(iterator.key(), iterator.key() + timebase_));
+  foreach (int64_t i, frames) {
+    rational t = GetFrameTime(i);
 
-      iterator = time_hash_map_.erase(iterator);
-    } else {
-      iterator++;
-    }
+    times.append(t);
+    range_to_invalidate.insert(TimeRange(t, t + timebase_));
+
+    RemoveHashes(i, i + 1);
   }
 
   foreach (const TimeRange& r, range_to_invalidate) {
@@ -137,7 +185,15 @@ QList<rational> FrameHashCache::TakeFramesWithHash(const QByteArray &hash)
 
 QMap<rational, QByteArray> FrameHashCache::time_hash_map()
 {
-  return time_hash_map_;
+  QMap<rational, QByteArray> map;
+
+  for (size_t i=0; i<frames_.size(); i++) {
+    if (!frames_[i].isNull()) {
+      map.insert(GetFrameTime(frame_offset_ + static_cast<int64_t>(i)), FromDigest(frames_[i]));
+    }
+  }
+
+  return map;
 }
 
 QString FrameHashCache::GetFormatExtension()
@@ -147,30 +203,7 @@ QString FrameHashCache::GetFormatExtension()
 
 QVector<rational> FrameHashCache::GetFrameListFromTimeRange(TimeRangeList range_list, const rational &timebase)
 {
-  // If timebase is null, this will be an infinite loop
-  Q_ASSERT(!timebase.isNull());
-
-  QVector<rational> times;
-
-  while (!range_list.isEmpty()) {
-    const TimeRange& range = range_list.first();
-
-    rational time = range.in();
-    rational snapped = Timecode::snap_time_to_timebase(time, timebase);
-    rational next;
-
-    if (snapped > time) {
-      next = snapped;
-      snapped -= timebase;
-    } else {
-      next = snapped + timebase;
-    }
-
-    times.append(snapped);
-    range_list.remove(TimeRange(snapped, next));
-  }
-
-  return times;
+  return TimeRangeListFrameIterator(range_list, timebase).ToVector();
 }
 
 QVector<rational> FrameHashCache::GetFrameListFromTimeRange(const TimeRangeList &range)
@@ -326,68 +359,84 @@ FramePtr FrameHashCache::LoadCacheFrame(const QString &fn)
 
 void FrameHashCache::LengthChangedEvent(const rational &old, const rational &newlen)
 {
-  if (newlen < old) {
-    auto i = time_hash_map_.begin();
-
-    while (i != time_hash_map_.end()) {
-      if (i.key() >= newlen) {
-        i = time_hash_map_.erase(i);
-      } else {
-        i++;
-      }
-    }
+  if (newlen < old && !timebase_.isNull()) {
+    RemoveHashes(Timecode::time_to_timestamp_ceil(newlen, timebase_), frame_offset_ + static_cast<int64_t>(frames_.size()));
+    TrimFrames();
   }
 }
 
-struct HashTimePair {
-  rational time;
-  QByteArray hash;
-};
-
 void FrameHashCache::ShiftEvent(const rational &from, const rational &to)
 {
-  auto i = time_hash_map_.begin();
+  if (timebase_.isNull() || frames_.empty()) {
+    return;
+  }
 
   // POSITIVE if moving forward ->
   // NEGATIVE if moving backward <-
-  rational diff = to - from;
-  bool diff_is_negative = (diff < 0);
+  rational diff = (to - from) / timebase_;
 
-  QList<HashTimePair> shifted_times;
-
-  while (i != time_hash_map_.end()) {
-    if (diff_is_negative && i.key() >= to && i.key() < from) {
+  if (diff.denominator() != 1) {
+    // Shifted frames wouldn't land on a frame anymore so they can't be looked up again
+    RemoveHashes(Timecode::time_to_timestamp_ceil(qMin(from, to), timebase_), frame_offset_ + static_cast<int64_t>(frames_.size()));
+    TrimFrames();
+    return;
+  }
 
-      // This time will be removed in the shift so we just discard it
-      i = time_hash_map_.erase(i);
+  int64_t diff_frames = diff.numerator();
+  int64_t start = Timecode::time_to_timestamp_ceil(from, timebase_);
+  int64_t frame_end = frame_offset_ + static_cast<int64_t>(frames_.size());
 
-    } else if (i.key() >= from) {
+  if (start >= frame_end) {
+    // Nothing after the shift point
+    return;
+  }
 
-      // This time is after the from time and must be shifted
-      shifted_times.append({i.key() + diff, i.value()});
-      i = time_hash_map_.erase(i);
+  if (diff_frames > 0) {
 
+    if (start <= frame_offset_) {
+      // Every frame is moving so we just renumber them
+      frame_offset_ += diff_frames;
     } else {
+      // Open a gap at the shift point
+      frames_.insert(frames_.begin() + (start - frame_offset_), static_cast<size_t>(diff_frames), FrameDigest());
+    }
+
+  } else {
+
+    // Frames between `to` and `from` are spliced out and everything after moves back
+    int64_t splice_start = qMax(start + diff_frames, frame_offset_);
+    int64_t splice_end = qMax(start, frame_offset_);
 
-      // Do nothing
-      i++;
+    frames_.erase(frames_.begin() + (splice_start - frame_offset_), frames_.begin() + (splice_end - frame_offset_));
 
+    if (start + diff_frames < frame_offset_) {
+      frame_offset_ = splice_end + diff_frames;
     }
-  }
 
-  foreach (const HashTimePair& p, shifted_times) {
-    time_hash_map_.insert(p.time, p.hash);
   }
+
+  // Every frame after the shift point has a new number now
+  hash_frame_map_.clear();
+  hash_frame_map_valid_ = false;
+
+  TrimFrames();
 }
 
 void FrameHashCache::InvalidateEvent(const TimeRange &range)
 {
-  if (!timebase_.isNull()) {
-    QVector<rational> invalid_frames = GetFrameListFromTimeRange({range});
+  if (timebase_.isNull() || frames_.empty()) {
+    return;
+  }
 
-    foreach (const rational& r, invalid_frames) {
-      time_hash_map_.remove(r);
-    }
+  int64_t frame_end = frame_offset_ + static_cast<int64_t>(frames_.size());
+
+  // Clamp to the table first so open-ended ranges don't overflow when converted to frames
+  rational in = qMax(range.in(), GetFrameTime(frame_offset_));
+  rational out = qMin(range.out(), GetFrameTime(frame_end));
+
+  if (in < out) {
+    RemoveHashes(Timecode::time_to_timestamp_floor(in, timebase_), Timecode::time_to_timestamp_ceil(out, timebase_));
+    TrimFrames();
   }
 }
 
@@ -399,10 +448,11 @@ void FrameHashCache::HashDeleted(const QString& s, const QByteArray &hash)
   }
 
   TimeRangeList ranges_to_invalidate;
-  for (auto i=time_hash_map_.constBegin(); i!=time_hash_map_.constEnd(); i++) {
-    if (i.value() == hash) {
-      ranges_to_invalidate.insert(TimeRange(i.key(), i.key() + timebase_));
-    }
+  QVector<int64_t> frames = GetFrameIndicesWithHash(hash);
+
+  foreach (int64_t i, frames) {
+    rational t = GetFrameTime(i);
+    ranges_to_invalidate.insert(TimeRange(t, t + timebase_));
   }
 
   foreach (const TimeRange& range, ranges_to_invalidate) {
@@ -415,12 +465,195 @@ void FrameHashCache::HashDeleted(const QString& s, const QByteArray &hash)
 void FrameHashCache::ProjectInvalidated(Project *p)
 {
   if (GetProject() == p) {
-    time_hash_map_.clear();
+    ClearHashes();
 
     InvalidateAll();
   }
 }
 
+bool FrameHashCache::FrameDigest::isNull() const
+{
+  for (int i=0; i<kDigestSize; i++) {
+    if (data[i]) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool FrameHashCache::FrameDigest::operator==(const FrameDigest &rhs) const
+{
+  return !memcmp(data, rhs.data, kDigestSize);
+}
+
+bool FrameHashCache::ToDigest(const QByteArray &hash, FrameDigest *digest)
+{
+  if (hash.size() != kDigestSize) {
+    return false;
+  }
+
+  memcpy(digest->data, hash.constData(), kDigestSize);
+
+  return true;
+}
+
+QByteArray FrameHashCache::FromDigest(const FrameDigest &digest)
+{
+  return QByteArray(digest.data, kDigestSize);
+}
+
+rational FrameHashCache::GetFrameTime(int64_t index) const
+{
+  return TickTime(index, timebase_).toRational();
+}
+
+const FrameHashCache::FrameDigest *FrameHashCache::GetDigest(int64_t index) const
+{
+  if (index < frame_offset_ || index >= frame_offset_ + static_cast<int64_t>(frames_.size())) {
+    return nullptr;
+  }
+
+  const FrameDigest& digest = frames_[index - frame_offset_];
+
+  return digest.isNull() ? nullptr : &digest;
+}
+
+void FrameHashCache::InsertHash(int64_t index, const FrameDigest &digest)
+{
+  if (frames_.empty()) {
+    frame_offset_ = index;
+    frames_.resize(1);
+  } else if (index < frame_offset_) {
+    frames_.insert(frames_.begin(), static_cast<size_t>(frame_offset_ - index), FrameDigest());
+    frame_offset_ = index;
+  } else if (index >= frame_offset_ + static_cast<int64_t>(frames_.size())) {
+    frames_.resize(static_cast<size_t>(index - frame_offset_ + 1));
+  }
+
+  FrameDigest& slot = frames_[index - frame_offset_];
+
+  if (slot == digest) {
+    return;
+  }
+
+  if (hash_frame_map_valid_) {
+    if (!slot.isNull()) {
+      RemoveFromReverseIndex(slot, index);
+    }
+
+    hash_frame_map_[digest].insert(index);
+  }
+
+  slot = digest;
+}
+
+void FrameHashCache::RemoveHashes(int64_t start, int64_t end)
+{
+  start = qMax(start, frame_offset_);
+  end = qMin(end, frame_offset_ + static_cast<int64_t>(frames_.size()));
+
+  for (int64_t i=start; i<end; i++) {
+    FrameDigest& slot = frames_[i - frame_offset_];
+
+    if (slot.isNull()) {
+      continue;
+    }
+
+    if (hash_frame_map_valid_) {
+      RemoveFromReverseIndex(slot, i);
+    }
+
+    slot = FrameDigest();
+  }
+}
+
+void FrameHashCache::RemoveFromReverseIndex(const FrameDigest &digest, int64_t index)
+{
+  auto reverse = hash_frame_map_.find(digest);
+
+  if (reverse != hash_frame_map_.end()) {
+    reverse->remove(index);
+
+    if (reverse->isEmpty()) {
+      hash_frame_map_.erase(reverse);
+    }
+  }
+}
+
+void FrameHashCache::ClearHashes()
+{
+  std::vector<FrameDigest>().swap(frames_);
+  frame_offset_ = 0;
+
+  hash_frame_map_.clear();
+  hash_frame_map_valid_ = true;
+}
+
+void FrameHashCache::TrimFrames()
+{
+  while (!frames_.empty() && frames_.back().isNull()) {
+    frames_.pop_back();
+  }
+
+  size_t leading = 0;
+  while (leading < frames_.size() && frames_[leading].isNull()) {
+    leading++;
+  }
+
+  if (leading) {
+    frames_.erase(frames_.begin(), frames_.begin() + leading);
+    frame_offset_ += static_cast<int64_t>(leading);
+  }
+
+  if (frames_.empty()) {
+    frame_offset_ = 0;
+  }
+
+  // Give memory back after a large truncation without reallocating on every small one
+  if (frames_.capacity() / 2 > frames_.size()) {
+    frames_.shrink_to_fit();
+  }
+}
+
+const QHash<FrameHashCache::FrameDigest, QSet<int64_t> > &FrameHashCache::GetReverseIndex()
+{
+  if (!hash_frame_map_valid_) {
+    for (size_t i=0; i<frames_.size(); i++) {
+      if (!frames_[i].isNull()) {
+        hash_frame_map_[frames_[i]].insert(frame_offset_ + static_cast<int64_t>(i));
+      }
+    }
+
+    hash_frame_map_valid_ = true;
+  }
+
+  return hash_frame_map_;
+}
+
+QVector<int64_t> FrameHashCache::GetFrameIndicesWithHash(const QByteArray &hash)
+{
+  QVector<int64_t> indices;
+  FrameDigest digest;
+
+  if (ToDigest(hash, &digest)) {
+    const QHash<FrameDigest, QSet<int64_t> >& index = GetReverseIndex();
+    auto it = index.constFind(digest);
+
+    if (it != index.constEnd()) {
+      indices.reserve(it->size());
+
+      foreach (int64_t i, *it) {
+        indices.append(i);
+      }
+
+      std::sort(indices.begin(), indices.end());
+    }
+  }
+
+  return indices;
+}
+
 QString FrameHashCache::CachePathName(const QByteArray& hash) const
 {
   return CachePathName(GetCacheDirectory(), hash);
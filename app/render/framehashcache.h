@@ -21,7 +21,11 @@
 #ifndef VIDEORENDERFRAMECACHE_H
 #define VIDEORENDERFRAMECACHE_H
 
+#include <cstring>
+#include <QHash>
 #include <QMutex>
+#include <QSet>
+#include <vector>
 
 #include "common/rational.h"
 #include "common/timerange.h"
@@ -53,6 +57,9 @@ public:
    */
   QList<rational> TakeFramesWithHash(const QByteArray& hash);
 
+  /**
+   * @brief Returns a copy of every stored hash keyed by frame time
+   */
   QMap<rational, QByteArray> time_hash_map();
 
   /**
@@ -77,6 +84,11 @@ public:
   QVector<rational> GetInvalidatedFrames();
   QVector<rational> GetInvalidatedFrames(const TimeRange& intersecting);
 
+  /**
+   * @brief Size of the SHA-1 digests produced by RenderManager::Hash()
+   */
+  static const int kDigestSize = 20;
+
 public slots:
   void SetHash(const olive::rational& time, const QByteArray& hash, const qint64 &job_time, bool frame_exists);
 
@@ -88,7 +100,71 @@ protected:
   virtual void InvalidateEvent(const TimeRange& range) override;
 
 private:
-  QMap<rational, QByteArray> time_hash_map_;
+  /**
+   * @brief Fixed-size frame hash stored inline in the frame table
+   *
+   * An all-zero digest marks a frame without a hash.
+   */
+  struct FrameDigest {
+    char data[kDigestSize];
+
+    bool isNull() const;
+
+    bool operator==(const FrameDigest& rhs) const;
+
+    friend uint qHash(const FrameDigest& digest, uint seed)
+    {
+      // Digests are already uniformly distributed so any four bytes make a good hash
+      uint h;
+      memcpy(&h, digest.data, sizeof(h));
+      return h ^ seed;
+    }
+  };
+
+  static bool ToDigest(const QByteArray& hash, FrameDigest* digest);
+
+  static QByteArray FromDigest(const FrameDigest& digest);
+
+  rational GetFrameTime(int64_t index) const;
+
+  const FrameDigest* GetDigest(int64_t index) const;
+
+  /**
+   * @brief Set the hash of a frame, growing the table and keeping the reverse index up to date
+   */
+  void InsertHash(int64_t index, const FrameDigest& digest);
+
+  /**
+   * @brief Clear the hashes of frames [start, end), keeping the reverse index up to date
+   */
+  void RemoveHashes(int64_t start, int64_t end);
+
+  void RemoveFromReverseIndex(const FrameDigest& digest, int64_t index);
+
+  void ClearHashes();
+
+  /**
+   * @brief Drop empty frames from either end of the table
+   */
+  void TrimFrames();
+
+  /**
+   * @brief Returns the frames using each hash, rebuilding the index if a shift discarded it
+   */
+  const QHash<FrameDigest, QSet<int64_t> >& GetReverseIndex();
+
+  QVector<int64_t> GetFrameIndicesWithHash(const QByteArray& hash);
+
+  /// Hash of each frame from frame_offset_ onwards, indexed by frame number in timebase_
+  std::vector<FrameDigest> frames_;
+
+  int64_t frame_offset_;
+
+  /// Frames using each hash so they can be found without scanning the whole table. Since a shift
+  /// renumbers every later frame, it's discarded then and rebuilt the next time it's needed.
+  QHash<FrameDigest, QSet<int64_t> > hash_frame_map_;
+
+  bool hash_frame_map_valid_;
 
   rational timebase_;
 
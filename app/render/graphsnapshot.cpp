@@ -0,0 +1,297 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "graphsnapshot.h"
+
+#include <QDateTime>
+#include <QThread>
+
+namespace olive {
+
+QHash<NodeGraph*, std::weak_ptr<GraphSnapshotManager> > GraphSnapshotManager::instances_;
+const int GraphSnapshotManager::kMaxSpareSnapshots = 2;
+
+GraphSnapshot::GraphSnapshot(NodeGraph *source) :
+  sync_time_(0),
+  version_(0)
+{
+  // The default nodes of our project line up with the default nodes of the source project
+  for (int i=0; i<project_.nodes().size(); i++) {
+    InsertIntoCopyMap(source->nodes().at(i), project_.nodes().at(i));
+  }
+  for (int i=project_.nodes().size(); i<source->nodes().size(); i++) {
+    AddNode(source->nodes().at(i));
+  }
+
+  // Add all connections
+  foreach (Node* node, source->nodes()) {
+    for (auto it=node->input_connections().cbegin(); it!=node->input_connections().cend(); it++) {
+      AddEdge(it->second, it->first);
+    }
+  }
+
+  UpdateSyncTime();
+}
+
+GraphSnapshot::~GraphSnapshot()
+{
+  qDeleteAll(created_nodes_);
+}
+
+void GraphSnapshot::AddNode(Node *node)
+{
+  // Copy node
+  Node* copy = node->copy();
+
+  // Add to project
+  copy->setParent(&project_);
+
+  // Insert into map
+  InsertIntoCopyMap(node, copy);
+
+  // Keep track of our nodes
+  created_nodes_.append(copy);
+}
+
+void GraphSnapshot::RemoveNode(Node *node)
+{
+  // Find our copy and remove it
+  Node* copy = copy_map_.take(node);
+  original_map_.remove(copy);
+
+  // Remove from created list
+  created_nodes_.removeOne(copy);
+
+  // Delete it
+  delete copy;
+}
+
+void GraphSnapshot::AddEdge(const NodeOutput &output, const NodeInput &input)
+{
+  Node* our_output = copy_map_.value(output.node());
+  Node* our_input = copy_map_.value(input.node());
+
+  Node::ConnectEdge(NodeOutput(our_output, output.output()), NodeInput(our_input, input.input(), input.element()));
+}
+
+void GraphSnapshot::RemoveEdge(const NodeOutput &output, const NodeInput &input)
+{
+  Node* our_output = copy_map_.value(output.node());
+  Node* our_input = copy_map_.value(input.node());
+
+  Node::DisconnectEdge(NodeOutput(our_output, output.output()), NodeInput(our_input, input.input(), input.element()));
+}
+
+void GraphSnapshot::CopyValue(const NodeInput &input)
+{
+  Node* our_input = copy_map_.value(input.node());
+  Node::CopyValuesOfElement(input.node(), our_input, input.input(), input.element());
+}
+
+void GraphSnapshot::UpdateSyncTime()
+{
+  sync_time_ = QDateTime::currentMSecsSinceEpoch();
+}
+
+void GraphSnapshot::InsertIntoCopyMap(Node *node, Node *copy)
+{
+  // Insert into map
+  copy_map_.insert(node, copy);
+  original_map_.insert(copy, node);
+
+  // Copy parameters
+  Node::CopyInputs(node, copy, false);
+}
+
+GraphSnapshotManager::GraphSnapshotManager(NodeGraph *graph) :
+  graph_(graph),
+  history_start_(0)
+{
+  current_ = CreateSnapshot(graph_);
+
+  connect(graph_, &NodeGraph::NodeAdded, this, &GraphSnapshotManager::NodeAdded);
+  connect(graph_, &NodeGraph::NodeRemoved, this, &GraphSnapshotManager::NodeRemoved);
+  connect(graph_, &NodeGraph::InputConnected, this, &GraphSnapshotManager::EdgeAdded);
+  connect(graph_, &NodeGraph::InputDisconnected, this, &GraphSnapshotManager::EdgeRemoved);
+  connect(graph_, &NodeGraph::ValueChanged, this, &GraphSnapshotManager::ValueChanged);
+}
+
+GraphSnapshotManager::~GraphSnapshotManager()
+{
+  instances_.remove(graph_);
+}
+
+std::shared_ptr<GraphSnapshotManager> GraphSnapshotManager::Get(NodeGraph *graph)
+{
+  std::shared_ptr<GraphSnapshotManager> manager = instances_.value(graph).lock();
+
+  if (!manager) {
+    manager = std::shared_ptr<GraphSnapshotManager>(new GraphSnapshotManager(graph));
+    instances_.insert(graph, manager);
+  }
+
+  return manager;
+}
+
+GraphSnapshotPtr GraphSnapshotManager::Current()
+{
+  if (current_->GetVersion() == GetHeadVersion()) {
+    return current_;
+  }
+
+  if (current_.use_count() > 1) {
+    // A render is still using the current version, so rather than modifying it, bring the most
+    // recent spare that isn't in use any more up to date
+    spares_.prepend(current_);
+    current_ = nullptr;
+
+    for (int i=0; i<spares_.size(); i++) {
+      if (spares_.at(i).use_count() == 1) {
+        current_ = spares_.takeAt(i);
+        break;
+      }
+    }
+
+    if (!current_) {
+      // Every version we have is in use, copy the graph as it is now
+      current_ = CreateSnapshot(graph_);
+      current_->SetVersion(GetHeadVersion());
+    }
+
+    // Renders still holding the oldest spares will destroy them when they finish
+    while (spares_.size() > kMaxSpareSnapshots) {
+      spares_.removeLast();
+    }
+  }
+
+  ApplyHistory(current_.get());
+
+  TrimHistory();
+
+  return current_;
+}
+
+GraphSnapshotPtr GraphSnapshotManager::CreateSnapshot(NodeGraph *graph)
+{
+  return GraphSnapshotPtr(new GraphSnapshot(graph), &GraphSnapshotManager::DestroySnapshot);
+}
+
+void GraphSnapshotManager::DestroySnapshot(GraphSnapshot *snapshot)
+{
+  // The last reference may be released by a render thread, but nodes must be destroyed in the
+  // thread they belong to
+  if (QThread::currentThread() == snapshot->thread()) {
+    delete snapshot;
+  } else {
+    snapshot->deleteLater();
+  }
+}
+
+void GraphSnapshotManager::ApplyHistory(GraphSnapshot *snapshot)
+{
+  int start = static_cast<int>(snapshot->GetVersion() - history_start_);
+
+  // A node that was removed may have been deleted since, so it's never dereferenced by an update
+  // that comes before its last removal (its copy would be removed by then anyway)
+  QHash<Node*, int> last_removal;
+  for (int i=start; i<history_.size(); i++) {
+    if (history_.at(i).type == QueuedUpdate::kNodeRemoved) {
+      last_removal.insert(history_.at(i).node, i);
+    }
+  }
+
+  for (int i=start; i<history_.size(); i++) {
+    const QueuedUpdate& update = history_.at(i);
+
+    switch (update.type) {
+    case QueuedUpdate::kNodeAdded:
+      if (last_removal.value(update.node, -1) < i) {
+        snapshot->AddNode(update.node);
+      }
+      break;
+    case QueuedUpdate::kNodeRemoved:
+      if (snapshot->GetCopy(update.node)) {
+        snapshot->RemoveNode(update.node);
+      }
+      break;
+    case QueuedUpdate::kEdgeAdded:
+      if (snapshot->GetCopy(update.output.node()) && snapshot->GetCopy(update.input.node())) {
+        snapshot->AddEdge(update.output, update.input);
+      }
+      break;
+    case QueuedUpdate::kEdgeRemoved:
+      if (snapshot->GetCopy(update.output.node()) && snapshot->GetCopy(update.input.node())) {
+        snapshot->RemoveEdge(update.output, update.input);
+      }
+      break;
+    case QueuedUpdate::kValueChanged:
+      if (snapshot->GetCopy(update.input.node()) && last_removal.value(update.input.node(), -1) < i) {
+        snapshot->CopyValue(update.input);
+      }
+      break;
+    }
+  }
+
+  snapshot->SetVersion(GetHeadVersion());
+  snapshot->UpdateSyncTime();
+}
+
+void GraphSnapshotManager::TrimHistory()
+{
+  quint64 oldest = current_->GetVersion();
+
+  foreach (const GraphSnapshotPtr& spare, spares_) {
+    oldest = qMin(oldest, spare->GetVersion());
+  }
+
+  int seen_by_all = static_cast<int>(oldest - history_start_);
+
+  if (seen_by_all > 0) {
+    history_.remove(0, seen_by_all);
+    history_start_ = oldest;
+  }
+}
+
+void GraphSnapshotManager::NodeAdded(Node *node)
+{
+  history_.append({QueuedUpdate::kNodeAdded, node, NodeInput(), NodeOutput()});
+}
+
+void GraphSnapshotManager::NodeRemoved(Node *node)
+{
+  history_.append({QueuedUpdate::kNodeRemoved, node, NodeInput(), NodeOutput()});
+}
+
+void GraphSnapshotManager::EdgeAdded(const NodeOutput &output, const NodeInput &input)
+{
+  history_.append({QueuedUpdate::kEdgeAdded, nullptr, input, output});
+}
+
+void GraphSnapshotManager::EdgeRemoved(const NodeOutput &output, const NodeInput &input)
+{
+  history_.append({QueuedUpdate::kEdgeRemoved, nullptr, input, output});
+}
+
+void GraphSnapshotManager::ValueChanged(const NodeInput &input)
+{
+  history_.append({QueuedUpdate::kValueChanged, nullptr, input, NodeOutput()});
+}
+
+}
@@ -0,0 +1,219 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef GRAPHSNAPSHOT_H
+#define GRAPHSNAPSHOT_H
+
+#include <memory>
+#include <QHash>
+
+#include "node/project/project.h"
+
+namespace olive {
+
+/**
+ * @brief A private copy of a NodeGraph that renderers can read from without locking
+ *
+ * Snapshots are created and destroyed by GraphSnapshotManager. Once a render ticket has pinned a
+ * snapshot, it is never modified again. Edits to the original graph publish a new snapshot
+ * instead, and the old one is destroyed when the last ticket holding it is gone.
+ */
+class GraphSnapshot : public QObject
+{
+  Q_OBJECT
+public:
+  GraphSnapshot(NodeGraph* source);
+
+  virtual ~GraphSnapshot() override;
+
+  /**
+   * @brief Get this snapshot's copy of a node from the original graph
+   */
+  Node* GetCopy(Node* original) const
+  {
+    return copy_map_.value(original);
+  }
+
+  template <typename T>
+  T* GetCopy(T* original) const
+  {
+    return static_cast<T*>(copy_map_.value(original));
+  }
+
+  /**
+   * @brief Get the node in the original graph that a node in this snapshot was copied from
+   */
+  Node* GetOriginal(const Node* copy) const
+  {
+    return original_map_.value(copy);
+  }
+
+  /**
+   * @brief Time at which this snapshot was last brought in line with the original graph
+   */
+  qint64 GetSyncTime() const
+  {
+    return sync_time_;
+  }
+
+  /**
+   * @brief Position in its manager's edit history that this snapshot has been brought up to
+   */
+  quint64 GetVersion() const
+  {
+    return version_;
+  }
+
+  void SetVersion(quint64 version)
+  {
+    version_ = version;
+  }
+
+  void AddNode(Node* node);
+  void RemoveNode(Node* node);
+  void AddEdge(const NodeOutput& output, const NodeInput& input);
+  void RemoveEdge(const NodeOutput& output, const NodeInput& input);
+  void CopyValue(const NodeInput& input);
+
+  void UpdateSyncTime();
+
+private:
+  void InsertIntoCopyMap(Node* node, Node* copy);
+
+  Project project_;
+
+  QHash<Node*, Node*> copy_map_;
+
+  QHash<const Node*, Node*> original_map_;
+
+  QVector<Node*> created_nodes_;
+
+  qint64 sync_time_;
+
+  quint64 version_;
+
+};
+
+using GraphSnapshotPtr = std::shared_ptr<GraphSnapshot>;
+
+/**
+ * @brief Publishes versioned GraphSnapshots of a NodeGraph
+ *
+ * There is one manager per graph, shared by everything that renders from it, so additional
+ * viewers of the same graph don't make additional copies of it.
+ *
+ * Edits to the graph are recorded and applied when Current() is next called. If nothing but the
+ * manager holds the current snapshot, the edits are applied to it directly. Otherwise, it's pinned
+ * by a render in progress and kept as a spare, and the most recent spare that renders have
+ * released is brought up to date instead by replaying the edits it missed. Edits never wait for
+ * rendering to finish, and the cost of publishing a version is proportional to the edits rather
+ * than the size of the graph. The whole graph is only copied again when every spare is pinned.
+ */
+class GraphSnapshotManager : public QObject
+{
+  Q_OBJECT
+public:
+  virtual ~GraphSnapshotManager() override;
+
+  DISABLE_COPY_MOVE(GraphSnapshotManager)
+
+  /**
+   * @brief Get the manager for a graph, creating it if no one is using one yet
+   */
+  static std::shared_ptr<GraphSnapshotManager> Get(NodeGraph* graph);
+
+  /**
+   * @brief Get an up-to-date snapshot of the graph
+   *
+   * Anything that hands this snapshot to another thread must keep a reference to it for as long
+   * as that thread uses it (e.g. by passing it as `pinned_data` to RenderManager::RenderFrame()).
+   */
+  GraphSnapshotPtr Current();
+
+private:
+  GraphSnapshotManager(NodeGraph* graph);
+
+  static GraphSnapshotPtr CreateSnapshot(NodeGraph* graph);
+
+  quint64 GetHeadVersion() const
+  {
+    return history_start_ + history_.size();
+  }
+
+  /**
+   * @brief Replay the edits a snapshot hasn't seen yet
+   */
+  void ApplyHistory(GraphSnapshot* snapshot);
+
+  /**
+   * @brief Forget edits that every snapshot we hold has already seen
+   */
+  void TrimHistory();
+
+  static void DestroySnapshot(GraphSnapshot* snapshot);
+
+  struct QueuedUpdate {
+    enum Type {
+      kNodeAdded,
+      kNodeRemoved,
+      kEdgeAdded,
+      kEdgeRemoved,
+      kValueChanged
+    };
+
+    Type type;
+    Node* node;
+    NodeInput input;
+    NodeOutput output;
+  };
+
+  NodeGraph* graph_;
+
+  GraphSnapshotPtr current_;
+
+  /// Earlier snapshots, most recent first, to bring up to date again once renders release them
+  QVector<GraphSnapshotPtr> spares_;
+
+  /// Edits not yet seen by every snapshot we hold, the first one moves a snapshot past version
+  /// `history_start_`
+  QVector<QueuedUpdate> history_;
+
+  quint64 history_start_;
+
+  static const int kMaxSpareSnapshots;
+
+  static QHash<NodeGraph*, std::weak_ptr<GraphSnapshotManager> > instances_;
+
+private slots:
+  void NodeAdded(Node* node);
+
+  void NodeRemoved(Node* node);
+
+  void EdgeAdded(const NodeOutput& output, const NodeInput& input);
+
+  void EdgeRemoved(const NodeOutput& output, const NodeInput& input);
+
+  void ValueChanged(const NodeInput& input);
+
+};
+
+}
+
+#endif // GRAPHSNAPSHOT_H
@@ -20,6 +20,7 @@
 
 #include "openglrenderer.h"
 
+#include <cstring>
 #include <QDebug>
 #include <QOpenGLExtraFunctions>
 
@@ -75,7 +76,8 @@ private:
 
 OpenGLRenderer::OpenGLRenderer(QObject* parent) :
   Renderer(parent),
-  context_(nullptr)
+  context_(nullptr),
+  share_context_(nullptr)
 {
 }
 
@@ -105,6 +107,7 @@ bool OpenGLRenderer::Init()
   surface_.create();
 
   context_ = new QOpenGLContext(this);
+  context_->setShareContext(share_context_);
   if (!context_->create()) {
     qCritical() << "Failed to create OpenGL context";
     return false;
@@ -143,6 +146,9 @@ void OpenGLRenderer::PostInit()
 void OpenGLRenderer::DestroyInternal()
 {
   if (context_) {
+    // Free pooled textures while the context still exists
+    ClearTexturePool();
+
     // Delete framebuffer
     functions_->glDeleteFramebuffers(1, &framebuffer_);
 
@@ -259,12 +265,22 @@ QVariant OpenGLRenderer::CreateNativeShader(ShaderCode code)
   vert_code.prepend(shader_preamble);
   frag_code.prepend(shader_preamble);
 
+#if QT_VERSION >= QT_VERSION_CHECK(5, 9, 0)
+  // Cacheable shaders are linked from a program binary stored on disk by Qt if one exists for this
+  // code, which saves compiling them again in later sessions
+  if (!program->addCacheableShaderFromSourceCode(QOpenGLShader::Vertex, vert_code)) {
+#else
   if (!program->addShaderFromSourceCode(QOpenGLShader::Vertex, vert_code)) {
+#endif
     qCritical() << "Failed to add vertex code to shader";
     goto error;
   }
 
+#if QT_VERSION >= QT_VERSION_CHECK(5, 9, 0)
+  if (!program->addCacheableShaderFromSourceCode(QOpenGLShader::Fragment, frag_code)) {
+#else
   if (!program->addShaderFromSourceCode(QOpenGLShader::Fragment, frag_code)) {
+#endif
     qCritical() << "Failed to add fragment code to shader";
     goto error;
   }
@@ -340,6 +356,102 @@ void OpenGLRenderer::DownloadFromTexture(Texture* texture, void *data, int lines
   functions_->glBindTexture(GL_TEXTURE_2D, current_tex);
 }
 
+void OpenGLRenderer::FinishPendingCommands()
+{
+  // Other contexts only see our changes to shared objects once the commands have completed
+  if (context_->shareGroup()->shares().size() > 1) {
+    functions_->glFinish();
+  }
+}
+
+QVariant OpenGLRenderer::StartDownloadFromTexture(Texture *texture, int linesize)
+{
+  PRINT_GL_ERRORS;
+
+  const VideoParams& p = texture->params();
+  QOpenGLExtraFunctions* xf = context_->extraFunctions();
+
+  bool gles = (QOpenGLContext::openGLModuleType() == QOpenGLContext::LibGLES);
+  int read_channels = gles ? VideoParams::kRGBAChannelCount : p.channel_count();
+
+  PixelDownload* d = new PixelDownload();
+  d->size = VideoParams::GetBufferSize(linesize, p.effective_height(), p.format(), read_channels);
+
+  // Allocate a pixel buffer laid out exactly like the destination so finishing is a single copy
+  xf->glGenBuffers(1, &d->buffer);
+  xf->glBindBuffer(GL_PIXEL_PACK_BUFFER, d->buffer);
+  xf->glBufferData(GL_PIXEL_PACK_BUFFER, d->size, nullptr, GL_STREAM_READ);
+
+  GLint current_tex;
+  functions_->glGetIntegerv(GL_TEXTURE_BINDING_2D, &current_tex);
+
+  AttachTextureAsDestination(texture);
+
+  functions_->glPixelStorei(GL_PACK_ROW_LENGTH, linesize);
+
+  // With a pack buffer bound, this only queues the transfer and returns immediately
+  functions_->glReadPixels(0,
+                           0,
+                           p.effective_width(),
+                           p.effective_height(),
+                           gles ? GL_RGBA : GetPixelFormat(p.channel_count()),
+                           GetPixelType(p.format()),
+                           nullptr);
+
+  functions_->glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+
+  DetachTextureAsDestination();
+
+  functions_->glBindTexture(GL_TEXTURE_2D, current_tex);
+
+  xf->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  d->fence = xf->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+  // Make sure the fence actually reaches the GPU, otherwise polling it may never succeed
+  functions_->glFlush();
+
+  return Node::PtrToValue(d);
+}
+
+bool OpenGLRenderer::WaitForDownload(QVariant download, qint64 timeout)
+{
+  PixelDownload* d = Node::ValueToPtr<PixelDownload>(download);
+
+  GLenum status = context_->extraFunctions()->glClientWaitSync(d->fence, 0, static_cast<GLuint64>(qMax(timeout, qint64(0))));
+
+  // If waiting failed, let FinishDownload() block on mapping the buffer instead of polling forever
+  return status != GL_TIMEOUT_EXPIRED;
+}
+
+void OpenGLRenderer::FinishDownload(QVariant download, void *data)
+{
+  PRINT_GL_ERRORS;
+
+  PixelDownload* d = Node::ValueToPtr<PixelDownload>(download);
+  QOpenGLExtraFunctions* xf = context_->extraFunctions();
+
+  if (data) {
+    xf->glBindBuffer(GL_PIXEL_PACK_BUFFER, d->buffer);
+
+    void* mapped = xf->glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, d->size, GL_MAP_READ_BIT);
+
+    if (mapped) {
+      memcpy(data, mapped, d->size);
+      xf->glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    } else {
+      qCritical() << "Failed to map pixel buffer for download";
+    }
+
+    xf->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  }
+
+  xf->glDeleteSync(d->fence);
+  xf->glDeleteBuffers(1, &d->buffer);
+
+  delete d;
+}
+
 struct TextureToBind {
   TexturePtr texture;
   Texture::Interpolation interpolation;
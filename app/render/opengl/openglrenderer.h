@@ -42,6 +42,16 @@ public:
 
   void Init(QOpenGLContext* existing_ctx);
 
+  /**
+   * @brief Share textures, buffers and shaders with this context's share group
+   *
+   * Must be called before Init() to have any effect.
+   */
+  void SetShareContext(QOpenGLContext* share)
+  {
+    share_context_ = share;
+  }
+
   virtual bool Init() override;
 
   virtual void PostDestroy() override;
@@ -66,6 +76,14 @@ public slots:
 
   virtual void DownloadFromTexture(olive::Texture* texture, void* data, int linesize) override;
 
+  virtual void FinishPendingCommands() override;
+
+  virtual QVariant StartDownloadFromTexture(olive::Texture* texture, int linesize) override;
+
+  virtual bool WaitForDownload(QVariant download, qint64 timeout) override;
+
+  virtual void FinishDownload(QVariant download, void* data) override;
+
 protected slots:
   virtual void Blit(QVariant shader,
                     olive::ShaderJob job,
@@ -74,6 +92,15 @@ protected slots:
                     bool clear_destination) override;
 
 private:
+  /**
+   * @brief Readback in progress into a pixel buffer object
+   */
+  struct PixelDownload {
+    GLuint buffer;
+    GLsync fence;
+    int size;
+  };
+
   static GLint GetInternalFormat(VideoParams::Format format, int channel_layout);
 
   static GLenum GetPixelType(VideoParams::Format format);
@@ -88,6 +115,8 @@ private:
 
   QOpenGLContext* context_;
 
+  QOpenGLContext* share_context_;
+
   QOpenGLFunctions* functions_;
 
   QOffscreenSurface surface_;
@@ -15,7 +15,6 @@ PreviewAutoCacher::PreviewAutoCacher() :
   has_changed_(false),
   use_custom_range_(false),
   single_frame_render_(nullptr),
-  last_update_time_(0),
   ignore_next_mouse_button_(false)
 {
   SetPlayhead(0);
@@ -31,7 +30,7 @@ PreviewAutoCacher::~PreviewAutoCacher()
   SetViewerNode(nullptr);
 }
 
-RenderTicketPtr PreviewAutoCacher::GetSingleFrame(const rational &t, bool prioritize)
+RenderTicketPtr PreviewAutoCacher::GetSingleFrame(const rational &t, RenderTicket::Priority priority)
 {
   CancelQueuedSingleFrameRender();
 
@@ -43,7 +42,7 @@ RenderTicketPtr PreviewAutoCacher::GetSingleFrame(const rational &t, bool priori
   auto sfr = std::make_shared<RenderTicket>();
   sfr->Start();
   sfr->setProperty("time", QVariant::fromValue(t));
-  sfr->setProperty("prioritize", prioritize);
+  sfr->setProperty("priority", QVariant::fromValue(priority));
   sfr->setProperty("hash", hash);
 
   // Attempt to queue
@@ -58,8 +57,11 @@ void PreviewAutoCacher::SetPaused(bool paused)
   paused_ = paused;
 }
 
-void PreviewAutoCacher::GenerateHashes(ViewerOutput *viewer, FrameHashCache* cache, const QVector<rational> &times, qint64 job_time)
+void PreviewAutoCacher::GenerateHashes(GraphSnapshotPtr snapshot, ViewerOutput *viewer, FrameHashCache* cache, const QVector<rational> &times, qint64 job_time)
 {
+  // Hash from the snapshot, the original graph may be modified while we're working
+  viewer = snapshot->GetCopy(viewer);
+
   std::vector<QByteArray> existing_hashes;
 
   foreach (const rational& time, times) {
@@ -122,11 +124,6 @@ void PreviewAutoCacher::HashesProcessed()
     delayed_requeue_timer_.start();
   }
 
-  // The cacher might be waiting for this job to finish
-  if (!graph_update_queue_.isEmpty()) {
-    TryRender();
-  }
-
   delete watcher;
 }
 
@@ -142,18 +139,13 @@ void PreviewAutoCacher::AudioRendered()
 
       // Retrieve visual waveforms
       QVector<RenderProcessor::RenderedWaveform> waveform_list = watcher->GetTicket()->property("waveforms").value< QVector<RenderProcessor::RenderedWaveform> >();
-      foreach (const RenderProcessor::RenderedWaveform& waveform_info, waveform_list) {
-        // Find original track
-        Track* track = nullptr;
+      GraphSnapshot* snapshot = static_cast<GraphSnapshot*>(watcher->GetTicket()->GetPinnedData().get());
 
-        for (auto it=copy_map_.cbegin(); it!=copy_map_.cend(); it++) {
-          if (it.value() == waveform_info.track) {
-            track = static_cast<Track*>(it.key());
-            break;
-          }
-        }
+      foreach (const RenderProcessor::RenderedWaveform& waveform_info, waveform_list) {
+        // Find original track, which may have been removed since this snapshot was taken
+        Track* track = static_cast<Track*>(snapshot->GetOriginal(waveform_info.track));
 
-        if (track) {
+        if (track && viewer_node_->parent()->nodes().contains(track)) {
           QList<TimeRange> valid_ranges = viewer_node_->audio_playback_cache()->GetValidRanges(waveform_info.range,
                                                                                                watcher->GetTicket()->GetJobTime());
           if (!valid_ranges.isEmpty()) {
@@ -173,11 +165,6 @@ void PreviewAutoCacher::AudioRendered()
     audio_tasks_.remove(watcher);
   }
 
-  // The cacher might be waiting for this job to finish
-  if (!graph_update_queue_.isEmpty()) {
-    TryRender();
-  }
-
   delete watcher;
 }
 
@@ -216,11 +203,6 @@ void PreviewAutoCacher::VideoRendered()
     }
   }
 
-  // The cacher might be waiting for this job to finish
-  if (!graph_update_queue_.isEmpty()) {
-    TryRender();
-  }
-
   delete watcher;
 }
 
@@ -242,110 +224,9 @@ void PreviewAutoCacher::VideoDownloaded()
     video_download_tasks_.remove(watcher);
   }
 
-  // The cacher might be waiting for this job to finish
-  if (!graph_update_queue_.isEmpty()) {
-    TryRender();
-  }
-
   delete watcher;
 }
 
-void PreviewAutoCacher::ProcessUpdateQueue()
-{
-  foreach (const QueuedJob& job, graph_update_queue_) {
-    switch (job.type) {
-    case QueuedJob::kNodeAdded:
-      AddNode(job.node);
-      break;
-    case QueuedJob::kNodeRemoved:
-      RemoveNode(job.node);
-      break;
-    case QueuedJob::kEdgeAdded:
-      AddEdge(job.output, job.input);
-      break;
-    case QueuedJob::kEdgeRemoved:
-      RemoveEdge(job.output, job.input);
-      break;
-    case QueuedJob::kValueChanged:
-      CopyValue(job.input);
-      break;
-    }
-  }
-  graph_update_queue_.clear();
-
-  UpdateLastSyncedValue();
-}
-
-bool PreviewAutoCacher::HasActiveJobs() const
-{
-  return !hash_tasks_.isEmpty()
-      || !audio_tasks_.isEmpty()
-      || !video_tasks_.isEmpty();
-}
-
-void PreviewAutoCacher::AddNode(Node *node)
-{
-  // Copy node
-  Node* copy = node->copy();
-
-  // Add to project
-  copy->setParent(&copied_project_);
-
-  // Insert into map
-  InsertIntoCopyMap(node, copy);
-
-  // Keep track of our nodes
-  created_nodes_.append(copy);
-}
-
-void PreviewAutoCacher::RemoveNode(Node *node)
-{
-  // Find our copy and remove it
-  Node* copy = copy_map_.take(node);
-
-  // Remove from created list
-  created_nodes_.removeOne(copy);
-
-  // Delete it
-  delete copy;
-}
-
-void PreviewAutoCacher::AddEdge(const NodeOutput &output, const NodeInput &input)
-{
-  Node* our_output = copy_map_.value(output.node());
-  Node* our_input = copy_map_.value(input.node());
-
-  Node::ConnectEdge(NodeOutput(our_output, output.output()), NodeInput(our_input, input.input(), input.element()));
-}
-
-void PreviewAutoCacher::RemoveEdge(const NodeOutput &output, const NodeInput &input)
-{
-  Node* our_output = copy_map_.value(output.node());
-  Node* our_input = copy_map_.value(input.node());
-
-  Node::DisconnectEdge(NodeOutput(our_output, output.output()), NodeInput(our_input, input.input(), input.element()));
-}
-
-void PreviewAutoCacher::CopyValue(const NodeInput &input)
-{
-  Node* our_input = copy_map_.value(input.node());
-  Node::CopyValuesOfElement(input.node(), our_input, input.input(), input.element());
-}
-
-void PreviewAutoCacher::InsertIntoCopyMap(Node *node, Node *copy)
-{
-  // Insert into map
-  copy_map_.insert(node, copy);
-
-  // Copy parameters
-  Node::CopyInputs(node, copy, false);
-}
-
-void PreviewAutoCacher::UpdateLastSyncedValue()
-{
-  last_update_time_ = QDateTime::currentMSecsSinceEpoch();
-}
-
 void PreviewAutoCacher::CancelQueuedSingleFrameRender()
 {
   if (single_frame_render_) {
@@ -401,44 +282,12 @@ void PreviewAutoCacher::ClearVideoDownloadQueue(bool hard)
   ClearQueueInternal(video_download_tasks_, hard, &PreviewAutoCacher::VideoDownloaded);
 }
 
-void PreviewAutoCacher::NodeAdded(Node *node)
-{
-  graph_update_queue_.append({QueuedJob::kNodeAdded, node, NodeInput(), NodeOutput()});
-}
-
-void PreviewAutoCacher::NodeRemoved(Node *node)
-{
-  graph_update_queue_.append({QueuedJob::kNodeRemoved, node, NodeInput(), NodeOutput()});
-}
-
-void PreviewAutoCacher::EdgeAdded(const NodeOutput &output, const NodeInput &input)
-{
-  graph_update_queue_.append({QueuedJob::kEdgeAdded, nullptr, input, output});
-}
-
-void PreviewAutoCacher::EdgeRemoved(const NodeOutput &output, const NodeInput &input)
-{
-  graph_update_queue_.append({QueuedJob::kEdgeRemoved, nullptr, input, output});
-}
-
-void PreviewAutoCacher::ValueChanged(const NodeInput &input)
-{
-  graph_update_queue_.append({QueuedJob::kValueChanged, nullptr, input, NodeOutput()});
-}
-
 void PreviewAutoCacher::TryRender()
 {
-  if (!graph_update_queue_.isEmpty()) {
-    if (HasActiveJobs()) {
-      // Still waiting for jobs to finish
-      return;
-    }
+  // Any edits since the last render are published as a new snapshot here, tickets that are
+  // already queued keep rendering from the snapshot they were queued with
+  GraphSnapshotPtr snapshot = snapshots_->Current();
 
-    // No jobs are active, we can process the update queue
-    ProcessUpdateQueue();
-  }
-
-  // If we're here, we must be able to render
   if (!invalidated_video_.isEmpty()) {
     QVector<rational> frames = viewer_node_->video_frame_cache()->GetFrameListFromTimeRange(invalidated_video_);
 
@@ -446,10 +295,11 @@ void PreviewAutoCacher::TryRender()
     hash_tasks_.append(watcher);
     connect(watcher, &QFutureWatcher<void>::finished, this, &PreviewAutoCacher::HashesProcessed);
     watcher->setFuture(QtConcurrent::run(&PreviewAutoCacher::GenerateHashes,
-                                         copied_viewer_node_,
+                                         snapshot,
+                                         viewer_node_,
                                          viewer_node_->video_frame_cache(),
                                          frames,
-                                         last_update_time_));
+                                         snapshot->GetSyncTime()));
 
     invalidated_video_.clear();
   }
@@ -462,7 +312,10 @@ void PreviewAutoCacher::TryRender()
         RenderTicketWatcher* watcher = new RenderTicketWatcher();
         connect(watcher, &RenderTicketWatcher::Finished, this, &PreviewAutoCacher::AudioRendered);
         audio_tasks_.insert(watcher, r);
-        watcher->SetTicket(RenderManager::instance()->RenderAudio(copied_viewer_node_, r, true));
+
+        RenderTicketPtr ticket = RenderManager::instance()->RenderAudio(snapshot->GetCopy(viewer_node_), r, true,
+                                                                        RenderTicket::kPriorityAudio, snapshot);
+        watcher->SetTicket(ticket);
       }
     }
 
@@ -480,7 +333,7 @@ void PreviewAutoCacher::TryRender()
     } else {
       watcher = RenderFrame(hash,
                             single_frame_render_->property("time").value<rational>(),
-                            single_frame_render_->property("prioritize").toBool());
+                            single_frame_render_->property("priority").value<RenderTicket::Priority>());
 
       video_immediate_passthroughs_[watcher].append(single_frame_render_);
     }
@@ -489,18 +342,24 @@ void PreviewAutoCacher::TryRender()
   }
 }
 
-RenderTicketWatcher* PreviewAutoCacher::RenderFrame(const QByteArray &hash, const rational& time, bool prioritize)
+RenderTicketWatcher* PreviewAutoCacher::RenderFrame(const QByteArray &hash, const rational& time, RenderTicket::Priority priority)
 {
   RenderTicketWatcher* watcher = new RenderTicketWatcher();
   watcher->setProperty("hash", hash);
   connect(watcher, &RenderTicketWatcher::Finished, this, &PreviewAutoCacher::VideoRendered);
   video_tasks_.insert(watcher, hash);
-  watcher->SetTicket(RenderManager::instance()->RenderFrame(copied_viewer_node_,
-                                                            copied_color_manager_,
-                                                            time,
-                                                            RenderMode::kOffline,
-                                                            viewer_node_->video_frame_cache(),
-                                                            prioritize));
+
+  GraphSnapshotPtr snapshot = snapshots_->Current();
+
+  RenderTicketPtr ticket = RenderManager::instance()->RenderFrame(snapshot->GetCopy(viewer_node_),
+                                                                  snapshot->GetCopy(viewer_node_->project()->color_manager()),
+                                                                  time,
+                                                                  RenderMode::kOffline,
+                                                                  viewer_node_->video_frame_cache(),
+                                                                  priority,
+                                                                  snapshot);
+  watcher->SetTicket(ticket);
+
   return watcher;
 }
 
@@ -535,13 +394,14 @@ void PreviewAutoCacher::RequeueFrames()
         // We want this hash, if we're not already rendering, start render now
         if (!render_task && !video_download_tasks_.key(hash)) {
           // Don't render any hash more than once
-          RenderFrame(hash, t, false);
+          RenderFrame(hash, t, RenderTicket::kPriorityBackground);
         }
       } else if (render_task) {
         // Cancel this frame unless it's already started
         QMutexLocker locker(render_task->GetTicket()->lock());
 
         if (!render_task->GetTicket()->IsRunning(false)) {
+          RenderManager::instance()->RemoveTicket(render_task->GetTicket());
           video_tasks_.remove(render_task);
           delete render_task;
         }
@@ -595,21 +455,8 @@ void PreviewAutoCacher::SetViewerNode(ViewerOutput *viewer_node)
     // No more immediate passthroughts
     video_immediate_passthroughs_.clear();
 
-    // Delete all of our copied nodes
-    qDeleteAll(created_nodes_);
-    created_nodes_.clear();
-    copy_map_.clear();
-    copied_viewer_node_ = nullptr;
-    graph_update_queue_.clear();
-
-    // Disconnect signals for future node additions/deletions
-    NodeGraph* graph = viewer_node_->parent();
-
-    disconnect(graph, &NodeGraph::NodeAdded, this, &PreviewAutoCacher::NodeAdded);
-    disconnect(graph, &NodeGraph::NodeRemoved, this, &PreviewAutoCacher::NodeRemoved);
-    disconnect(graph, &NodeGraph::InputConnected, this, &PreviewAutoCacher::EdgeAdded);
-    disconnect(graph, &NodeGraph::InputDisconnected, this, &PreviewAutoCacher::EdgeRemoved);
-    disconnect(graph, &NodeGraph::ValueChanged, this, &PreviewAutoCacher::ValueChanged);
+    // Release our snapshots, they'll be destroyed once no ticket is using them any more
+    snapshots_ = nullptr;
 
     // Disconnect signal (will be a no-op if the signal was never connected)
     disconnect(viewer_node_->video_frame_cache(),
@@ -626,36 +473,8 @@ void PreviewAutoCacher::SetViewerNode(ViewerOutput *viewer_node)
   viewer_node_ = viewer_node;
 
   if (viewer_node_) {
-    // Copy graph
-    NodeGraph* graph = viewer_node_->parent();
-
-    // Add all nodes
-    for (int i=0; i<copied_project_.nodes().size(); i++) {
-      InsertIntoCopyMap(graph->nodes().at(i), copied_project_.nodes().at(i));
-    }
-    for (int i=copied_project_.nodes().size(); i<graph->nodes().size(); i++) {
-      AddNode(graph->nodes().at(i));
-    }
-
-    // Find copied viewer node
-    copied_viewer_node_ = static_cast<ViewerOutput*>(copy_map_.value(viewer_node_));
-    copied_color_manager_ = static_cast<ColorManager*>(copy_map_.value(viewer_node_->project()->color_manager()));
-
-    // Add all connections
-    foreach (Node* node, graph->nodes()) {
-      for (auto it=node->input_connections().cbegin(); it!=node->input_connections().cend(); it++) {
-        AddEdge(it->second, it->first);
-      }
-    }
-
-    UpdateLastSyncedValue();
-
-    // Connect signals for future node additions/deletions
-    connect(graph, &NodeGraph::NodeAdded, this, &PreviewAutoCacher::NodeAdded);
-    connect(graph, &NodeGraph::NodeRemoved, this, &PreviewAutoCacher::NodeRemoved);
-    connect(graph, &NodeGraph::InputConnected, this, &PreviewAutoCacher::EdgeAdded);
-    connect(graph, &NodeGraph::InputDisconnected, this, &PreviewAutoCacher::EdgeRemoved);
-    connect(graph, &NodeGraph::ValueChanged, this, &PreviewAutoCacher::ValueChanged);
+    // Share snapshots with anything else rendering from this graph
+    snapshots_ = GraphSnapshotManager::Get(viewer_node_->parent());
 
     // Copy invalidated ranges - used to determine which frames need hashing
     invalidated_video_ = viewer_node_->video_frame_cache()->GetInvalidatedRanges();
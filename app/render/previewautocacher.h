@@ -9,6 +9,7 @@
 #include "node/node.h"
 #include "node/output/viewer/viewer.h"
 #include "node/project/project.h"
+#include "render/graphsnapshot.h"
 #include "threading/threadticketwatcher.h"
 
 namespace olive {
@@ -26,7 +27,7 @@ public:
 
   virtual ~PreviewAutoCacher() override;
 
-  RenderTicketPtr GetSingleFrame(const rational& t, bool prioritize);
+  RenderTicketPtr GetSingleFrame(const rational& t, RenderTicket::Priority priority);
 
   /**
    * @brief Set the viewer node to auto-cache
@@ -80,31 +81,11 @@ public:
   void ClearVideoDownloadQueue(bool wait = false);
 
 private:
-  static void GenerateHashes(ViewerOutput *viewer, FrameHashCache *cache, const QVector<rational>& times, qint64 job_time);
+  static void GenerateHashes(GraphSnapshotPtr snapshot, ViewerOutput *viewer, FrameHashCache *cache, const QVector<rational>& times, qint64 job_time);
 
   void TryRender();
 
-  RenderTicketWatcher *RenderFrame(const QByteArray& hash, const rational &time, bool prioritize);
-
-  /**
-   * @brief Process all changes to internal NodeGraph copy
-   *
-   * PreviewAutoCacher staggers updates to its internal NodeGraph copy, only applying them when the
-   * RenderManager is not reading from it. This function is called when such an opportunity arises.
-   */
-  void ProcessUpdateQueue();
-
-  bool HasActiveJobs() const;
-
-  void AddNode(Node* node);
-  void RemoveNode(Node* node);
-  void AddEdge(const NodeOutput& output, const NodeInput& input);
-  void RemoveEdge(const NodeOutput& output, const NodeInput& input);
-  void CopyValue(const NodeInput& input);
-
-  void InsertIntoCopyMap(Node* node, Node* copy);
-
-  void UpdateLastSyncedValue();
+  RenderTicketWatcher *RenderFrame(const QByteArray& hash, const rational &time, RenderTicket::Priority priority);
 
   void CancelQueuedSingleFrameRender();
 
@@ -115,31 +96,9 @@ private:
   void ClearQueueRemoveEventInternal(QMap<RenderTicketWatcher*, TimeRange>::iterator it);
   void ClearQueueRemoveEventInternal(QVector<RenderTicketWatcher*>::iterator it);
 
-  class QueuedJob {
-  public:
-    enum Type {
-      kNodeAdded,
-      kNodeRemoved,
-      kEdgeAdded,
-      kEdgeRemoved,
-      kValueChanged
-    };
-
-    Type type;
-    Node* node;
-    NodeInput input;
-    NodeOutput output;
-  };
-
   ViewerOutput* viewer_node_;
 
-  Project copied_project_;
-
-  QVector<QueuedJob> graph_update_queue_;
-  QHash<Node*, Node*> copy_map_;
-  ViewerOutput* copied_viewer_node_;
-  ColorManager* copied_color_manager_;
-  QVector<Node*> created_nodes_;
+  std::shared_ptr<GraphSnapshotManager> snapshots_;
 
   bool paused_;
 
@@ -161,8 +120,6 @@ private:
   QMap<RenderTicketWatcher*, QByteArray> video_download_tasks_;
   QMap<RenderTicketWatcher*, QVector<RenderTicketPtr> > video_immediate_passthroughs_;
 
-  qint64 last_update_time_;
-
   bool ignore_next_mouse_button_;
 
   QTimer delayed_requeue_timer_;
@@ -198,16 +155,6 @@ private slots:
    */
   void VideoDownloaded();
 
-  void NodeAdded(Node* node);
-
-  void NodeRemoved(Node* node);
-
-  void EdgeAdded(const NodeOutput& output, const NodeInput& input);
-
-  void EdgeRemoved(const NodeOutput& output, const NodeInput& input);
-
-  void ValueChanged(const NodeInput& input);
-
   /**
    * @brief Generic function called whenever the frames to render need to be (re)queued
    */
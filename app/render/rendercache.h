@@ -22,6 +22,7 @@
 #define RENDERCACHE_H
 
 #include "codec/decoder.h"
+#include "codec/imagesequencereader.h"
 
 namespace olive {
 
@@ -40,7 +41,8 @@ private:
 };
 
 using DecoderCache = RenderCache<Decoder::CodecStream, DecoderPtr>;
-using ShaderCache = RenderCache<QString, QVariant>;
+
+using ImageSequenceCache = RenderCache<Decoder::CodecStream, ImageSequenceReaderPtr>;
 
 }
 
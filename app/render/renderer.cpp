@@ -24,8 +24,14 @@
 
 namespace olive {
 
+const qint64 Renderer::kDefaultTexturePoolBudget = 256LL * 1024 * 1024;
+
 Renderer::Renderer(QObject *parent) :
-  QObject(parent)
+  QObject(parent),
+  texture_pool_budget_(kDefaultTexturePoolBudget),
+  texture_pool_size_(0),
+  texture_allocation_count_(0),
+  texture_reuse_count_(0)
 {
 
 }
@@ -34,6 +40,30 @@ TexturePtr Renderer::CreateTexture(const VideoParams &params, Texture::Type type
 {
   QVariant v;
 
+  if (type == Texture::k2D) {
+    QMutexLocker locker(&texture_pool_mutex_);
+
+    auto it = texture_pool_.find(GetTexturePoolKey(params));
+
+    if (it != texture_pool_.end() && !it->isEmpty()) {
+      v = it->takeLast();
+      texture_pool_size_ -= GetTextureSize(params);
+      texture_reuse_count_++;
+    } else {
+      texture_allocation_count_++;
+    }
+  }
+
+  if (!v.isNull()) {
+    TexturePtr t = std::make_shared<Texture>(this, v, params, type);
+
+    if (data) {
+      UploadToTexture(t.get(), data, linesize);
+    }
+
+    return t;
+  }
+
   if (type == Texture::k3D) {
     v = CreateNativeTexture3D(params.effective_width(), params.effective_height(),
                               params.effective_depth(), params.format(), params.channel_count(), data, linesize);
@@ -54,6 +84,74 @@ TexturePtr Renderer::CreateTexture(const VideoParams &params, const void *data,
   return CreateTexture(params, Texture::k2D, data, linesize);
 }
 
+void Renderer::ReleaseTexture(Texture *texture)
+{
+  // Recycling a shared texture could overwrite it while another context is still reading it
+  if (texture->type() == Texture::k2D && !texture->IsShared()) {
+    QMutexLocker locker(&texture_pool_mutex_);
+
+    qint64 size = GetTextureSize(texture->params());
+
+    if (texture_pool_size_ + size <= texture_pool_budget_) {
+      texture_pool_[GetTexturePoolKey(texture->params())].append(texture->id());
+      texture_pool_size_ += size;
+      return;
+    }
+  }
+
+  DestroyNativeTexture(texture->id());
+}
+
+void Renderer::SetTexturePoolBudget(qint64 budget)
+{
+  texture_pool_mutex_.lock();
+  texture_pool_budget_ = budget;
+  bool over_budget = (texture_pool_size_ > texture_pool_budget_);
+  texture_pool_mutex_.unlock();
+
+  if (over_budget) {
+    ClearTexturePool();
+  }
+}
+
+void Renderer::ClearTexturePool()
+{
+  QHash<TexturePoolKey, QVector<QVariant> > pool;
+
+  texture_pool_mutex_.lock();
+  pool.swap(texture_pool_);
+  texture_pool_size_ = 0;
+  texture_pool_mutex_.unlock();
+
+  // Destroy outside the lock since this may block on the render thread
+  foreach (const QVector<QVariant>& textures, pool) {
+    foreach (const QVariant& t, textures) {
+      DestroyNativeTexture(t);
+    }
+  }
+}
+
+qint64 Renderer::GetTextureAllocationCount()
+{
+  QMutexLocker locker(&texture_pool_mutex_);
+
+  return texture_allocation_count_;
+}
+
+qint64 Renderer::GetTextureReuseCount()
+{
+  QMutexLocker locker(&texture_pool_mutex_);
+
+  return texture_reuse_count_;
+}
+
+qint64 Renderer::GetTexturePoolSize()
+{
+  QMutexLocker locker(&texture_pool_mutex_);
+
+  return texture_pool_size_;
+}
+
 void Renderer::BlitColorManaged(ColorProcessorPtr color_processor, TexturePtr source, bool source_is_premultiplied, Texture *destination, bool clear_destination, const QMatrix4x4 &matrix, const QMatrix4x4 &crop_matrix)
 {
   BlitColorManagedInternal(color_processor, source, source_is_premultiplied, destination, destination->params(), clear_destination, matrix, crop_matrix);
@@ -68,9 +166,21 @@ void Renderer::Destroy()
 {
   color_cache_.clear();
 
+  ClearTexturePool();
+
   DestroyInternal();
 }
 
+qint64 Renderer::GetTextureSize(const VideoParams &params)
+{
+  return static_cast<qint64>(params.effective_width()) * params.effective_height() * params.GetBytesPerPixel();
+}
+
+Renderer::TexturePoolKey Renderer::GetTexturePoolKey(const VideoParams &params)
+{
+  return {params.effective_width(), params.effective_height(), params.format(), params.channel_count()};
+}
+
 bool Renderer::GetColorContext(ColorProcessorPtr color_processor, Renderer::ColorContext *ctx)
 {
   QMutexLocker locker(&color_cache_mutex_);
@@ -44,9 +44,53 @@ public:
 
   virtual bool Init() = 0;
 
+  /**
+   * @brief Create a texture, recycling a pooled one with the same dimensions and format if possible
+   *
+   * 2D textures destroyed by their owner are returned to a pool rather than freed so that render
+   * targets can be reused across nodes and frames without a round trip to the graphics backend.
+   * Pooled textures have undefined contents, so callers that don't provide `data` must clear or
+   * overwrite the texture (as Blit does by default).
+   *
+   * Textures marked with Texture::SetShared() are never pooled.
+   */
   TexturePtr CreateTexture(const VideoParams& params, Texture::Type type, const void* data = nullptr, int linesize = 0);
   TexturePtr CreateTexture(const VideoParams& params, const void *data = nullptr, int linesize = 0);
 
+  /**
+   * @brief Called by Texture when it's destroyed to return its native texture to the pool
+   */
+  void ReleaseTexture(Texture* texture);
+
+  /**
+   * @brief Set the maximum total size in bytes of unused textures kept for reuse
+   *
+   * Textures released while the pool is full are freed immediately. A budget of 0 disables pooling.
+   */
+  void SetTexturePoolBudget(qint64 budget);
+
+  /**
+   * @brief Free all pooled textures
+   */
+  void ClearTexturePool();
+
+  /**
+   * @brief Number of textures that had to be created by the backend
+   */
+  qint64 GetTextureAllocationCount();
+
+  /**
+   * @brief Number of textures that were taken from the pool instead of being created
+   */
+  qint64 GetTextureReuseCount();
+
+  /**
+   * @brief Current total size in bytes of the textures sitting in the pool
+   */
+  qint64 GetTexturePoolSize();
+
+  static const qint64 kDefaultTexturePoolBudget;
+
   void BlitToTexture(QVariant shader,
                      olive::ShaderJob job,
                      olive::Texture* destination,
@@ -90,6 +134,38 @@ public slots:
 
   virtual void DownloadFromTexture(olive::Texture* texture, void* data, int linesize) = 0;
 
+  /**
+   * @brief Wait until every command issued so far has been executed
+   *
+   * Call before handing a texture produced by this renderer to another renderer sharing its
+   * objects. Renderers that don't share anything may do nothing.
+   */
+  virtual void FinishPendingCommands() = 0;
+
+  /**
+   * @brief Start copying a texture back to system memory without waiting for the transfer
+   *
+   * `linesize` is the linesize in pixels of the buffer the data will eventually be copied into.
+   * Returns a handle to wait on with WaitForDownload(). FinishDownload() must always be called on
+   * it eventually, even if the data is no longer wanted, to free it.
+   */
+  virtual QVariant StartDownloadFromTexture(olive::Texture* texture, int linesize) = 0;
+
+  /**
+   * @brief Wait up to `timeout` nanoseconds for a download's transfer to finish
+   *
+   * Returns true if FinishDownload() can now be called without waiting. The wait happens on the
+   * render thread, so keep `timeout` short enough not to hold up other processors sharing it.
+   */
+  virtual bool WaitForDownload(QVariant download, qint64 timeout) = 0;
+
+  /**
+   * @brief Copy a download started with StartDownloadFromTexture() into `data` and free it
+   *
+   * Waits for the transfer if it's still in progress. `data` may be nullptr to discard it.
+   */
+  virtual void FinishDownload(QVariant download, void* data) = 0;
+
 protected slots:
   virtual void Blit(QVariant shader,
                     olive::ShaderJob job,
@@ -117,6 +193,33 @@ private:
     kAlphaAssociated
   };
 
+  struct TexturePoolKey {
+    int width;
+    int height;
+    VideoParams::Format format;
+    int channel_count;
+
+    bool operator==(const TexturePoolKey& rhs) const
+    {
+      return width == rhs.width
+          && height == rhs.height
+          && format == rhs.format
+          && channel_count == rhs.channel_count;
+    }
+
+    friend uint qHash(const TexturePoolKey& key, uint seed)
+    {
+      return ::qHash(key.width, seed)
+          ^ ::qHash(key.height << 8, seed)
+          ^ ::qHash(static_cast<int>(key.format) << 16, seed)
+          ^ ::qHash(key.channel_count << 24, seed);
+    }
+  };
+
+  static TexturePoolKey GetTexturePoolKey(const VideoParams& params);
+
+  static qint64 GetTextureSize(const VideoParams& params);
+
   bool GetColorContext(ColorProcessorPtr color_processor, ColorContext* ctx);
 
   void BlitColorManagedInternal(ColorProcessorPtr color_processor, TexturePtr source,
@@ -128,6 +231,18 @@ private:
 
   QMutex color_cache_mutex_;
 
+  QHash<TexturePoolKey, QVector<QVariant> > texture_pool_;
+
+  QMutex texture_pool_mutex_;
+
+  qint64 texture_pool_budget_;
+
+  qint64 texture_pool_size_;
+
+  qint64 texture_allocation_count_;
+
+  qint64 texture_reuse_count_;
+
 };
 
 }
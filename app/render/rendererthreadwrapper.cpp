@@ -150,6 +150,42 @@ void RendererThreadWrapper::DownloadFromTexture(Texture *texture, void *data, in
                             Q_ARG(int, linesize));
 }
 
+void RendererThreadWrapper::FinishPendingCommands()
+{
+  QMetaObject::invokeMethod(inner_, "FinishPendingCommands", Qt::BlockingQueuedConnection);
+}
+
+QVariant RendererThreadWrapper::StartDownloadFromTexture(Texture *texture, int linesize)
+{
+  QVariant v;
+
+  QMetaObject::invokeMethod(inner_, "StartDownloadFromTexture", Qt::BlockingQueuedConnection,
+                            Q_RETURN_ARG(QVariant, v),
+                            OLIVE_NS_ARG(Texture*, texture),
+                            Q_ARG(int, linesize));
+
+  return v;
+}
+
+bool RendererThreadWrapper::WaitForDownload(QVariant download, qint64 timeout)
+{
+  bool finished;
+
+  QMetaObject::invokeMethod(inner_, "WaitForDownload", Qt::BlockingQueuedConnection,
+                            Q_RETURN_ARG(bool, finished),
+                            Q_ARG(QVariant, download),
+                            Q_ARG(qint64, timeout));
+
+  return finished;
+}
+
+void RendererThreadWrapper::FinishDownload(QVariant download, void *data)
+{
+  QMetaObject::invokeMethod(inner_, "FinishDownload", Qt::BlockingQueuedConnection,
+                            Q_ARG(QVariant, download),
+                            Q_ARG(void*, data));
+}
+
 void RendererThreadWrapper::Blit(QVariant shader, ShaderJob job, Texture *destination, VideoParams destination_params, bool clear_destination)
 {
   QMetaObject::invokeMethod(inner_, "Blit", Qt::BlockingQueuedConnection,
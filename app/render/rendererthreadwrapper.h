@@ -63,6 +63,14 @@ public slots:
 
   virtual void DownloadFromTexture(olive::Texture* texture, void* data, int linesize) override;
 
+  virtual void FinishPendingCommands() override;
+
+  virtual QVariant StartDownloadFromTexture(olive::Texture* texture, int linesize) override;
+
+  virtual bool WaitForDownload(QVariant download, qint64 timeout) override;
+
+  virtual void FinishDownload(QVariant download, void* data) override;
+
 protected slots:
   virtual void Blit(QVariant shader,
                     olive::ShaderJob job,
@@ -0,0 +1,236 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef RENDERJOB_H
+#define RENDERJOB_H
+
+#include <functional>
+#include <memory>
+#include <QMatrix4x4>
+#include <QSize>
+
+#include "audio/audioresampler.h"
+#include "codec/frame.h"
+#include "common/define.h"
+#include "common/timerange.h"
+#include "render/audioparams.h"
+#include "render/colorprocessor.h"
+#include "render/rendermodes.h"
+#include "render/videoparams.h"
+
+namespace olive {
+
+class ColorManager;
+class ViewerOutput;
+
+/**
+ * @brief Immutable description of the work a RenderTicket asks RenderProcessor to do
+ *
+ * Set once by RenderManager when the ticket is created and only read afterwards, so it can be
+ * shared between threads without locking. Use the derived class matching type().
+ */
+class RenderJob
+{
+public:
+  enum Type {
+    kTypeVideo,
+    kTypeAudio,
+    kTypeVideoDownload,
+    kTypeVideoBatch
+  };
+
+  RenderJob(Type type) :
+    type_(type)
+  {
+  }
+
+  virtual ~RenderJob(){}
+
+  DISABLE_COPY_MOVE(RenderJob)
+
+  Type type() const
+  {
+    return type_;
+  }
+
+  /**
+   * @brief Returns true if this job is a VideoRenderJob (or derivative) that renders frames
+   */
+  bool renders_video() const
+  {
+    return type_ == kTypeVideo || type_ == kTypeVideoBatch;
+  }
+
+private:
+  Type type_;
+
+};
+
+using RenderJobPtr = std::shared_ptr<const RenderJob>;
+
+class VideoRenderJob : public RenderJob
+{
+public:
+  VideoRenderJob(ViewerOutput* viewer, ColorManager* color_manager, const rational& time,
+                 RenderMode::Mode mode, const VideoParams& video_params, const AudioParams& audio_params,
+                 const QSize& force_size, const QMatrix4x4& force_matrix,
+                 VideoParams::Format force_format, ColorProcessorPtr force_color_output,
+                 const QString& cache) :
+    VideoRenderJob(kTypeVideo, viewer, color_manager, time, mode, video_params, audio_params,
+                   force_size, force_matrix, force_format, force_color_output, cache)
+  {
+  }
+
+  ViewerOutput* viewer() const { return viewer_; }
+  ColorManager* color_manager() const { return color_manager_; }
+  const rational& time() const { return time_; }
+  RenderMode::Mode mode() const { return mode_; }
+  const VideoParams& video_params() const { return video_params_; }
+  const AudioParams& audio_params() const { return audio_params_; }
+  const QSize& force_size() const { return force_size_; }
+  const QMatrix4x4& force_matrix() const { return force_matrix_; }
+  VideoParams::Format force_format() const { return force_format_; }
+  ColorProcessorPtr force_color_output() const { return force_color_output_; }
+  const QString& cache() const { return cache_; }
+
+protected:
+  VideoRenderJob(Type type, ViewerOutput* viewer, ColorManager* color_manager, const rational& time,
+                 RenderMode::Mode mode, const VideoParams& video_params, const AudioParams& audio_params,
+                 const QSize& force_size, const QMatrix4x4& force_matrix,
+                 VideoParams::Format force_format, ColorProcessorPtr force_color_output,
+                 const QString& cache) :
+    RenderJob(type),
+    viewer_(viewer),
+    color_manager_(color_manager),
+    time_(time),
+    mode_(mode),
+    video_params_(video_params),
+    audio_params_(audio_params),
+    force_size_(force_size),
+    force_matrix_(force_matrix),
+    force_format_(force_format),
+    force_color_output_(force_color_output),
+    cache_(cache)
+  {
+  }
+
+private:
+  ViewerOutput* viewer_;
+  ColorManager* color_manager_;
+  rational time_;
+  RenderMode::Mode mode_;
+  VideoParams video_params_;
+  AudioParams audio_params_;
+  QSize force_size_;
+  QMatrix4x4 force_matrix_;
+  VideoParams::Format force_format_;
+  ColorProcessorPtr force_color_output_;
+  QString cache_;
+
+};
+
+/**
+ * @brief Renders a run of frames sharing the same parameters in a single RenderProcessor
+ *
+ * Each frame is handed to the callback on the render thread as soon as it's ready, `index` being
+ * its position in times(). Returning false from the callback stops the batch early. The ticket
+ * finishes with the number of frames that were delivered.
+ */
+class VideoBatchRenderJob : public VideoRenderJob
+{
+public:
+  using FrameCallback = std::function<bool(int index, FramePtr frame)>;
+
+  VideoBatchRenderJob(ViewerOutput* viewer, ColorManager* color_manager, const QVector<rational>& times,
+                      RenderMode::Mode mode, const VideoParams& video_params, const AudioParams& audio_params,
+                      const QSize& force_size, const QMatrix4x4& force_matrix,
+                      VideoParams::Format force_format, ColorProcessorPtr force_color_output,
+                      const QString& cache, const FrameCallback& callback) :
+    VideoRenderJob(kTypeVideoBatch, viewer, color_manager, times.isEmpty() ? rational() : times.first(),
+                   mode, video_params, audio_params, force_size, force_matrix, force_format,
+                   force_color_output, cache),
+    times_(times),
+    callback_(callback)
+  {
+  }
+
+  const QVector<rational>& times() const { return times_; }
+  const FrameCallback& callback() const { return callback_; }
+
+private:
+  QVector<rational> times_;
+  FrameCallback callback_;
+
+};
+
+class AudioRenderJob : public RenderJob
+{
+public:
+  AudioRenderJob(ViewerOutput* viewer, const TimeRange& range, const AudioParams& audio_params,
+                 bool generate_waveforms, AudioResampler::Quality resample_quality) :
+    RenderJob(kTypeAudio),
+    viewer_(viewer),
+    range_(range),
+    audio_params_(audio_params),
+    generate_waveforms_(generate_waveforms),
+    resample_quality_(resample_quality)
+  {
+  }
+
+  ViewerOutput* viewer() const { return viewer_; }
+  const TimeRange& range() const { return range_; }
+  const AudioParams& audio_params() const { return audio_params_; }
+  bool generate_waveforms() const { return generate_waveforms_; }
+  AudioResampler::Quality resample_quality() const { return resample_quality_; }
+
+private:
+  ViewerOutput* viewer_;
+  TimeRange range_;
+  AudioParams audio_params_;
+  bool generate_waveforms_;
+  AudioResampler::Quality resample_quality_;
+
+};
+
+class DownloadRenderJob : public RenderJob
+{
+public:
+  DownloadRenderJob(const QString& cache, FramePtr frame, const QByteArray& hash) :
+    RenderJob(kTypeVideoDownload),
+    cache_(cache),
+    frame_(frame),
+    hash_(hash)
+  {
+  }
+
+  const QString& cache() const { return cache_; }
+  FramePtr frame() const { return frame_; }
+  const QByteArray& hash() const { return hash_; }
+
+private:
+  QString cache_;
+  FramePtr frame_;
+  QByteArray hash_;
+
+};
+
+}
+
+#endif // RENDERJOB_H
@@ -23,6 +23,7 @@
 #include <QApplication>
 #include <QMatrix4x4>
 #include <QThread>
+#include <QtConcurrent/QtConcurrent>
 
 #include "config/config.h"
 #include "core.h"
@@ -37,50 +38,89 @@ namespace olive {
 
 RenderManager* RenderManager::instance_ = nullptr;
 const int RenderManager::kDecoderMaximumInactivity = 10000;
+const int RenderManager::kMaximumRendererCount = 16;
+const qint64 RenderManager::kGPUMemoryBudget = 1024LL * 1024 * 1024;
 
 RenderManager::RenderManager(QObject *parent) :
   ThreadPool(QThread::IdlePriority, 0, parent),
+  share_context_(nullptr),
   backend_(kOpenGL)
 {
-  Renderer* graphics_renderer = nullptr;
+  int renderer_count = qBound(1, Config::Current()[QStringLiteral("RendererCount")].toInt(), kMaximumRendererCount);
 
   if (backend_ == kOpenGL) {
-    graphics_renderer = new OpenGLRenderer();
+    if (renderer_count > 1) {
+      // Renderers share textures and shaders through a context that's never made current itself
+      share_context_ = new QOpenGLContext(this);
+
+      if (!share_context_->create()) {
+        qWarning() << "Failed to create shared OpenGL context, falling back to a single renderer";
+        delete share_context_;
+        share_context_ = nullptr;
+        renderer_count = 1;
+      }
+    }
+
+    for (int i=0; i<renderer_count; i++) {
+      OpenGLRenderer* graphics_renderer = new OpenGLRenderer();
+      graphics_renderer->SetShareContext(share_context_);
+
+      Renderer* ctx = new RendererThreadWrapper(graphics_renderer, this);
+      ctx->Init();
+      ctx->PostInit();
+
+      contexts_.append(ctx);
+    }
   }
 
-  if (graphics_renderer) {
-    context_ = new RendererThreadWrapper(graphics_renderer, this);
-    context_->Init();
-    context_->PostInit();
+  if (!contexts_.isEmpty()) {
+    context_load_.fill(0, contexts_.size());
+
+    // The caches and texture pools all hold GPU memory, so they split one budget, with the pools'
+    // share divided between renderers so adding renderers doesn't raise the total
+    qint64 cache_budget = kGPUMemoryBudget * 3 / 8;
+    qint64 pool_budget = (kGPUMemoryBudget - 2 * cache_budget) / contexts_.size();
+
+    foreach (Renderer* ctx, contexts_) {
+      ctx->SetTexturePoolBudget(pool_budget);
+    }
 
-    still_cache_ = new StillImageCache();
+    still_cache_ = new StillImageCache(cache_budget);
+    texture_cache_ = new TextureCache(cache_budget);
     decoder_cache_ = new DecoderCache();
-    shader_cache_ = new ShaderCache();
-    default_shader_ = context_->CreateNativeShader(ShaderCode(QString(), QString()));
+    sequence_cache_ = new ImageSequenceCache();
+    shader_cache_ = new ShaderCache(contexts_.first());
+    default_shader_ = contexts_.first()->CreateNativeShader(ShaderCode(QString(), QString()));
 
     decoder_clear_timer_.setInterval(kDecoderMaximumInactivity);
     connect(&decoder_clear_timer_, &QTimer::timeout, this, &RenderManager::ClearOldDecoders);
     decoder_clear_timer_.start();
   } else {
     qCritical() << "Tried to initialize unknown graphics backend";
-    context_ = nullptr;
     still_cache_ = nullptr;
+    texture_cache_ = nullptr;
     decoder_cache_ = nullptr;
+    sequence_cache_ = nullptr;
+    shader_cache_ = nullptr;
   }
 }
 
 RenderManager::~RenderManager()
 {
-  if (context_) {
-    context_->DestroyNativeShader(default_shader_);
+  if (!contexts_.isEmpty()) {
+    contexts_.first()->DestroyNativeShader(default_shader_);
 
     delete shader_cache_;
+    delete sequence_cache_;
     delete decoder_cache_;
+    delete texture_cache_;
     delete still_cache_;
 
-    context_->Destroy();
-    context_->PostDestroy();
-    delete context_;
+    foreach (Renderer* ctx, contexts_) {
+      ctx->Destroy();
+      ctx->PostDestroy();
+      delete ctx;
+    }
   }
 }
 
@@ -100,6 +140,34 @@ void RenderManager::ClearOldDecoders()
       it++;
     }
   }
+
+  locker.unlock();
+
+  // Image sequence readers hold a buffer of frames and a thread pool, so they're cleared the same
+  // way. Their destructor waits for in-flight reads though, so the list of expired readers is
+  // handed to a worker and only the worker holds the last reference.
+  QVector<ImageSequenceReaderPtr>* expired = new QVector<ImageSequenceReaderPtr>();
+
+  QMutexLocker sequence_locker(sequence_cache_->mutex());
+
+  for (auto it=sequence_cache_->begin(); it!=sequence_cache_->end(); ) {
+    if (it.value()->GetLastAccessedTime() < min_age) {
+      expired->append(it.value());
+      it = sequence_cache_->erase(it);
+    } else {
+      it++;
+    }
+  }
+
+  sequence_locker.unlock();
+
+  if (expired->isEmpty()) {
+    delete expired;
+  } else {
+    QtConcurrent::run([expired]{
+      delete expired;
+    });
+  }
 }
 
 QByteArray RenderManager::Hash(const Node *n, const QString& output, const VideoParams &params, const rational &time)
@@ -126,7 +194,8 @@ QByteArray RenderManager::Hash(const Node *n, const QString& output, const Video
 
 RenderTicketPtr RenderManager::RenderFrame(ViewerOutput *viewer, ColorManager* color_manager,
                                            const rational& time, RenderMode::Mode mode,
-                                           FrameHashCache* cache, bool prioritize)
+                                           FrameHashCache* cache, RenderTicket::Priority priority,
+                                           const std::shared_ptr<void>& pinned_data)
 {
   return RenderFrame(viewer,
                      color_manager,
@@ -139,7 +208,8 @@ RenderTicketPtr RenderManager::RenderFrame(ViewerOutput *viewer, ColorManager* c
                      VideoParams::kFormatInvalid,
                      nullptr,
                      cache,
-                     prioritize);
+                     priority,
+                     pinned_data);
 }
 
 RenderTicketPtr RenderManager::RenderFrame(ViewerOutput *viewer, ColorManager* color_manager,
@@ -148,92 +218,143 @@ RenderTicketPtr RenderManager::RenderFrame(ViewerOutput *viewer, ColorManager* c
                                            const QSize& force_size,
                                            const QMatrix4x4& force_matrix, VideoParams::Format force_format,
                                            ColorProcessorPtr force_color_output,
-                                           FrameHashCache* cache, bool prioritize)
+                                           FrameHashCache* cache, RenderTicket::Priority priority,
+                                           const std::shared_ptr<void>& pinned_data)
 {
   // Create ticket
   RenderTicketPtr ticket = std::make_shared<RenderTicket>();
 
-  ticket->setProperty("viewer", Node::PtrToValue(viewer));
-  ticket->setProperty("time", QVariant::fromValue(time));
-  ticket->setProperty("size", force_size);
-  ticket->setProperty("matrix", force_matrix);
-  ticket->setProperty("format", force_format);
-  ticket->setProperty("mode", mode);
-  ticket->setProperty("type", kTypeVideo);
-  ticket->setProperty("colormanager", Node::PtrToValue(color_manager));
-  ticket->setProperty("coloroutput", QVariant::fromValue(force_color_output));
-  ticket->setProperty("vparam", QVariant::fromValue(video_params));
-  ticket->setProperty("aparam", QVariant::fromValue(audio_params));
-
-  if (cache) {
-    ticket->setProperty("cache", cache->GetCacheDirectory());
+  ticket->SetJob(std::make_shared<VideoRenderJob>(viewer, color_manager, time, mode,
+                                                  video_params, audio_params,
+                                                  force_size, force_matrix, force_format,
+                                                  force_color_output,
+                                                  cache ? cache->GetCacheDirectory() : QString()));
+  ticket->SetPinnedData(pinned_data);
+
+  if (ticket->thread() != this->thread()) {
+    ticket->moveToThread(this->thread());
   }
 
+  AddTicket(ticket, priority);
+
+  return ticket;
+}
+
+RenderTicketPtr RenderManager::RenderFrameBatch(ViewerOutput *viewer, ColorManager *color_manager,
+                                                const QVector<rational> &times, RenderMode::Mode mode,
+                                                const VideoParams &video_params, const AudioParams &audio_params,
+                                                const QSize &force_size,
+                                                const QMatrix4x4 &force_matrix, VideoParams::Format force_format,
+                                                ColorProcessorPtr force_color_output,
+                                                const VideoBatchRenderJob::FrameCallback &callback,
+                                                FrameHashCache *cache, RenderTicket::Priority priority)
+{
+  // Create ticket
+  RenderTicketPtr ticket = std::make_shared<RenderTicket>();
+
+  ticket->SetJob(std::make_shared<VideoBatchRenderJob>(viewer, color_manager, times, mode,
+                                                       video_params, audio_params,
+                                                       force_size, force_matrix, force_format,
+                                                       force_color_output,
+                                                       cache ? cache->GetCacheDirectory() : QString(),
+                                                       callback));
+
   if (ticket->thread() != this->thread()) {
     ticket->moveToThread(this->thread());
   }
 
-  // Queue appending the ticket and running the next job on our thread to make this function thread-safe
-  QMetaObject::invokeMethod(this, "AddTicket", Qt::AutoConnection,
-                            OLIVE_NS_ARG(RenderTicketPtr, ticket),
-                            Q_ARG(bool, prioritize));
+  AddTicket(ticket, priority);
 
   return ticket;
 }
 
-RenderTicketPtr RenderManager::RenderAudio(ViewerOutput* viewer, const TimeRange& r, bool generate_waveforms, bool prioritize)
+RenderTicketPtr RenderManager::RenderAudio(ViewerOutput* viewer, const TimeRange& r, bool generate_waveforms, RenderTicket::Priority priority,
+                                           const std::shared_ptr<void>& pinned_data)
 {
-  return RenderAudio(viewer, r, viewer->GetAudioParams(), generate_waveforms, prioritize);
+  return RenderAudio(viewer, r, viewer->GetAudioParams(), generate_waveforms, priority, pinned_data);
 }
 
-RenderTicketPtr RenderManager::RenderAudio(ViewerOutput* viewer, const TimeRange &r, const AudioParams &params, bool generate_waveforms, bool prioritize)
+RenderTicketPtr RenderManager::RenderAudio(ViewerOutput* viewer, const TimeRange &r, const AudioParams &params, bool generate_waveforms, RenderTicket::Priority priority,
+                                           const std::shared_ptr<void>& pinned_data)
 {
   // Create ticket
   RenderTicketPtr ticket = std::make_shared<RenderTicket>();
 
-  ticket->setProperty("viewer", Node::PtrToValue(viewer));
-  ticket->setProperty("time", QVariant::fromValue(r));
-  ticket->setProperty("type", kTypeAudio);
-  ticket->setProperty("enablewaveforms", generate_waveforms);
-  ticket->setProperty("aparam", QVariant::fromValue(params));
+  AudioResampler::Quality resample_quality = static_cast<AudioResampler::Quality>(Config::Current()[QStringLiteral("AudioResampleQuality")].toInt());
+
+  ticket->SetJob(std::make_shared<AudioRenderJob>(viewer, r, params, generate_waveforms, resample_quality));
+  ticket->SetPinnedData(pinned_data);
 
   if (ticket->thread() != this->thread()) {
     ticket->moveToThread(this->thread());
   }
 
-  // Queue appending the ticket and running the next job on our thread to make this function thread-safe
-  QMetaObject::invokeMethod(this, "AddTicket", Qt::AutoConnection,
-                            OLIVE_NS_ARG(RenderTicketPtr, ticket),
-                            Q_ARG(bool, prioritize));
+  AddTicket(ticket, priority);
 
   return ticket;
 }
 
-RenderTicketPtr RenderManager::SaveFrameToCache(FrameHashCache *cache, FramePtr frame, const QByteArray &hash, bool prioritize)
+RenderTicketPtr RenderManager::SaveFrameToCache(FrameHashCache *cache, FramePtr frame, const QByteArray &hash, RenderTicket::Priority priority)
 {
   // Create ticket
   RenderTicketPtr ticket = std::make_shared<RenderTicket>();
 
-  ticket->setProperty("cache", cache->GetCacheDirectory());
-  ticket->setProperty("frame", QVariant::fromValue(frame));
-  ticket->setProperty("hash", hash);
-  ticket->setProperty("type", kTypeVideoDownload);
+  ticket->SetJob(std::make_shared<DownloadRenderJob>(cache->GetCacheDirectory(), frame, hash));
 
   if (ticket->thread() != this->thread()) {
     ticket->moveToThread(this->thread());
   }
 
-  // Queue appending the ticket and running the next job on our thread to make this function thread-safe
-  QMetaObject::invokeMethod(this, "AddTicket", Qt::AutoConnection,
-                            OLIVE_NS_ARG(RenderTicketPtr, ticket),
-                            Q_ARG(bool, prioritize));
+  AddTicket(ticket, priority);
 
   return ticket;
 }
 
+void RenderManager::PrecompileShaders(const NodeGraph *graph)
+{
+  if (shader_cache_) {
+    shader_cache_->Precompile(graph->nodes());
+  }
+}
+
 void RenderManager::RunTicket(RenderTicketPtr ticket) const
 {
-  RenderProcessor::Process(ticket, context_, still_cache_, decoder_cache_, shader_cache_, default_shader_);
+  if (contexts_.isEmpty()) {
+    ticket->Finish();
+    return;
+  }
+
+  // The ticket keeps this renderer for its whole run so its textures never cross contexts
+  // mid-render. Only textures put in the shared caches do, and those are finished first.
+  int index = AcquireRenderer();
+
+  RenderProcessor::Process(ticket, contexts_.at(index), still_cache_, texture_cache_, decoder_cache_, sequence_cache_, shader_cache_, default_shader_);
+
+  ReleaseRenderer(index);
+}
+
+int RenderManager::AcquireRenderer() const
+{
+  QMutexLocker locker(&context_mutex_);
+
+  int index = 0;
+
+  for (int i=1; i<context_load_.size(); i++) {
+    if (context_load_.at(i) < context_load_.at(index)) {
+      index = i;
+    }
+  }
+
+  context_load_[index]++;
+
+  return index;
+}
+
+void RenderManager::ReleaseRenderer(int index) const
+{
+  QMutexLocker locker(&context_mutex_);
+
+  context_load_[index]--;
 }
 
 }
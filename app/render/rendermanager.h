@@ -21,6 +21,7 @@
 #ifndef RENDERBACKEND_H
 #define RENDERBACKEND_H
 
+#include <QOpenGLContext>
 #include <QtConcurrent/QtConcurrent>
 
 #include "config/config.h"
@@ -31,7 +32,10 @@
 #include "node/traverser.h"
 #include "render/renderer.h"
 #include "rendercache.h"
+#include "renderjob.h"
+#include "shadercache.h"
 #include "stillimagecache.h"
+#include "texturecache.h"
 #include "threading/threadpool.h"
 
 namespace olive {
@@ -79,44 +83,76 @@ public:
    * The ticket from this function will return a FramePtr - the rendered frame in reference color
    * space.
    *
-   * Setting `prioritize` to TRUE puts this ticket at the top of the queue. Leaving it as FALSE
-   * appends it to the bottom.
+   * `priority` determines which scheduling class this ticket is queued in. A queued ticket is
+   * never started while one of a higher class is waiting, but there is no ordering guarantee
+   * within a class since tickets are spread across workers and may be stolen (see ThreadPool).
+   *
+   * `pinned_data` is set with RenderTicket::SetPinnedData() before the ticket is queued, so a
+   * worker can never start it without it.
    *
    * This function is thread-safe.
    */
   RenderTicketPtr RenderFrame(ViewerOutput *viewer, ColorManager* color_manager,
                               const rational& time, RenderMode::Mode mode,
-                              FrameHashCache* cache = nullptr, bool prioritize = false);
+                              FrameHashCache* cache = nullptr, RenderTicket::Priority priority = RenderTicket::kPriorityBackground,
+                              const std::shared_ptr<void>& pinned_data = nullptr);
   RenderTicketPtr RenderFrame(ViewerOutput* viewer, ColorManager* color_manager,
                               const rational& time, RenderMode::Mode mode,
                               const VideoParams& video_params, const AudioParams& audio_params,
                               const QSize& force_size,
                               const QMatrix4x4& force_matrix, VideoParams::Format force_format,
                               ColorProcessorPtr force_color_output,
-                              FrameHashCache* cache = nullptr, bool prioritize = false);
+                              FrameHashCache* cache = nullptr, RenderTicket::Priority priority = RenderTicket::kPriorityBackground,
+                              const std::shared_ptr<void>& pinned_data = nullptr);
+
+  /**
+   * @brief Asynchronously generate several frames with one ticket
+   *
+   * All frames are rendered in order by the same RenderProcessor, saving the per-ticket setup
+   * cost when individual frames are cheap to render. Frames are passed to `callback` from the
+   * render thread (see VideoBatchRenderJob), and the ticket finishes with the number of frames
+   * delivered.
+   *
+   * This function is thread-safe.
+   */
+  RenderTicketPtr RenderFrameBatch(ViewerOutput* viewer, ColorManager* color_manager,
+                                   const QVector<rational>& times, RenderMode::Mode mode,
+                                   const VideoParams& video_params, const AudioParams& audio_params,
+                                   const QSize& force_size,
+                                   const QMatrix4x4& force_matrix, VideoParams::Format force_format,
+                                   ColorProcessorPtr force_color_output,
+                                   const VideoBatchRenderJob::FrameCallback& callback,
+                                   FrameHashCache* cache = nullptr, RenderTicket::Priority priority = RenderTicket::kPriorityBackground);
 
   /**
    * @brief Asynchronously generate a chunk of audio
    *
    * The ticket from this function will return a SampleBufferPtr - the rendered audio.
    *
-   * Setting `prioritize` to TRUE puts this ticket at the top of the queue. Leaving it as FALSE
-   * appends it to the bottom.
+   * `priority` determines which scheduling class this ticket is queued in. A queued ticket is
+   * never started while one of a higher class is waiting, but there is no ordering guarantee
+   * within a class since tickets are spread across workers and may be stolen (see ThreadPool).
+   *
+   * `pinned_data` is set with RenderTicket::SetPinnedData() before the ticket is queued.
    *
    * This function is thread-safe.
    */
-  RenderTicketPtr RenderAudio(ViewerOutput* viewer, const TimeRange& r, const AudioParams& params, bool generate_waveforms, bool prioritize = false);
-  RenderTicketPtr RenderAudio(ViewerOutput *viewer, const TimeRange& r, bool generate_waveforms, bool prioritize = false);
+  RenderTicketPtr RenderAudio(ViewerOutput* viewer, const TimeRange& r, const AudioParams& params, bool generate_waveforms, RenderTicket::Priority priority = RenderTicket::kPriorityAudio,
+                              const std::shared_ptr<void>& pinned_data = nullptr);
+  RenderTicketPtr RenderAudio(ViewerOutput *viewer, const TimeRange& r, bool generate_waveforms, RenderTicket::Priority priority = RenderTicket::kPriorityAudio,
+                              const std::shared_ptr<void>& pinned_data = nullptr);
 
-  RenderTicketPtr SaveFrameToCache(FrameHashCache* cache, FramePtr frame, const QByteArray& hash, bool prioritize = false);
+  RenderTicketPtr SaveFrameToCache(FrameHashCache* cache, FramePtr frame, const QByteArray& hash, RenderTicket::Priority priority = RenderTicket::kPriorityBackground);
 
-  virtual void RunTicket(RenderTicketPtr ticket) const override;
+  /**
+   * @brief Start compiling the shaders used by the nodes in this graph in the background
+   *
+   * Called when a project is loaded so that the first frames rendered don't have to wait for
+   * shader compilation.
+   */
+  void PrecompileShaders(const NodeGraph* graph);
 
-  enum TicketType {
-    kTypeVideo,
-    kTypeAudio,
-    kTypeVideoDownload
-  };
+  virtual void RunTicket(RenderTicketPtr ticket) const override;
 
   Backend backend() const
   {
@@ -132,14 +168,31 @@ private:
 
   static RenderManager* instance_;
 
-  Renderer* context_;
+  /**
+   * @brief Pick the renderer running the fewest tickets and count this ticket against it
+   */
+  int AcquireRenderer() const;
+
+  void ReleaseRenderer(int index) const;
+
+  QVector<Renderer*> contexts_;
+
+  mutable QVector<int> context_load_;
+
+  mutable QMutex context_mutex_;
+
+  QOpenGLContext* share_context_;
 
   Backend backend_;
 
   StillImageCache* still_cache_;
 
+  TextureCache* texture_cache_;
+
   DecoderCache* decoder_cache_;
 
+  ImageSequenceCache* sequence_cache_;
+
   ShaderCache* shader_cache_;
 
   QVariant default_shader_;
@@ -148,6 +201,13 @@ private:
 
   static const int kDecoderMaximumInactivity;
 
+  static const int kMaximumRendererCount;
+
+  /**
+   * @brief Total GPU memory in bytes the shared caches and all renderers' texture pools may hold
+   */
+  static const qint64 kGPUMemoryBudget;
+
 private slots:
   void ClearOldDecoders();
 
@@ -155,6 +215,4 @@ private slots:
 
 }
 
-Q_DECLARE_METATYPE(olive::RenderManager::TicketType)
-
 #endif // RENDERBACKEND_H
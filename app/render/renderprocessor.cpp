@@ -25,24 +25,53 @@
 #include <QVector3D>
 #include <QVector4D>
 
+#include "common/ticktime.h"
 #include "node/project/project.h"
 #include "rendermanager.h"
 
 namespace olive {
 
-RenderProcessor::RenderProcessor(RenderTicketPtr ticket, Renderer *render_ctx, StillImageCache* still_image_cache, DecoderCache* decoder_cache, ShaderCache *shader_cache, QVariant default_shader) :
+const qint64 RenderProcessor::kDownloadWaitSlice = 1000000;
+
+RenderProcessor::RenderProcessor(RenderTicketPtr ticket, Renderer *render_ctx, StillImageCache* still_image_cache, TextureCache* texture_cache, DecoderCache* decoder_cache, ImageSequenceCache *sequence_cache, ShaderCache *shader_cache, QVariant default_shader) :
   ticket_(ticket),
   render_ctx_(render_ctx),
   still_image_cache_(still_image_cache),
+  texture_cache_(texture_cache),
   decoder_cache_(decoder_cache),
+  sequence_cache_(sequence_cache),
   shader_cache_(shader_cache),
-  default_shader_(default_shader)
+  default_shader_(default_shader),
+  job_(ticket->GetJob().get()),
+  color_manager_(nullptr)
 {
+  // Resolve everything the traversal callbacks need up front so they don't have to inspect the
+  // job again for every node
+  switch (job_->type()) {
+  case RenderJob::kTypeVideo:
+  case RenderJob::kTypeVideoBatch:
+  {
+    const VideoRenderJob* video_job = static_cast<const VideoRenderJob*>(job_);
+    audio_params_ = video_job->audio_params();
+    color_manager_ = video_job->color_manager();
+    cache_dir_ = video_job->cache();
+    break;
+  }
+  case RenderJob::kTypeAudio:
+  {
+    const AudioRenderJob* audio_job = static_cast<const AudioRenderJob*>(job_);
+    audio_params_ = audio_job->audio_params();
+    resampler_.set_quality(audio_job->resample_quality());
+    break;
+  }
+  case RenderJob::kTypeVideoDownload:
+    break;
+  }
 }
 
-FramePtr RenderProcessor::GenerateFrame(const rational& time, const rational& frame_length)
+RenderProcessor::PendingFrame RenderProcessor::GenerateFrame(const VideoRenderJob *job, const rational& time, const rational& frame_length)
 {
-  ViewerOutput* viewer = Node::ValueToPtr<ViewerOutput>(ticket_->property("viewer"));
+  ViewerOutput* viewer = job->viewer();
 
   NodeValueTable table;
   NodeOutput texture_output = viewer->GetConnectedTextureOutput();
@@ -56,20 +85,23 @@ FramePtr RenderProcessor::GenerateFrame(const rational& time, const rational& fr
   // Set up output frame parameters
   VideoParams frame_params = GetCacheVideoParams();
 
-  QSize frame_size = ticket_->property("size").value<QSize>();
+  const QSize& frame_size = job->force_size();
   if (!frame_size.isNull()) {
     frame_params.set_width(frame_size.width());
     frame_params.set_height(frame_size.height());
   }
 
-  VideoParams::Format frame_format = static_cast<VideoParams::Format>(ticket_->property("format").toInt());
+  VideoParams::Format frame_format = job->force_format();
   if (frame_format != VideoParams::kFormatInvalid) {
     frame_params.set_format(frame_format);
   }
 
   frame_params.set_channel_count(texture ? texture->channel_count() : VideoParams::kRGBChannelCount);
 
-  FramePtr frame = Frame::Create();
+  PendingFrame pending;
+  FramePtr& frame = pending.frame;
+
+  frame = Frame::Create();
   frame->set_timestamp(time);
   frame->set_video_params(frame_params);
   frame->allocate();
@@ -79,7 +111,7 @@ FramePtr RenderProcessor::GenerateFrame(const rational& time, const rational& fr
     memset(frame->data(), 0, frame->allocated_size());
   } else {
     // Dump texture contents to frame
-    ColorProcessorPtr output_color_transform = ticket_->property("coloroutput").value<ColorProcessorPtr>();
+    ColorProcessorPtr output_color_transform = job->force_color_output();
     const VideoParams& tex_params = texture->params();
 
     if (tex_params.effective_width() != frame_params.effective_width()
@@ -88,88 +120,158 @@ FramePtr RenderProcessor::GenerateFrame(const rational& time, const rational& fr
         || output_color_transform) {
       TexturePtr blit_tex = render_ctx_->CreateTexture(frame_params);
 
-      QMatrix4x4 matrix = ticket_->property("matrix").value<QMatrix4x4>();
+      const QMatrix4x4& matrix = job->force_matrix();
 
       if (output_color_transform) {
         // Yes color transform, blit color managed
         render_ctx_->BlitColorManaged(output_color_transform, texture, true, blit_tex.get(), true, matrix);
       } else {
         // No color transform, just blit
-        ShaderJob job;
-        job.InsertValue(QStringLiteral("ove_maintex"), NodeValue(NodeValue::kTexture, QVariant::fromValue(texture)));
-        job.InsertValue(QStringLiteral("ove_mvpmat"), NodeValue(NodeValue::kMatrix, matrix));
+        ShaderJob blit_job;
+        blit_job.InsertValue(QStringLiteral("ove_maintex"), NodeValue(NodeValue::kTexture, QVariant::fromValue(texture)));
+        blit_job.InsertValue(QStringLiteral("ove_mvpmat"), NodeValue(NodeValue::kMatrix, matrix));
 
-        render_ctx_->BlitToTexture(default_shader_, job, blit_tex.get());
+        render_ctx_->BlitToTexture(default_shader_, blit_job, blit_tex.get());
       }
 
       // Replace texture that we're going to download in the next step
       texture = blit_tex;
     }
 
-    render_ctx_->DownloadFromTexture(texture.get(), frame->data(), frame->linesize_pixels());
+    // Queue the readback so the render thread is free for other work while the GPU copies it
+    pending.download = render_ctx_->StartDownloadFromTexture(texture.get(), frame->linesize_pixels());
+  }
+
+  return pending;
+}
+
+RenderProcessor::PendingFrame RenderProcessor::StartVideoFrame(const VideoRenderJob *job, const rational &time)
+{
+  rational frame_length = GetCacheVideoParams().frame_rate_as_time_base();
+  if (GetCacheVideoParams().interlacing() != VideoParams::kInterlaceNone) {
+    frame_length /= 2;
+  }
+
+  PendingFrame pending = GenerateFrame(job, time, frame_length);
+
+  if (GetCacheVideoParams().interlacing() != VideoParams::kInterlaceNone) {
+    // Get next between frame and interlace it
+    PendingFrame next = GenerateFrame(job, time + frame_length, frame_length);
+    FramePtr frame = WaitForFrame(pending);
+    FramePtr next_frame = WaitForFrame(next);
+
+    FramePtr top, bottom;
+    if (GetCacheVideoParams().interlacing() == VideoParams::kInterlacedTopFirst) {
+      top = frame;
+      bottom = next_frame;
+    } else {
+      top = next_frame;
+      bottom = frame;
+    }
+
+    pending.frame = Frame::Interlace(top, bottom);
+    pending.download.clear();
+  }
+
+  return pending;
+}
+
+FramePtr RenderProcessor::WaitForFrame(const PendingFrame &pending)
+{
+  if (!pending.download.isNull()) {
+    // Each wait returns as soon as the transfer is done, but is capped so other processors sharing
+    // the render thread get a turn in between rather than waiting for the whole transfer
+    bool finished = false;
+    while (!finished) {
+      finished = render_ctx_->WaitForDownload(pending.download, kDownloadWaitSlice);
+    }
+
+    render_ctx_->FinishDownload(pending.download, pending.frame->data());
   }
 
-  return frame;
+  return pending.frame;
+}
+
+void RenderProcessor::DiscardFrame(const PendingFrame &pending)
+{
+  if (!pending.download.isNull()) {
+    render_ctx_->FinishDownload(pending.download, nullptr);
+  }
 }
 
 void RenderProcessor::Run()
 {
   // Depending on the render ticket type, start a job
-  RenderManager::TicketType type = ticket_->property("type").value<RenderManager::TicketType>();
+  switch (job_->type()) {
+  case RenderJob::kTypeVideo:
+  {
+    const VideoRenderJob* job = static_cast<const VideoRenderJob*>(job_);
 
-  switch (type) {
-  case RenderManager::kTypeVideo:
+    SetCacheVideoParams(job->video_params());
+
+    ticket_->Finish(QVariant::fromValue(WaitForFrame(StartVideoFrame(job, job->time()))));
+    break;
+  }
+  case RenderJob::kTypeVideoBatch:
   {
-    SetCacheVideoParams(ticket_->property("vparam").value<VideoParams>());
-    rational time = ticket_->property("time").value<rational>();
+    const VideoBatchRenderJob* job = static_cast<const VideoBatchRenderJob*>(job_);
 
-    rational frame_length = GetCacheVideoParams().frame_rate_as_time_base();
-    if (GetCacheVideoParams().interlacing() != VideoParams::kInterlaceNone) {
-      frame_length /= 2;
-    }
+    SetCacheVideoParams(job->video_params());
 
-    FramePtr frame = GenerateFrame(time, frame_length);
+    // Decoders, shaders and the still image cache are all reused between frames in the batch, and
+    // each frame's readback overlaps rendering the next one
+    int delivered = 0;
+    PendingFrame pending;
+    bool has_pending = false;
 
-    if (GetCacheVideoParams().interlacing() != VideoParams::kInterlaceNone) {
-      // Get next between frame and interlace it
-      FramePtr next_frame = GenerateFrame(time + frame_length, frame_length);
+    foreach (const rational& time, job->times()) {
+      PendingFrame next = StartVideoFrame(job, time);
 
-      FramePtr top, bottom;
-      if (GetCacheVideoParams().interlacing() == VideoParams::kInterlacedTopFirst) {
-        top = frame;
-        bottom = next_frame;
-      } else {
-        top = next_frame;
-        bottom = frame;
+      if (has_pending) {
+        delivered++;
+
+        if (!job->callback()(delivered - 1, WaitForFrame(pending))) {
+          DiscardFrame(next);
+          has_pending = false;
+          break;
+        }
       }
 
-      frame = Frame::Interlace(top, bottom);
+      pending = next;
+      has_pending = true;
+    }
+
+    if (has_pending) {
+      delivered++;
+      job->callback()(delivered - 1, WaitForFrame(pending));
     }
 
-    ticket_->Finish(QVariant::fromValue(frame));
+    ticket_->Finish(delivered);
     break;
   }
-  case RenderManager::kTypeAudio:
+  case RenderJob::kTypeAudio:
   {
-    ViewerOutput* viewer = Node::ValueToPtr<ViewerOutput>(ticket_->property("viewer"));
-    TimeRange time = ticket_->property("time").value<TimeRange>();
+    const AudioRenderJob* job = static_cast<const AudioRenderJob*>(job_);
 
     NodeValueTable table;
-    NodeOutput texture_output = viewer->GetConnectedSampleOutput();
+    NodeOutput texture_output = job->viewer()->GetConnectedSampleOutput();
     if (texture_output.IsValid()) {
-      table = GenerateTable(texture_output.node(), texture_output.output(), time);
+      table = GenerateTable(texture_output.node(), texture_output.output(), job->range());
+    }
+
+    if (job->generate_waveforms()) {
+      // Hand waveforms back to the main thread in one go
+      ticket_->setProperty("waveforms", QVariant::fromValue(waveforms_));
     }
 
     ticket_->Finish(table.Get(NodeValue::kSamples));
     break;
   }
-  case RenderManager::kTypeVideoDownload:
+  case RenderJob::kTypeVideoDownload:
   {
-    QString cache = ticket_->property("cache").toString();
-    FramePtr frame = ticket_->property("frame").value<FramePtr>();
-    QByteArray hash = ticket_->property("hash").toByteArray();
+    const DownloadRenderJob* job = static_cast<const DownloadRenderJob*>(job_);
 
-    ticket_->Finish(FrameHashCache::SaveCacheFrame(cache, hash, frame));
+    ticket_->Finish(FrameHashCache::SaveCacheFrame(job->cache(), job->hash(), job->frame()));
     break;
   }
   default:
@@ -205,9 +307,23 @@ DecoderPtr RenderProcessor::ResolveDecoderFromInput(const QString& decoder_id, c
   return decoder;
 }
 
-void RenderProcessor::Process(RenderTicketPtr ticket, Renderer *render_ctx, StillImageCache *still_image_cache, DecoderCache *decoder_cache, ShaderCache *shader_cache, QVariant default_shader)
+ImageSequenceReaderPtr RenderProcessor::ResolveImageSequenceReader(const QString &decoder_id, const Decoder::CodecStream &stream, const VideoParams &params)
+{
+  QMutexLocker locker(sequence_cache_->mutex());
+
+  ImageSequenceReaderPtr reader = sequence_cache_->value(stream);
+
+  if (!reader) {
+    reader = std::make_shared<ImageSequenceReader>(decoder_id, stream, params.start_time(), params.duration());
+    sequence_cache_->insert(stream, reader);
+  }
+
+  return reader;
+}
+
+void RenderProcessor::Process(RenderTicketPtr ticket, Renderer *render_ctx, StillImageCache *still_image_cache, TextureCache *texture_cache, DecoderCache *decoder_cache, ImageSequenceCache *sequence_cache, ShaderCache *shader_cache, QVariant default_shader)
 {
-  RenderProcessor p(ticket, render_ctx, still_image_cache, decoder_cache, shader_cache, default_shader);
+  RenderProcessor p(ticket, render_ctx, still_image_cache, texture_cache, decoder_cache, sequence_cache, shader_cache, default_shader);
   p.Run();
 }
 
@@ -215,7 +331,7 @@ NodeValueTable RenderProcessor::GenerateBlockTable(const Track *track, const Tim
 {
   if (track->type() == Track::kAudio) {
 
-    const AudioParams& audio_params = ticket_->property("aparam").value<AudioParams>();
+    const AudioParams& audio_params = audio_params_;
 
     QVector<Block*> active_blocks = track->BlocksAtTimeRange(range);
 
@@ -234,8 +350,24 @@ NodeValueTable RenderProcessor::GenerateBlockTable(const Track *track, const Tim
       int destination_offset = audio_params.time_to_samples(range_for_block.in() - range.in());
       int max_dest_sz = audio_params.time_to_samples(range_for_block.length());
 
+      double speed_value = b->speed();
+      bool resample = !qIsNull(speed_value) && !qFuzzyCompare(speed_value, 1.0);
+
+      TimeRange block_range = Track::TransformRangeForBlock(b, range_for_block);
+      TimeRange padded_range = block_range;
+
+      if (resample) {
+        // The resampler needs some context either side of this range to produce the same samples
+        // at chunk boundaries as it would if the whole clip was rendered at once
+        int padding = qCeil(resampler_.GetFilterRadius(speed_value) / speed_value) + 1;
+        rational padding_time = audio_params.samples_to_time(padding);
+
+        padded_range = TimeRange(qMax(rational(0), block_range.in() - padding_time),
+                                 qMin(b->length(), block_range.out() + padding_time));
+      }
+
       // Destination buffer
-      NodeValueTable table = GenerateTable(b, Track::TransformRangeForBlock(b, range_for_block));
+      NodeValueTable table = GenerateTable(b, padded_range);
       SampleBufferPtr samples_from_this_block = table.Take(NodeValue::kSamples).value<SampleBufferPtr>();
 
       if (!samples_from_this_block) {
@@ -243,40 +375,56 @@ NodeValueTable RenderProcessor::GenerateBlockTable(const Track *track, const Tim
         continue;
       }
 
-      double speed_value = b->GetStandardValue(Block::kSpeedInput).toDouble();
-
       if (qIsNull(speed_value)) {
-        // Just silence, don't think there's any other practical application of 0 speed audio
-        samples_from_this_block->fill(0);
-      } else if (!qFuzzyCompare(speed_value, 1.0)) {
-        // Multiply time
-        samples_from_this_block->speed(speed_value);
-      }
-
-      if (b->GetStandardValue(Block::kReverseInput).toBool()) {
-        samples_from_this_block->reverse();
-      }
-
-      int copy_length = qMin(max_dest_sz, samples_from_this_block->sample_count());
-
-      // Copy samples into destination buffer
-      for (int i=0; i<samples_from_this_block->audio_params().channel_count(); i++) {
-        block_range_buffer->set(i, samples_from_this_block->data(i), destination_offset, copy_length);
+        // Just silence, don't think there's any other practical application of 0 speed audio.
+        // The destination buffer is already filled with silence so there's nothing to copy.
+      } else if (!resample) {
+        if (b->reverse()) {
+          samples_from_this_block->reverse();
+        }
+
+        int copy_length = qMin(max_dest_sz, samples_from_this_block->sample_count());
+
+        // Copy samples into destination buffer
+        for (int i=0; i<samples_from_this_block->audio_params().channel_count(); i++) {
+          block_range_buffer->set(i, samples_from_this_block->data(i), destination_offset, copy_length);
+        }
+      } else {
+        // Resample straight into the destination buffer. Output positions are derived from the
+        // absolute media time of each sample so that adjacent chunks line up exactly.
+        double sample_rate = audio_params.sample_rate();
+        double media_in = b->media_in().toDouble();
+        double block_length = b->length().toDouble();
+        double local_in = block_range.in().toDouble();
+
+        double media_start = local_in * speed_value + media_in;
+        double step = speed_value;
+        if (b->reverse()) {
+          media_start = block_length - media_start;
+          step = -step;
+        }
+
+        rational input_start = TimeRange(b->SequenceToMediaTime(padded_range.in()),
+                                         b->SequenceToMediaTime(padded_range.out())).in();
+        double start_position = media_start * sample_rate - audio_params.time_to_samples(input_start);
+
+        resampler_.Process(samples_from_this_block.get(), start_position, step,
+                           block_range_buffer.get(), destination_offset,
+                           qMin(max_dest_sz, block_range_buffer->sample_count() - destination_offset));
       }
 
       NodeValueTable::Merge({merged_table, table});
     }
 
-    if (ticket_->property("enablewaveforms").toBool()) {
+    if (job_->type() == RenderJob::kTypeAudio
+        && static_cast<const AudioRenderJob*>(job_)->generate_waveforms()) {
       // Generate a visual waveform and send it back to the main thread
       AudioVisualWaveform visual_waveform;
       visual_waveform.set_channel_count(audio_params.channel_count());
       visual_waveform.OverwriteSamples(block_range_buffer, audio_params.sample_rate());
 
       RenderedWaveform waveform_info = {track, visual_waveform, range};
-      QVector<RenderedWaveform> waveform_list = ticket_->property("waveforms").value< QVector<RenderedWaveform> >();
-      waveform_list.append(waveform_info);
-      ticket_->setProperty("waveforms", QVariant::fromValue(waveform_list));
+      waveforms_.append(waveform_info);
     }
 
     merged_table.Push(NodeValue::kSamples, QVariant::fromValue(block_range_buffer), track);
@@ -290,7 +438,7 @@ NodeValueTable RenderProcessor::GenerateBlockTable(const Track *track, const Tim
 
 QVariant RenderProcessor::ProcessVideoFootage(const FootageJob &stream, const rational &input_time)
 {
-  if (ticket_->property("type").value<RenderManager::TicketType>() != RenderManager::kTypeVideo) {
+  if (!job_->renders_video()) {
     // Video cannot contribute to audio, so we do nothing here
     return QVariant();
   }
@@ -303,7 +451,7 @@ QVariant RenderProcessor::ProcessVideoFootage(const FootageJob &stream, const ra
   const VideoParams& render_params = GetCacheVideoParams();
   VideoParams stream_data = stream.video_params();
 
-  ColorManager* color_manager = Node::ValueToPtr<ColorManager>(ticket_->property("colormanager"));
+  ColorManager* color_manager = color_manager_;
 
   // See if we can make this divider larger (i.e. if the fooage is smaller)
   int footage_divider = render_params.divider();
@@ -322,79 +470,51 @@ QVariant RenderProcessor::ProcessVideoFootage(const FootageJob &stream, const ra
 
   Decoder::CodecStream default_codec_stream(stream.filename(), stream_data.stream_index());
 
-  StillImageCache::EntryPtr want_entry = std::make_shared<StillImageCache::Entry>(
-        nullptr,
-        default_codec_stream,
-        ColorProcessor::GenerateID(color_manager, using_colorspace, color_manager->GetReferenceColorSpace()),
-        stream_data.premultiplied_alpha(),
-        footage_divider,
-        (stream_data.video_type() == VideoParams::kVideoTypeStill) ? 0 : input_time,
-        true);
-
-  bool found_existing = false;
-
-  still_image_cache_->mutex()->lock();
-
-  foreach (StillImageCache::EntryPtr e, still_image_cache_->entries()) {
-    if (StillImageCache::CompareEntryMetadata(want_entry, e)) {
-      // Found an exact match of the texture we want in the cache. See if it's working or if it's
-      // ready.
-      want_entry = e;
-      found_existing = true;
-
-      while (want_entry->working) {
-        still_image_cache_->wait_cond()->wait(still_image_cache_->mutex());
-      }
-
-      value = want_entry->texture;
-      break;
-    }
-  }
+  StillImageCache::Key cache_key = {
+    default_codec_stream,
+    ColorProcessor::GenerateID(color_manager, using_colorspace, color_manager->GetReferenceColorSpace()),
+    stream_data.premultiplied_alpha(),
+    footage_divider,
+    (stream_data.video_type() == VideoParams::kVideoTypeStill) ? 0 : input_time
+  };
 
-  if (value) {
-    // Found the texture, we can release the cache now
-    still_image_cache_->mutex()->unlock();
-  } else {
-    // Wasn't in still image cache, so we'll have to retrieve it from the decoder
-
-    // Let other processors know we're getting this texture (want_entry's `working` field is
-    // already set to true in the initializer above)
-    if (!found_existing) {
-      still_image_cache_->PushEntry(want_entry);
-    }
-
-    still_image_cache_->mutex()->unlock();
+  bool claimed;
+  value = still_image_cache_->Acquire(cache_key, &claimed);
 
+  if (claimed) {
+    // Wasn't in still image cache, so we'll have to retrieve it from the decoder. Other
+    // processors wanting this texture will wait until we call Finish().
     QString decoder_id = stream.decoder();
 
+    Decoder::RetrieveVideoParams p;
+    p.divider = footage_divider;
+    p.src_interlacing = stream_data.interlacing();
+    p.dst_interlacing = GetCacheVideoParams().interlacing();
+
     DecoderPtr decoder = nullptr;
+    ImageSequenceReaderPtr sequence = nullptr;
 
     if (stream_data.video_type() == VideoParams::kVideoTypeVideo) {
       decoder = ResolveDecoderFromInput(decoder_id, default_codec_stream);
+    } else if (stream_data.video_type() == VideoParams::kVideoTypeImageSequence) {
+      // Image sequences involve multiple files, so rather than the decoder cache they go through a
+      // reader that opens the upcoming files ahead of time
+      sequence = ResolveImageSequenceReader(decoder_id, default_codec_stream, stream_data);
     } else {
-      // Since image sequences involve multiple files, we don't engage the decoder cache
       decoder = Decoder::CreateFromID(decoder_id);
 
-      QString frame_filename;
-
-      if (stream_data.video_type() == VideoParams::kVideoTypeImageSequence) {
-        int64_t frame_number = stream_data.get_time_in_timebase_units(input_time);
-        frame_filename = Decoder::TransformImageSequenceFileName(stream.filename(), frame_number);
-      } else {
-        frame_filename = stream.filename();
-      }
-
       // Decoder will close automatically since it's a stream_ptr
-      decoder->Open(Decoder::CodecStream(frame_filename, stream_data.stream_index()));
+      decoder->Open(default_codec_stream);
     }
 
-    if (decoder) {
-      Decoder::RetrieveVideoParams p;
-      p.divider = footage_divider;
-      p.src_interlacing = stream_data.interlacing();
-      p.dst_interlacing = GetCacheVideoParams().interlacing();
+    if (decoder || sequence) {
+      FramePtr frame;
 
-      FramePtr frame = decoder->RetrieveVideo((stream_data.video_type() == VideoParams::kVideoTypeVideo) ? input_time : Decoder::kAnyTimecode, p);
+      if (sequence) {
+        frame = sequence->GetFrame(stream_data.get_time_in_timebase_units(input_time), p);
+      } else {
+        frame = decoder->RetrieveVideo((stream_data.video_type() == VideoParams::kVideoTypeVideo) ? input_time : Decoder::kAnyTimecode, p);
+      }
 
       if (frame) {
         // Return a texture from the derived class
@@ -418,17 +538,13 @@ QVariant RenderProcessor::ProcessVideoFootage(const FootageJob &stream, const ra
                                       stream_data.premultiplied_alpha(),
                                       value.get());
 
-        still_image_cache_->mutex()->lock();
-
-        // Put this into the image cache instead
-        want_entry->texture = value;
-        want_entry->working = false;
-
-        still_image_cache_->wait_cond()->wakeAll();
-
-        still_image_cache_->mutex()->unlock();
+        // Other renderers may pick this texture up from the cache
+        render_ctx_->FinishPendingCommands();
       }
     }
+
+    // Put this into the image cache (or release our claim if we couldn't retrieve it)
+    still_image_cache_->Finish(cache_key, value);
   }
 
   return QVariant::fromValue(value);
@@ -441,9 +557,7 @@ QVariant RenderProcessor::ProcessAudioFootage(const FootageJob &stream, const Ti
   DecoderPtr decoder = ResolveDecoderFromInput(stream.decoder(), Decoder::CodecStream(stream.filename(), stream.audio_params().stream_index()));
 
   if (decoder) {
-    const AudioParams& audio_params = ticket_->property("aparam").value<AudioParams>();
-
-    SampleBufferPtr frame = decoder->RetrieveAudio(input_time, audio_params,
+    SampleBufferPtr frame = decoder->RetrieveAudio(input_time, audio_params_,
                                                    stream.cache_path(),
                                                    stream.loop_mode(),
                                                    &IsCancelled());
@@ -460,20 +574,11 @@ QVariant RenderProcessor::ProcessShader(const Node *node, const TimeRange &range
 {
   Q_UNUSED(range)
 
-  QString full_shader_id = QStringLiteral("%1:%2").arg(node->id(), job.GetShaderID());
-
-  QMutexLocker locker(shader_cache_->mutex());
-
-  QVariant shader = shader_cache_->value(full_shader_id);
+  QVariant shader = shader_cache_->Get(node, job.GetShaderID());
 
   if (shader.isNull()) {
-    // Since we have shader code, compile it now
-    shader = render_ctx_->CreateNativeShader(node->GetShaderCode(job.GetShaderID()));
-
-    if (shader.isNull()) {
-      // Couldn't find or build the shader required
-      return QVariant();
-    }
+    // Couldn't find or build the shader required
+    return QVariant();
   }
 
   VideoParams tex_params = GetCacheVideoParams();
@@ -497,17 +602,55 @@ QVariant RenderProcessor::ProcessSamples(const Node *node, const TimeRange &rang
   SampleBufferPtr output_buffer = SampleBuffer::CreateAllocated(job.samples()->audio_params(), job.samples()->sample_count());
   NodeValueDatabase value_db;
 
-  const AudioParams& audio_params = ticket_->property("aparam").value<AudioParams>();
+  // Calculate the exact rational time at each sample by counting ticks. Ranges normally start on
+  // a sample, otherwise we count in a finer timebase that both the in point and every sample land
+  // on. Either way, no rational arithmetic or gcd is needed per sample.
+  QVector<rational> sample_times(job.samples()->sample_count());
+  rational sample_timebase(1, audio_params_.sample_rate());
+  bool range_on_sample;
+  TickTime sample_time = TickTime::fromRational(range.in(), sample_timebase, &range_on_sample);
+  int64_t sample_step = 1;
+
+  if (!range_on_sample) {
+    rational tick_timebase = TickTime::commonTimebase(range.in(), sample_timebase);
+    sample_time = TickTime::fromRational(range.in(), tick_timebase);
+    sample_step = TickTime(1, sample_timebase).rescaled(tick_timebase).ticks();
+  }
 
-  for (int i=0;i<job.samples()->sample_count();i++) {
-    // Calculate the exact rational time at this sample
-    double sample_to_second = static_cast<double>(i) / static_cast<double>(audio_params.sample_rate());
+  TickTimeConverter sample_converter(sample_time.timebase());
 
-    rational this_sample_time = rational::fromDouble(range.in().toDouble() + sample_to_second);
+  for (int i=0;i<sample_times.size();i++) {
+    sample_times[i] = sample_converter.toRational(sample_time);
+    sample_time += sample_step;
+  }
+
+  // Inputs that are just keyframes or a static value can be evaluated for every sample at once
+  QHash<QString, QVector<QVariant> > immediate_values;
+  for (auto j=job.GetValues().constBegin(); j!=job.GetValues().constEnd(); j++) {
+    if (!node->IsInputConnected(j.key()) && !node->InputIsArray(j.key())) {
+      QVector<rational> adjusted_times(sample_times.size());
+
+      for (int i=0;i<sample_times.size();i++) {
+        adjusted_times[i] = node->InputTimeAdjustment(j.key(), -1, TimeRange(sample_times.at(i), sample_times.at(i))).in();
+      }
+
+      immediate_values.insert(j.key(), node->GetValuesAtTimes(j.key(), adjusted_times));
+    }
+  }
+
+  for (int i=0;i<job.samples()->sample_count();i++) {
+    const rational& this_sample_time = sample_times.at(i);
 
     // Update all non-sample and non-footage inputs
     for (auto j=job.GetValues().constBegin(); j!=job.GetValues().constEnd(); j++) {
-      NodeValueTable value = ProcessInput(node, j.key(), TimeRange(this_sample_time, this_sample_time));
+      NodeValueTable value;
+
+      auto immediate = immediate_values.constFind(j.key());
+      if (immediate == immediate_values.constEnd()) {
+        value = ProcessInputForSample(node, j.key(), this_sample_time);
+      } else {
+        value.Push(node->GetInputDataType(j.key()), immediate->at(i), node);
+      }
 
       value_db.Insert(j.key(), value);
     }
@@ -543,20 +686,25 @@ QVariant RenderProcessor::ProcessFrameGeneration(const Node *node, const Generat
 
 bool RenderProcessor::CanCacheFrames()
 {
-  return ticket_->property("type").value<RenderManager::TicketType>() == RenderManager::kTypeVideo;
+  return job_->renders_video();
 }
 
 QVariant RenderProcessor::GetCachedTexture(const QByteArray& hash)
 {
-  QString cache_dir = ticket_->property("cache").toString();
-  if (cache_dir.isEmpty()) {
+  // Check textures kept in memory from earlier frames first
+  TexturePtr texture = texture_cache_->Get(hash);
+  if (texture) {
+    return QVariant::fromValue(texture);
+  }
+
+  if (cache_dir_.isEmpty()) {
     return QVariant();
   }
 
-  FramePtr f = FrameHashCache::LoadCacheFrame(cache_dir, hash);
+  FramePtr f = FrameHashCache::LoadCacheFrame(cache_dir_, hash);
 
   if (f) {
-    TexturePtr texture = render_ctx_->CreateTexture(f->video_params(), f->data(), f->linesize_pixels());
+    texture = render_ctx_->CreateTexture(f->video_params(), f->data(), f->linesize_pixels());
     return QVariant::fromValue(texture);
   }
 
@@ -565,23 +713,10 @@ QVariant RenderProcessor::GetCachedTexture(const QByteArray& hash)
 
 void RenderProcessor::SaveCachedTexture(const QByteArray &hash, const QVariant &tex_var)
 {
-  // FIXME: Temporarily disabled because I don't know how to ensure that the frame saved here is
-  //        not the main frame. If it is, it'll be saved twice which will waste a lot of cycles.
-  //        At least disabled, the frame will still save, and if nothing else alters the hash, it
-  //        will pick up automatically from GetCachedTexture.
-  /*if (!tex_var.isNull()) {
-    QString cache_dir = ticket_->property("cache").toString();
-
-    if (!cache_dir.isEmpty()) {
-      TexturePtr texture = tex_var.value<TexturePtr>();
-      FramePtr frame = Frame::Create();
-      frame->set_video_params(texture->params());
-      frame->allocate();
-      render_ctx_->DownloadFromTexture(texture.get(), frame->data(), frame->linesize_pixels());
-      FrameHashCache::SaveCacheFrame(cache_dir, hash, frame);
-      qDebug() << "Saved mid-render frame to cache";
-    }
-  }*/
+  // Kept in memory rather than the disk cache so the texture can be reused without a download
+  // and upload, and so a frame is never written to the disk cache twice
+  render_ctx_->FinishPendingCommands();
+  texture_cache_->Insert(hash, tex_var.value<TexturePtr>());
 }
 
 }
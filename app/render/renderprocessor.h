@@ -21,10 +21,14 @@
 #ifndef RENDERPROCESSOR_H
 #define RENDERPROCESSOR_H
 
+#include "audio/audioresampler.h"
 #include "node/traverser.h"
 #include "render/renderer.h"
 #include "rendercache.h"
+#include "renderjob.h"
+#include "shadercache.h"
 #include "stillimagecache.h"
+#include "texturecache.h"
 #include "threading/threadticket.h"
 
 namespace olive {
@@ -32,7 +36,7 @@ namespace olive {
 class RenderProcessor : public NodeTraverser
 {
 public:
-  static void Process(RenderTicketPtr ticket, Renderer* render_ctx, StillImageCache* still_image_cache, DecoderCache* decoder_cache, ShaderCache* shader_cache, QVariant default_shader);
+  static void Process(RenderTicketPtr ticket, Renderer* render_ctx, StillImageCache* still_image_cache, TextureCache* texture_cache, DecoderCache* decoder_cache, ImageSequenceCache* sequence_cache, ShaderCache* shader_cache, QVariant default_shader);
 
   struct RenderedWaveform {
     const Track* track;
@@ -60,26 +64,69 @@ protected:
   virtual void SaveCachedTexture(const QByteArray& hash, const QVariant& texture) override;
 
 private:
-  RenderProcessor(RenderTicketPtr ticket, Renderer* render_ctx, StillImageCache* still_image_cache, DecoderCache* decoder_cache, ShaderCache* shader_cache, QVariant default_shader);
+  RenderProcessor(RenderTicketPtr ticket, Renderer* render_ctx, StillImageCache* still_image_cache, TextureCache* texture_cache, DecoderCache* decoder_cache, ImageSequenceCache* sequence_cache, ShaderCache* shader_cache, QVariant default_shader);
+
+  /**
+   * @brief A frame whose pixels may still be on their way back from the GPU
+   */
+  struct PendingFrame {
+    FramePtr frame;
+    QVariant download;
+  };
+
+  PendingFrame GenerateFrame(const VideoRenderJob* job, const rational &time, const rational &frame_length);
+
+  PendingFrame StartVideoFrame(const VideoRenderJob* job, const rational &time);
+
+  /**
+   * @brief Wait for a frame's readback to complete and return it
+   */
+  FramePtr WaitForFrame(const PendingFrame& pending);
 
-  FramePtr GenerateFrame(const rational &time, const rational &frame_length);
+  /**
+   * @brief Free a frame's readback without waiting for it
+   */
+  void DiscardFrame(const PendingFrame& pending);
 
   void Run();
 
   DecoderPtr ResolveDecoderFromInput(const QString &decoder_id, const Decoder::CodecStream& stream);
 
+  ImageSequenceReaderPtr ResolveImageSequenceReader(const QString &decoder_id, const Decoder::CodecStream& stream, const VideoParams& params);
+
   RenderTicketPtr ticket_;
 
   Renderer* render_ctx_;
 
   StillImageCache* still_image_cache_;
 
+  TextureCache* texture_cache_;
+
   DecoderCache* decoder_cache_;
 
+  ImageSequenceCache* sequence_cache_;
+
   ShaderCache* shader_cache_;
 
   QVariant default_shader_;
 
+  const RenderJob* job_;
+
+  AudioParams audio_params_;
+
+  ColorManager* color_manager_;
+
+  QString cache_dir_;
+
+  QVector<RenderedWaveform> waveforms_;
+
+  AudioResampler resampler_;
+
+  /**
+   * @brief Longest a single wait for a download holds the render thread, in nanoseconds
+   */
+  static const qint64 kDownloadWaitSlice;
+
 };
 
 }
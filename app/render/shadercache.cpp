@@ -0,0 +1,164 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "shadercache.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QSet>
+#include <QtConcurrent/QtConcurrent>
+
+#include "node/node.h"
+#include "render/renderer.h"
+
+namespace olive {
+
+ShaderCache::ShaderCache(Renderer *renderer) :
+  renderer_(renderer)
+{
+}
+
+ShaderCache::~ShaderCache()
+{
+  precompiles_.waitForFinished();
+
+  foreach (EntryPtr e, programs_) {
+    if (!e->shader.isNull()) {
+      renderer_->DestroyNativeShader(e->shader);
+    }
+  }
+}
+
+QVariant ShaderCache::Get(const Node *node, const QString &shader_id)
+{
+  QString key = GetKey(node, shader_id);
+
+  {
+    QMutexLocker locker(&mutex_);
+
+    EntryPtr e = ids_.value(key);
+
+    if (e) {
+      while (e->compiling) {
+        e->ready.wait(&mutex_);
+      }
+
+      return e->shader;
+    }
+  }
+
+  // Generating code may involve reading files, so don't hold the lock while doing it. If another
+  // thread gets here with the same ID, Compile() will still only compile it once.
+  return Compile(key, node->GetShaderCode(shader_id));
+}
+
+void ShaderCache::Precompile(const QVector<Node *> &nodes)
+{
+  QVector<QPair<QString, ShaderCode> > jobs;
+  QSet<QString> seen_types;
+
+  foreach (Node* n, nodes) {
+    if (seen_types.contains(n->id())) {
+      continue;
+    }
+
+    seen_types.insert(n->id());
+
+    foreach (const QString& shader_id, n->GetPrecompileShaderIDs()) {
+      QString key = GetKey(n, shader_id);
+
+      mutex_.lock();
+      bool exists = ids_.contains(key);
+      mutex_.unlock();
+
+      if (!exists) {
+        jobs.append({key, n->GetShaderCode(shader_id)});
+      }
+    }
+  }
+
+  if (jobs.isEmpty()) {
+    return;
+  }
+
+  // Programs are compiled one after another since the renderer only has one context to compile on
+  precompiles_.addFuture(QtConcurrent::run([this, jobs]{
+    foreach (const auto& j, jobs) {
+      Compile(j.first, j.second);
+    }
+  }));
+}
+
+QString ShaderCache::GetKey(const Node *node, const QString &shader_id)
+{
+  return QStringLiteral("%1:%2").arg(node->id(), shader_id);
+}
+
+QByteArray ShaderCache::HashCode(const ShaderCode &code)
+{
+  QCryptographicHash hasher(QCryptographicHash::Sha1);
+
+  hasher.addData(code.vert_code().toUtf8());
+  hasher.addData("\0", 1);
+  hasher.addData(code.frag_code().toUtf8());
+
+  return hasher.result();
+}
+
+QVariant ShaderCache::Compile(const QString &key, const ShaderCode &code)
+{
+  QByteArray hash = HashCode(code);
+
+  QMutexLocker locker(&mutex_);
+
+  EntryPtr e = programs_.value(hash);
+
+  if (!e) {
+    // Reserve this program for us and compile it without blocking other lookups
+    e = std::make_shared<Entry>();
+    e->compiling = true;
+    programs_.insert(hash, e);
+    ids_.insert(key, e);
+
+    locker.unlock();
+    QVariant shader = renderer_->CreateNativeShader(code);
+    locker.relock();
+
+    if (shader.isNull()) {
+      qWarning() << "Failed to compile shader" << key;
+    }
+
+    e->shader = shader;
+    e->compiling = false;
+    e->ready.wakeAll();
+
+    return shader;
+  }
+
+  ids_.insert(key, e);
+
+  while (e->compiling) {
+    e->ready.wait(&mutex_);
+  }
+
+  return e->shader;
+}
+
+}
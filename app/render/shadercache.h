@@ -0,0 +1,101 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef SHADERCACHE_H
+#define SHADERCACHE_H
+
+#include <memory>
+#include <QFutureSynchronizer>
+#include <QHash>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include "common/define.h"
+#include "render/shadercode.h"
+
+namespace olive {
+
+class Node;
+class Renderer;
+
+/**
+ * @brief Thread-safe cache of compiled shader programs
+ *
+ * Shaders are looked up by node ID and shader ID, and compiled programs are shared by every ID
+ * whose code is identical (e.g. all the nodes that use the default shader). Compiling happens
+ * outside the lock, and if another thread is already compiling the same code, Get() waits for
+ * that thread instead of compiling it again.
+ *
+ * A program that failed to compile is remembered as a null QVariant so it isn't retried every
+ * frame.
+ */
+class ShaderCache
+{
+public:
+  ShaderCache(Renderer* renderer);
+
+  ~ShaderCache();
+
+  DISABLE_COPY_MOVE(ShaderCache)
+
+  /**
+   * @brief Get the compiled program for this node's shader ID, compiling it if necessary
+   */
+  QVariant Get(const Node* node, const QString& shader_id);
+
+  /**
+   * @brief Compile the fixed shaders of every type of node in this list in the background
+   *
+   * Shader code is retrieved on the calling thread, so the nodes only need to be valid for the
+   * duration of this call. Rendering that needs one of these shaders before it's ready will wait
+   * for it rather than compile it again.
+   */
+  void Precompile(const QVector<Node*>& nodes);
+
+private:
+  struct Entry {
+    QVariant shader;
+    bool compiling;
+    QWaitCondition ready;
+  };
+
+  using EntryPtr = std::shared_ptr<Entry>;
+
+  static QString GetKey(const Node* node, const QString& shader_id);
+
+  static QByteArray HashCode(const ShaderCode& code);
+
+  QVariant Compile(const QString& key, const ShaderCode& code);
+
+  Renderer* renderer_;
+
+  QMutex mutex_;
+
+  QHash<QString, EntryPtr> ids_;
+
+  QHash<QByteArray, EntryPtr> programs_;
+
+  QFutureSynchronizer<void> precompiles_;
+
+};
+
+}
+
+#endif // SHADERCACHE_H
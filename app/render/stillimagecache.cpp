@@ -0,0 +1,128 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "stillimagecache.h"
+
+#include "render/texturecache.h"
+
+namespace olive {
+
+const qint64 StillImageCache::kDefaultBudget = 512LL * 1024 * 1024;
+
+StillImageCache::StillImageCache(qint64 budget) :
+  budget_(budget),
+  size_(0)
+{
+}
+
+TexturePtr StillImageCache::Acquire(const Key &key, bool *claimed)
+{
+  QMutexLocker locker(&mutex_);
+
+  *claimed = false;
+
+  EntryPtr e = entries_.value(key);
+
+  if (!e) {
+    // Reserve this entry for the caller
+    e = std::make_shared<Entry>();
+    e->working = true;
+    e->size = 0;
+    entries_.insert(key, e);
+
+    *claimed = true;
+
+    return nullptr;
+  }
+
+  // Another thread is producing this texture, wait for it
+  while (e->working) {
+    e->ready.wait(&mutex_);
+  }
+
+  if (e->texture) {
+    // Move to the front of the LRU list
+    lru_.splice(lru_.begin(), lru_, e->lru);
+  }
+
+  return e->texture;
+}
+
+void StillImageCache::Finish(const Key &key, TexturePtr texture)
+{
+  QMutexLocker locker(&mutex_);
+
+  EntryPtr e = entries_.value(key);
+
+  if (!e) {
+    return;
+  }
+
+  e->texture = texture;
+  e->working = false;
+
+  if (texture) {
+    // Any renderer may read it from now on
+    texture->SetShared();
+
+    e->size = TextureCache::GetTextureSize(texture.get());
+    lru_.push_front(key);
+    e->lru = lru_.begin();
+    size_ += e->size;
+
+    EvictToBudget();
+  } else {
+    // Nothing was produced, let the next thread to want this try again
+    entries_.remove(key);
+  }
+
+  // Waiting threads hold their own reference to the entry so they still see the result
+  e->ready.wakeAll();
+}
+
+qint64 StillImageCache::GetSize()
+{
+  QMutexLocker locker(&mutex_);
+
+  return size_;
+}
+
+void StillImageCache::EvictToBudget()
+{
+  // Always keep at least the most recent texture, even if it's larger than the budget on its own
+  while (size_ > budget_ && lru_.size() > 1) {
+    auto it = entries_.find(lru_.back());
+
+    size_ -= it.value()->size;
+    entries_.erase(it);
+    lru_.pop_back();
+  }
+}
+
+uint qHash(const StillImageCache::Key &key, uint seed)
+{
+  return qHash(key.stream, seed)
+      ^ ::qHash(key.colorspace, seed)
+      ^ ::qHash(static_cast<int>(key.alpha_is_associated), seed)
+      ^ ::qHash(key.divider, seed)
+      ^ qHash(key.time, seed);
+}
+
+}
@@ -1,84 +1,131 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
 #ifndef STILLIMAGECACHE_H
 #define STILLIMAGECACHE_H
 
+#include <list>
+#include <memory>
 #include <QHash>
+#include <QMutex>
 #include <QWaitCondition>
 
 #include "codec/decoder.h"
+#include "common/define.h"
 #include "common/rational.h"
 #include "node/project/footage/footage.h"
 #include "render/texture.h"
 
 namespace olive {
 
+/**
+ * @brief Thread-safe cache of decoded and color managed footage textures
+ *
+ * Uploading and color managing a large still image or image sequence frame for every frame that
+ * uses it is a waste of time, so RenderProcessor keeps them here. Entries are looked up by hash and
+ * the cache is bounded by the total size of its textures, dropping the least recently used ones
+ * when full.
+ *
+ * If a texture is already being produced by another thread, Acquire() waits for that thread to
+ * Finish() it rather than producing it again. Each entry has its own wait condition so finishing
+ * one texture only wakes the threads waiting for it.
+ */
 class StillImageCache
 {
 public:
-  struct Entry {
-    Entry(TexturePtr t, const Decoder::CodecStream& s, const QString& cs, bool a, int d, const rational& i, bool w)
-    {
-      texture = t;
-      stream = s;
-      colorspace = cs;
-      alpha_is_associated = a;
-      divider = d;
-      time = i;
-      working = w;
-    }
-
-    TexturePtr texture;
+  struct Key {
     Decoder::CodecStream stream;
     QString colorspace;
     bool alpha_is_associated;
     int divider;
     rational time;
+
+    bool operator==(const Key& rhs) const
+    {
+      return stream == rhs.stream
+          && colorspace == rhs.colorspace
+          && alpha_is_associated == rhs.alpha_is_associated
+          && divider == rhs.divider
+          && time == rhs.time;
+    }
+  };
+
+  StillImageCache(qint64 budget = kDefaultBudget);
+
+  DISABLE_COPY_MOVE(StillImageCache)
+
+  /**
+   * @brief Get the texture for this key, waiting if another thread is producing it
+   *
+   * If there's no texture for this key yet, an entry is reserved for the caller, `claimed` is set
+   * to true and nullptr is returned. The caller must then produce the texture and pass it to
+   * Finish(), even if it failed to produce one, or other threads will wait on it forever.
+   */
+  TexturePtr Acquire(const Key& key, bool* claimed);
+
+  /**
+   * @brief Provide the texture for a key reserved by Acquire() and wake threads waiting for it
+   *
+   * If `texture` is nullptr, the reservation is dropped and waiting threads receive nullptr.
+   */
+  void Finish(const Key& key, TexturePtr texture);
+
+  /**
+   * @brief Total size in bytes of the finished textures currently stored
+   */
+  qint64 GetSize();
+
+  static const qint64 kDefaultBudget;
+
+private:
+  struct Entry {
+    TexturePtr texture;
     bool working;
+    QWaitCondition ready;
+    qint64 size;
+    std::list<Key>::iterator lru;
   };
 
   using EntryPtr = std::shared_ptr<Entry>;
 
-  QMutex* mutex()
-  {
-    return &mutex_;
-  }
-
-  QWaitCondition* wait_cond()
-  {
-    return &wait_cond_;
-  }
-
-  const QVector<EntryPtr>& entries() const
-  {
-    return entries_;
-  }
-
-  static bool CompareEntryMetadata(EntryPtr a, EntryPtr b)
-  {
-    return (a->stream == b->stream
-            && a->colorspace == b->colorspace
-            && a->alpha_is_associated == b->alpha_is_associated
-            && a->divider == b->divider
-            && a->time == b->time);
-  }
-
-  void PushEntry(EntryPtr e)
-  {
-    entries_.prepend(e);
-
-    if (entries_.size() > 8) {
-      entries_.removeLast();
-    }
-  }
+  void EvictToBudget();
 
-private:
   QMutex mutex_;
 
-  QWaitCondition wait_cond_;
+  QHash<Key, EntryPtr> entries_;
 
-  QVector<EntryPtr> entries_;
+  /**
+   * @brief Keys of finished entries from most to least recently used
+   *
+   * Entries being worked on aren't in this list so they can't be evicted.
+   */
+  std::list<Key> lru_;
+
+  qint64 budget_;
+
+  qint64 size_;
 
 };
 
+uint qHash(const StillImageCache::Key& key, uint seed = 0);
+
 }
 
 #endif // STILLIMAGECACHE_H
@@ -51,7 +51,8 @@ public:
   Texture(const VideoParams& param) :
     renderer_(nullptr),
     params_(param),
-    type_(k2D)
+    type_(k2D),
+    shared_(false)
   {
   }
 
@@ -62,7 +63,8 @@ public:
     renderer_(renderer),
     params_(param),
     id_(native),
-    type_(type)
+    type_(type),
+    shared_(false)
   {
   }
 
@@ -80,6 +82,22 @@ public:
 
   void Upload(void* data, int linesize);
 
+  /**
+   * @brief Mark this texture as readable by other renderers, e.g. because it was stored in a cache
+   *
+   * Another renderer's context may still be reading a shared texture when it's destroyed, so its
+   * renderer frees it rather than recycling it through the texture pool.
+   */
+  void SetShared()
+  {
+    shared_ = true;
+  }
+
+  bool IsShared() const
+  {
+    return shared_;
+  }
+
   bool IsDummy() const
   {
     return !renderer_;
@@ -129,6 +147,8 @@ private:
 
   Type type_;
 
+  bool shared_;
+
 };
 
 using TexturePtr = std::shared_ptr<Texture>;
@@ -0,0 +1,117 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "texturecache.h"
+
+namespace olive {
+
+const qint64 TextureCache::kDefaultBudget = 512LL * 1024 * 1024;
+
+TextureCache::TextureCache(qint64 budget) :
+  budget_(budget),
+  size_(0)
+{
+}
+
+TexturePtr TextureCache::Get(const QByteArray &hash)
+{
+  QMutexLocker locker(&mutex_);
+
+  auto it = entries_.find(hash);
+
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+
+  // Move to the front of the LRU list
+  lru_.splice(lru_.begin(), lru_, it->lru);
+
+  return it->texture;
+}
+
+void TextureCache::Insert(const QByteArray &hash, TexturePtr texture)
+{
+  if (!texture) {
+    return;
+  }
+
+  qint64 size = GetTextureSize(texture.get());
+
+  if (size > budget_) {
+    return;
+  }
+
+  // Any renderer may read it from now on
+  texture->SetShared();
+
+  QMutexLocker locker(&mutex_);
+
+  auto existing = entries_.find(hash);
+  if (existing != entries_.end()) {
+    Remove(existing);
+  }
+
+  // Drop least recently used textures until this one fits
+  while (size_ + size > budget_ && !lru_.empty()) {
+    Remove(entries_.find(lru_.back()));
+  }
+
+  lru_.push_front(hash);
+
+  Entry e;
+  e.texture = texture;
+  e.size = size;
+  e.lru = lru_.begin();
+  entries_.insert(hash, e);
+
+  size_ += size;
+}
+
+void TextureCache::Clear()
+{
+  QMutexLocker locker(&mutex_);
+
+  entries_.clear();
+  lru_.clear();
+  size_ = 0;
+}
+
+qint64 TextureCache::GetSize()
+{
+  QMutexLocker locker(&mutex_);
+
+  return size_;
+}
+
+qint64 TextureCache::GetTextureSize(const Texture *texture)
+{
+  const VideoParams& p = texture->params();
+
+  return static_cast<qint64>(p.effective_width()) * p.effective_height() * p.GetBytesPerPixel();
+}
+
+void TextureCache::Remove(QHash<QByteArray, Entry>::iterator it)
+{
+  size_ -= it->size;
+  lru_.erase(it->lru);
+  entries_.erase(it);
+}
+
+}
@@ -0,0 +1,102 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef TEXTURECACHE_H
+#define TEXTURECACHE_H
+
+#include <list>
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+
+#include "common/define.h"
+#include "render/texture.h"
+
+namespace olive {
+
+/**
+ * @brief Thread-safe in-memory store of rendered textures keyed by node hash
+ *
+ * Used by RenderProcessor to keep the output of time-invariant subgraphs across frames and
+ * tickets. Bounded by the total size of its textures rather than their count; when full, the least
+ * recently used textures are dropped.
+ */
+class TextureCache
+{
+public:
+  TextureCache(qint64 budget = kDefaultBudget);
+
+  DISABLE_COPY_MOVE(TextureCache)
+
+  /**
+   * @brief Get the texture stored for this hash, or nullptr if there isn't one
+   */
+  TexturePtr Get(const QByteArray& hash);
+
+  /**
+   * @brief Store a texture, replacing any texture already stored for this hash
+   *
+   * Textures larger than the whole budget are not stored.
+   */
+  void Insert(const QByteArray& hash, TexturePtr texture);
+
+  void Clear();
+
+  qint64 GetBudget() const
+  {
+    return budget_;
+  }
+
+  /**
+   * @brief Total size in bytes of the textures currently stored
+   */
+  qint64 GetSize();
+
+  static qint64 GetTextureSize(const Texture* texture);
+
+  static const qint64 kDefaultBudget;
+
+private:
+  struct Entry {
+    TexturePtr texture;
+    qint64 size;
+    std::list<QByteArray>::iterator lru;
+  };
+
+  void Remove(QHash<QByteArray, Entry>::iterator it);
+
+  QMutex mutex_;
+
+  QHash<QByteArray, Entry> entries_;
+
+  /**
+   * @brief Hashes of entries_ from most to least recently used
+   */
+  std::list<QByteArray> lru_;
+
+  qint64 budget_;
+
+  qint64 size_;
+
+};
+
+}
+
+#endif // TEXTURECACHE_H
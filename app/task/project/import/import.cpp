@@ -22,6 +22,7 @@
 
 #include <QDir>
 #include <QFileInfo>
+#include <QtConcurrent/QtConcurrent>
 
 #include "config/config.h"
 #include "core.h"
@@ -53,10 +54,17 @@ bool ProjectImportTask::Run()
 {
   command_ = new MultiUndoCommand();
 
+  // Probe everything up front so files are probed concurrently while Import() adds them in order
+  QueueProbes(filenames_);
+
   int imported = 0;
 
   Import(folder_, filenames_, imported, command_);
 
+  // Anything still waiting to be probed is no longer needed (the import was cancelled)
+  probe_pool_.clear();
+  probe_pool_.waitForDone();
+
   if (IsCancelled()) {
     delete command_;
     command_ = nullptr;
@@ -78,18 +86,7 @@ void ProjectImportTask::Import(Folder *folder, QFileInfoList import, int &counte
     // Check if this file is a directory
     if (file_info.isDir()) {
 
-      // QDir::entryList only returns filenames, we can use entryInfoList() to get full paths
-      QFileInfoList entry_list = QDir(file_info.absoluteFilePath()).entryInfoList();
-
-      // Strip out "." and ".." (for some reason QDir::NoDotAndDotDot	doesn't work with entryInfoList, so we have to
-      // check manually)
-      for (int j=0;j<entry_list.size();j++) {
-        if (entry_list.at(j).fileName() == QStringLiteral(".")
-            || entry_list.at(j).fileName() == QStringLiteral("..")) {
-          entry_list.removeAt(j);
-          j--;
-        }
-      }
+      QFileInfoList entry_list = GetDirectoryEntries(file_info.absoluteFilePath());
 
       // Only proceed if the empty actually has files in it
       if (!entry_list.isEmpty()) {
@@ -107,7 +104,28 @@ void ProjectImportTask::Import(Folder *folder, QFileInfoList import, int &counte
 
     } else {
 
-      Footage* footage = new Footage(file_info.absoluteFilePath());
+      QString filename = file_info.absoluteFilePath();
+
+      if (!probes_.contains(filename)) {
+        // This was held back as part of a possible image sequence that turned out not to be one,
+        // so queue the rest of that sequence together rather than probing one file at a time
+        QString pattern = Decoder::TransformImageSequenceFileName(filename, 0);
+
+        for (int j=i; j<import.size(); j++) {
+          const QFileInfo& other = import.at(j);
+
+          if (!other.isDir()
+              && Decoder::GetImageSequenceDigitCount(other.fileName()) > 0
+              && Decoder::TransformImageSequenceFileName(other.absoluteFilePath(), 0) == pattern) {
+            QueueProbe(other.absoluteFilePath());
+          }
+        }
+      }
+
+      // Creating the Footage reads the probe's result back from the metadata cache
+      GetProbe(filename);
+
+      Footage* footage = new Footage(filename);
 
       footage->SetLabel(file_info.fileName());
 
@@ -119,7 +137,7 @@ void ProjectImportTask::Import(Folder *folder, QFileInfoList import, int &counte
         AddItemToFolder(folder, footage, parent_command);
       } else {
         // Add to list so we can tell the user about it later
-        invalid_files_.append(file_info.absoluteFilePath());
+        invalid_files_.append(filename);
 
         delete footage;
       }
@@ -137,28 +155,29 @@ void ProjectImportTask::ValidateImageSequence(Footage *footage, QFileInfoList& i
   // Heuristically determine whether this file is part of an image sequence or not
   //
   // By this point we've established that video contains a single still image stream. Now we'll
-  // see if it ends with numbers.
-  if (Decoder::GetImageSequenceDigitCount(footage->filename()) > 0
-      && !image_sequence_ignore_files_.contains(footage->filename())
-      && footage->InputArraySize(Footage::kVideoParamsInput)) {
+  // see if it ends with numbers that other files in its directory continue.
+  int64_t start_index = 0, end_index = 0;
+
+  if (!image_sequence_ignore_files_.contains(footage->filename())
+      && footage->InputArraySize(Footage::kVideoParamsInput)
+      && GetImageSequenceRange(footage->filename(), &start_index, &end_index)) {
     VideoParams video_stream = footage->GetVideoParams(0);
     QSize dim(video_stream.width(), video_stream.height());
 
     int64_t ind = Decoder::GetImageSequenceIndex(footage->filename());
 
-    // Check if files around exist around it with that follow a sequence
-    QString previous_img_fn = Decoder::TransformImageSequenceFileName(footage->filename(), ind - 1);
-    QString next_img_fn = Decoder::TransformImageSequenceFileName(footage->filename(), ind + 1);
+    // See if the surrounding files are still images with the same dimensions
+    bool neighbor_matches = false;
 
-    // See if the same decoder can retrieve surrounding files
-    DecoderPtr decoder = Decoder::CreateFromID(footage->decoder());
+    if (ind < end_index) {
+      neighbor_matches = CompareStillImageSize(GetProbe(Decoder::TransformImageSequenceFileName(footage->filename(), ind + 1)), dim);
+    }
 
-    Footage* previous_file = new Footage(previous_img_fn);
-    Footage* next_file = new Footage(next_img_fn);
+    if (!neighbor_matches && ind > start_index) {
+      neighbor_matches = CompareStillImageSize(GetProbe(Decoder::TransformImageSequenceFileName(footage->filename(), ind - 1)), dim);
+    }
 
-    // Finally see if these files have the same dimensions
-    if ((previous_file->IsValid() && CompareStillImageSize(previous_file, dim))
-        || (next_file->IsValid() && CompareStillImageSize(next_file, dim))) {
+    if (neighbor_matches) {
       // By this point, we've established this file is a still image with a number at the end of
       // the filename surrounded by adjacent numbers. It could be a still image! But let's ask the
       // user just in case...
@@ -170,31 +189,24 @@ void ProjectImportTask::ValidateImageSequence(Footage *footage, QFileInfoList& i
                                 Q_RETURN_ARG(bool, is_sequence),
                                 Q_ARG(QString, footage->filename()));
 
-      int64_t seq_index = Decoder::GetImageSequenceIndex(footage->filename());
+      // The run of files around this one is our heuristic for the first and last images (users can
+      // always override this later in FootagePropertiesDialog)
+      QSet<QString> sequence;
 
-      // Heuristic to find the first and last images (users can always override this later in
-      // FootagePropertiesDialog)
-      int64_t start_index = GetImageSequenceLimit(footage->filename(), seq_index, false);
-      int64_t end_index = GetImageSequenceLimit(footage->filename(), seq_index, true);
+      for (int64_t j=start_index; j<=end_index; j++) {
+        sequence.insert(Decoder::TransformImageSequenceFileName(footage->filename(), j));
+      }
 
       // Depending on the user's choice, either remove them from the list or don't ask for the
       // remainders
-      for (int64_t j=start_index; j<=end_index; j++) {
-        QString entry_fn = Decoder::TransformImageSequenceFileName(footage->filename(), j);
-
-        if (is_sequence) {
-          // If this is part of the sequence we're importing here, remove it
-          for (int i=index+1; i<info_list.size(); i++) {
-            if (info_list.at(i).absoluteFilePath() == entry_fn) {
-              if (is_sequence) {
-                info_list.removeAt(i);
-              }
-              break;
-            }
+      if (is_sequence) {
+        for (int i=info_list.size()-1; i>index; i--) {
+          if (sequence.contains(info_list.at(i).absoluteFilePath())) {
+            info_list.removeAt(i);
           }
-        } else {
-          image_sequence_ignore_files_.append(entry_fn);
         }
+      } else {
+        image_sequence_ignore_files_.unite(sequence);
       }
 
       if (is_sequence) {
@@ -211,9 +223,6 @@ void ProjectImportTask::ValidateImageSequence(Footage *footage, QFileInfoList& i
         footage->SetVideoParams(video_stream, 0);
       }
     }
-
-    delete previous_file;
-    delete next_file;
   }
 }
 
@@ -229,45 +238,79 @@ void ProjectImportTask::AddItemToFolder(Folder *folder, Node *item, MultiUndoCom
   command->add_child(new FolderAddChild(folder, item));
 }
 
-bool ProjectImportTask::ItemIsStillImageFootageOnly(Footage* footage)
+void ProjectImportTask::QueueProbes(const QFileInfoList &list)
 {
-  if (footage->GetTotalStreamCount() != 1) {
-    // Footage with more than one stream (usually video+audio) most likely isn't an image sequence
-    return false;
+  foreach (const QFileInfo& file_info, list) {
+    if (IsCancelled()) {
+      break;
+    }
+
+    if (file_info.isDir()) {
+      QueueProbes(GetDirectoryEntries(file_info.absoluteFilePath()));
+      continue;
+    }
+
+    QString filename = file_info.absoluteFilePath();
+
+    if (probes_.contains(filename) || sequence_files_.contains(filename)) {
+      continue;
+    }
+
+    QueueProbe(filename);
+
+    int64_t start_index = 0, end_index = 0;
+
+    if (GetImageSequenceRange(filename, &start_index, &end_index)) {
+      for (int64_t j=start_index; j<=end_index; j++) {
+        sequence_files_.insert(Decoder::TransformImageSequenceFileName(filename, j));
+      }
+
+      // ValidateImageSequence() will compare this file to the next, or the previous at the end
+      int64_t ind = Decoder::GetImageSequenceIndex(filename);
+      QueueProbe(Decoder::TransformImageSequenceFileName(filename, (ind < end_index) ? ind + 1 : ind - 1));
+    }
   }
+}
 
-  VideoParams vp = footage->GetVideoParams(0);
+void ProjectImportTask::QueueProbe(const QString &filename)
+{
+  if (!probes_.contains(filename)) {
+    probes_.insert(filename, QtConcurrent::run(&probe_pool_, &Footage::ProbeFile, filename, &IsCancelled()));
+  }
+}
 
-  // Footage must be valid and video stream must be a still image to be an image sequence
-  return vp.is_valid() && vp.video_type() == VideoParams::kVideoTypeStill;
+FootageDescription ProjectImportTask::GetProbe(const QString &filename)
+{
+  QueueProbe(filename);
+
+  return probes_.value(filename).result();
 }
 
-bool ProjectImportTask::CompareStillImageSize(Footage* footage, const QSize &sz)
+bool ProjectImportTask::GetImageSequenceRange(const QString &filename, int64_t *start, int64_t *end)
 {
-  if (!ItemIsStillImageFootageOnly(footage)) {
+  if (Decoder::GetImageSequenceDigitCount(filename) == 0) {
     return false;
   }
 
-  VideoParams stream = footage->GetVideoParams(0);
+  int64_t ind = Decoder::GetImageSequenceIndex(filename);
 
-  return stream.width() == sz.width() && stream.height() == sz.height();
+  *start = GetImageSequenceLimit(filename, ind, false);
+  *end = GetImageSequenceLimit(filename, ind, true);
+
+  return *start != *end;
 }
 
 int64_t ProjectImportTask::GetImageSequenceLimit(const QString& start_fn, int64_t start, bool up)
 {
-  QString test_filename;
-  int test_index;
+  // Look the numbers up in one listing of the directory rather than checking each file on disk
+  const QSet<QString>& files = GetDirectoryFileNames(QFileInfo(start_fn).absolutePath());
 
   forever {
-    if (up) {
-      test_index = start + 1;
-    } else {
-      test_index = start - 1;
-    }
+    int64_t test_index = up ? start + 1 : start - 1;
 
-    test_filename = Decoder::TransformImageSequenceFileName(start_fn, test_index);
+    QString test_filename = QFileInfo(Decoder::TransformImageSequenceFileName(start_fn, test_index)).fileName();
 
-    if (!QFileInfo::exists(test_filename)) {
+    if (!files.contains(test_filename)) {
       // Reached end of index
       break;
     }
@@ -278,4 +321,66 @@ int64_t ProjectImportTask::GetImageSequenceLimit(const QString& start_fn, int64_
   return start;
 }
 
+const QSet<QString> &ProjectImportTask::GetDirectoryFileNames(const QString &path)
+{
+  auto it = directory_files_.find(path);
+
+  if (it == directory_files_.end()) {
+    QStringList names = QDir(path).entryList(QDir::Files | QDir::Hidden);
+
+    QSet<QString> set;
+    set.reserve(names.size());
+    foreach (const QString& n, names) {
+      set.insert(n);
+    }
+
+    it = directory_files_.insert(path, set);
+  }
+
+  return it.value();
+}
+
+QFileInfoList ProjectImportTask::GetDirectoryEntries(const QString &path)
+{
+  // QDir::entryList only returns filenames, we can use entryInfoList() to get full paths
+  QFileInfoList entry_list = QDir(path).entryInfoList();
+
+  // Strip out "." and ".." (for some reason QDir::NoDotAndDotDot	doesn't work with entryInfoList, so we have to
+  // check manually)
+  for (int j=0;j<entry_list.size();j++) {
+    if (entry_list.at(j).fileName() == QStringLiteral(".")
+        || entry_list.at(j).fileName() == QStringLiteral("..")) {
+      entry_list.removeAt(j);
+      j--;
+    }
+  }
+
+  return entry_list;
+}
+
+bool ProjectImportTask::ItemIsStillImageFootageOnly(const FootageDescription &footage)
+{
+  if (footage.GetVideoStreams().size() + footage.GetAudioStreams().size() != 1
+      || footage.GetVideoStreams().isEmpty()) {
+    // Footage with more than one stream (usually video+audio) most likely isn't an image sequence
+    return false;
+  }
+
+  const VideoParams& vp = footage.GetVideoStreams().first();
+
+  // Footage must be valid and video stream must be a still image to be an image sequence
+  return footage.IsValid() && vp.is_valid() && vp.video_type() == VideoParams::kVideoTypeStill;
+}
+
+bool ProjectImportTask::CompareStillImageSize(const FootageDescription &footage, const QSize &sz)
+{
+  if (!ItemIsStillImageFootageOnly(footage)) {
+    return false;
+  }
+
+  const VideoParams& stream = footage.GetVideoStreams().first();
+
+  return stream.width() == sz.width() && stream.height() == sz.height();
+}
+
 }
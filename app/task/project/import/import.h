@@ -22,14 +22,26 @@
 #define PROJECTIMPORTMANAGER_H
 
 #include <QFileInfoList>
+#include <QFuture>
+#include <QHash>
+#include <QSet>
+#include <QThreadPool>
 #include <QUndoCommand>
 
 #include "codec/decoder.h"
+#include "node/project/footage/footagedescription.h"
 #include "node/project/projectviewmodel.h"
 #include "task/task.h"
 
 namespace olive {
 
+/**
+ * @brief Imports files and folders into a project folder
+ *
+ * Files are probed concurrently on a thread pool ahead of the import itself, which then adds them
+ * to the project in the order they were listed. Image sequences are found from one listing of
+ * each directory rather than by probing every frame.
+ */
 class ProjectImportTask : public Task
 {
   Q_OBJECT
@@ -63,11 +75,37 @@ private:
 
   void AddItemToFolder(Folder* folder, Node* item, MultiUndoCommand* command);
 
-  static bool ItemIsStillImageFootageOnly(Footage *footage);
+  /**
+   * @brief Start probing these files (and the contents of these folders) in the background
+   *
+   * Of each possible image sequence, only the first file found and a neighbor are probed since
+   * that's all ValidateImageSequence() needs. The rest are probed only if it isn't a sequence.
+   */
+  void QueueProbes(const QFileInfoList& list);
 
-  static bool CompareStillImageSize(Footage *footage, const QSize& sz);
+  void QueueProbe(const QString& filename);
 
-  static int64_t GetImageSequenceLimit(const QString &start_fn, int64_t start, bool up);
+  /**
+   * @brief Wait for a file's probe, starting it first if it wasn't queued
+   */
+  FootageDescription GetProbe(const QString& filename);
+
+  /**
+   * @brief Find the run of consecutively numbered files around this one
+   *
+   * Returns false if the filename doesn't end in a number or no adjacent numbers exist.
+   */
+  bool GetImageSequenceRange(const QString& filename, int64_t* start, int64_t* end);
+
+  int64_t GetImageSequenceLimit(const QString &start_fn, int64_t start, bool up);
+
+  const QSet<QString>& GetDirectoryFileNames(const QString& path);
+
+  static QFileInfoList GetDirectoryEntries(const QString& path);
+
+  static bool ItemIsStillImageFootageOnly(const FootageDescription& footage);
+
+  static bool CompareStillImageSize(const FootageDescription& footage, const QSize& sz);
 
   MultiUndoCommand* command_;
 
@@ -81,7 +119,17 @@ private:
 
   QStringList invalid_files_;
 
-  QList<QString> image_sequence_ignore_files_;
+  QSet<QString> image_sequence_ignore_files_;
+
+  QThreadPool probe_pool_;
+
+  QHash<QString, QFuture<FootageDescription> > probes_;
+
+  /// Files belonging to possible image sequences, which aren't probed up front
+  QSet<QString> sequence_files_;
+
+  /// Names of the files in each directory we've looked for image sequences in
+  QHash<QString, QSet<QString> > directory_files_;
 
 };
 
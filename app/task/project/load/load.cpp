@@ -21,6 +21,9 @@
 #include "load.h"
 
 #include <QApplication>
+#include <QBuffer>
+#include <QDataStream>
+#include <QDir>
 #include <QFile>
 #include <QXmlStreamReader>
 
@@ -36,6 +39,11 @@ ProjectLoadTask::ProjectLoadTask(const QString &filename) :
 
 bool ProjectLoadTask::Run()
 {
+  // Binary projects are recognized by their contents rather than the extension
+  if (ProjectContainer::IsContainerFile(GetFilename())) {
+    return LoadBinary();
+  }
+
   QFile project_file(GetFilename());
 
   if (project_file.open(QFile::ReadOnly | QFile::Text)) {
@@ -54,13 +62,7 @@ bool ProjectLoadTask::Run()
             if (!ok) {
               SetError(tr("Failed to parse project version."));
               return false;
-            } else if (project_version > Core::kProjectVersion) {
-              // Project is newer than we support
-              SetError(tr("This project is newer than this version of Olive and cannot be opened."));
-              return false;
-            } else if (project_version < 210122) { // Change this if we drop support for a project version
-              // Project is older than we support
-              SetError(tr("This project is from a version of Olive that is no longer supported in this version."));
+            } else if (!CheckProjectVersion(project_version)) {
               return false;
             }
           } else if (reader.name() == QStringLiteral("url")) {
@@ -112,4 +114,110 @@ bool ProjectLoadTask::Run()
   }
 }
 
+bool ProjectLoadTask::LoadBinary()
+{
+  QFile project_file(GetFilename());
+
+  if (!project_file.open(QFile::ReadOnly)) {
+    SetError(tr("Failed to read file \"%1\" for reading.").arg(GetFilename()));
+    return false;
+  }
+
+  ProjectContainer::Reader reader(&project_file);
+
+  if (!reader.Open()) {
+    SetError(tr("Failed to read project data."));
+    return false;
+  }
+
+  if (!CheckProjectVersion(reader.project_version())) {
+    return false;
+  }
+
+  int info_chunk = reader.FindChunk(ProjectContainer::kChunkInfo);
+  if (info_chunk >= 0) {
+    QByteArray info = reader.ReadChunk(info_chunk);
+    QDataStream stream(info);
+    stream >> project_saved_url_;
+  }
+
+  QByteArray merged;
+  QBuffer merged_buffer(&merged);
+  ProjectContainer::Reader merged_reader(&merged_buffer);
+  ProjectContainer::Reader* project_reader = &reader;
+
+  int base_chunk = reader.FindChunk(ProjectContainer::kChunkBase);
+  if (base_chunk >= 0) {
+    // This is an auto-recovery delta, which only holds what changed since a full checkpoint
+    if (!ApplyDelta(&reader, base_chunk, &merged_buffer) || !merged_reader.Open()) {
+      SetError(tr("Failed to read the project this recovery is based on."));
+      return false;
+    }
+
+    project_reader = &merged_reader;
+  }
+
+  project_ = new Project();
+
+  project_->set_filename(GetFilename());
+
+  project_->Load(project_reader, &layout_info_, reader.project_version(), &IsCancelled());
+
+  // Ensure project is in main thread
+  project_->moveToThread(qApp->thread());
+
+  project_file.close();
+
+  emit ProgressChanged(1);
+
+  return true;
+}
+
+bool ProjectLoadTask::ApplyDelta(ProjectContainer::Reader *delta, int base_chunk, QBuffer *output)
+{
+  QString base_filename;
+  {
+    QByteArray data = delta->ReadChunk(base_chunk);
+    QDataStream stream(data);
+    stream >> base_filename;
+  }
+
+  QFile base_file(QFileInfo(GetFilename()).dir().filePath(base_filename));
+
+  if (!base_file.open(QFile::ReadOnly)) {
+    return false;
+  }
+
+  ProjectContainer::Reader base(&base_file);
+
+  if (!base.Open() || !output->open(QBuffer::WriteOnly)) {
+    return false;
+  }
+
+  ProjectContainer::Writer writer(output);
+
+  bool success = writer.Start(delta->project_version())
+      && ProjectContainer::ApplyDelta(&base, delta, &writer)
+      && writer.Finish();
+
+  output->close();
+
+  return success && output->open(QBuffer::ReadOnly);
+}
+
+bool ProjectLoadTask::CheckProjectVersion(uint project_version)
+{
+  if (project_version > Core::kProjectVersion) {
+    // Project is newer than we support
+    SetError(tr("This project is newer than this version of Olive and cannot be opened."));
+    return false;
+  } else if (project_version < 210122) { // Change this if we drop support for a project version
+    // Project is older than we support
+    SetError(tr("This project is from a version of Olive that is no longer supported in this version."));
+    return false;
+  }
+
+  return true;
+}
+
 }
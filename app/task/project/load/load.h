@@ -21,6 +21,8 @@
 #ifndef PROJECTLOADMANAGER_H
 #define PROJECTLOADMANAGER_H
 
+#include <QBuffer>
+
 #include "loadbasetask.h"
 #include "window/mainwindow/mainwindowlayoutinfo.h"
 
@@ -35,6 +37,16 @@ public:
 protected:
   virtual bool Run() override;
 
+private:
+  bool LoadBinary();
+
+  /**
+   * @brief Combine an auto-recovery delta with the checkpoint it's based on into `output`
+   */
+  bool ApplyDelta(ProjectContainer::Reader* delta, int base_chunk, QBuffer* output);
+
+  bool CheckProjectVersion(uint project_version);
+
 };
 
 }
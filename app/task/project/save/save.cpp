@@ -20,6 +20,7 @@
 
 #include "save.h"
 
+#include <QDataStream>
 #include <QDir>
 #include <QFile>
 #include <QXmlStreamWriter>
@@ -42,6 +43,10 @@ bool ProjectSaveTask::Run()
   // File to temporarily save to (ensures we can't half-write the user's main file and crash)
   QString temp_save = FileFunctions::GetSafeTemporaryFilename(using_filename);
 
+  if (using_filename.endsWith(QStringLiteral(".ovb"), Qt::CaseInsensitive)) {
+    return SaveBinary(using_filename, temp_save);
+  }
+
   QFile project_file(temp_save);
 
   if (project_file.open(QFile::WriteOnly | QFile::Text)) {
@@ -89,4 +94,43 @@ bool ProjectSaveTask::Run()
   }
 }
 
+bool ProjectSaveTask::SaveBinary(const QString &using_filename, const QString &temp_save)
+{
+  QFile project_file(temp_save);
+
+  if (!project_file.open(QFile::WriteOnly)) {
+    SetError(tr("Failed to open temporary file \"%1\" for writing.").arg(temp_save));
+    return false;
+  }
+
+  ProjectContainer::Writer writer(&project_file);
+
+  QByteArray info;
+  {
+    QDataStream stream(&info, QIODevice::WriteOnly);
+    stream << using_filename;
+  }
+
+  bool success = writer.Start(Core::kProjectVersion)
+      && writer.AddChunk(ProjectContainer::kChunkInfo, info)
+      && project_->Save(&writer)
+      && writer.Finish();
+
+  project_file.close();
+
+  if (!success) {
+    SetError(tr("Failed to write project data"));
+    return false;
+  }
+
+  // Save was successful, we can now rewrite the original file
+  if (FileFunctions::RenameFileAllowOverwrite(temp_save, using_filename)) {
+    return true;
+  } else {
+    SetError(tr("Failed to overwrite \"%1\". Project has been saved as \"%2\" instead.")
+             .arg(using_filename, temp_save));
+    return false;
+  }
+}
+
 }
@@ -46,6 +46,11 @@ protected:
   virtual bool Run() override;
 
 private:
+  /**
+   * @brief Save as a binary project, used for filenames ending in ".ovb"
+   */
+  bool SaveBinary(const QString& using_filename, const QString& temp_save);
+
   Project* project_;
 
   QString override_filename_;
@@ -25,6 +25,9 @@
 
 namespace olive {
 
+const int RenderTask::kMaximumBatchFrames = 8;
+const int RenderTask::kMaximumBatchBytes = 32 * 1024 * 1024;
+
 RenderTask::RenderTask(ViewerOutput *viewer, const VideoParams &vparams, const AudioParams &aparams) :
   viewer_(viewer),
   video_params_(vparams),
@@ -115,21 +118,52 @@ bool RenderTask::Render(ColorManager* manager,
     total_length += video_frame_sz * time_map.size();
   }
 
-  // Start a render of a limited amount, and then render one frame for each frame that gets
+  // Frames are rendered in batches so that cheap frames (titles, low resolution proxies, etc.)
+  // don't spend most of their time in per-ticket overhead. Batches are limited by memory, so
+  // large frames still get a ticket each.
+  int frame_width = force_size.isNull() ? video_params().effective_width() : force_size.width();
+  int frame_height = force_size.isNull() ? video_params().effective_height() : force_size.height();
+  VideoParams::Format frame_format = (force_format == VideoParams::kFormatInvalid) ? video_params().format() : force_format;
+  int frame_bytes = qMax(1, VideoParams::GetBufferSize(frame_width, frame_height, frame_format, VideoParams::kRGBAChannelCount));
+  const int batch_size = qBound(1, kMaximumBatchBytes / frame_bytes, kMaximumBatchFrames);
+
+  // Start a render of a limited amount, and then render one batch for each batch that gets
   // finished. This prevents rendered frames from stacking up in memory indefinitely while the
   // encoder is processing them. The amount is kind of arbitrary, but we use the thread count so
   // each of the system's threads are utilized as memory allows.
-  const int maximum_rendered_frames = QThread::idealThreadCount();
-  auto frame_iterator = frame_render_order.cbegin();
+  const int maximum_rendered_batches = QThread::idealThreadCount();
+  int frame_index = 0;
 
-  for (int i=0; i<maximum_rendered_frames && frame_iterator!=frame_render_order.cend(); i++, frame_iterator++) {
-    StartTicket(frame_iterator->second, &watcher_thread, manager, frame_iterator->first,
-                mode, cache, force_size, force_matrix, force_format, force_color_output);
+  for (int i=0; i<maximum_rendered_batches && frame_index<frame_render_order.size(); i++) {
+    StartBatch(frame_render_order.mid(frame_index, batch_size), &watcher_thread, manager,
+               mode, cache, force_size, force_matrix, force_format, force_color_output);
+    frame_index += batch_size;
   }
 
   finished_watcher_mutex_.lock();
 
   while (!IsCancelled()) {
+    while (!finished_frames_.empty() && !IsCancelled()) {
+      QPair<QByteArray, FramePtr> rendered = finished_frames_.front();
+      finished_frames_.pop_front();
+
+      finished_watcher_mutex_.unlock();
+
+      if (TwoStepFrameRendering()) {
+        DownloadFrame(&watcher_thread, rendered.second, rendered.first);
+
+        progress_counter += video_frame_sz * 0.5;
+      } else {
+        FrameDownloaded(rendered.second, rendered.first, time_map.value(rendered.first), job_time);
+
+        progress_counter += video_frame_sz;
+      }
+
+      emit ProgressChanged(progress_counter / total_length);
+
+      finished_watcher_mutex_.lock();
+    }
+
     while (!finished_watchers_.empty() && !IsCancelled()) {
       RenderTicketWatcher* watcher = finished_watchers_.front();
       finished_watchers_.pop_front();
@@ -137,9 +171,9 @@ bool RenderTask::Render(ColorManager* manager,
       finished_watcher_mutex_.unlock();
 
       // Analyze watcher here
-      RenderManager::TicketType ticket_type = watcher->GetTicket()->property("type").value<RenderManager::TicketType>();
+      RenderJob::Type ticket_type = watcher->GetTicket()->GetJob()->type();
 
-      if (ticket_type == RenderManager::kTypeAudio) {
+      if (ticket_type == RenderJob::kTypeAudio) {
 
         TimeRange range = watcher->property("range").value<TimeRange>();
 
@@ -152,36 +186,26 @@ bool RenderTask::Render(ColorManager* manager,
         //progress_counter += range.length().toDouble();
         //emit ProgressChanged(progress_counter / total_length);
 
-      } else if (ticket_type == RenderManager::kTypeVideo && TwoStepFrameRendering()) {
-
-        DownloadFrame(&watcher_thread,
-                      watcher->Get().value<FramePtr>(),
-                      watcher->property("hash").toByteArray());
+      } else if (ticket_type == RenderJob::kTypeVideoBatch) {
 
-        progress_counter += video_frame_sz * 0.5;
-        emit ProgressChanged(progress_counter / total_length);
+        // All of this batch's frames have been queued already, so just start the next one
+        if (frame_index < frame_render_order.size()) {
+          StartBatch(frame_render_order.mid(frame_index, batch_size), &watcher_thread, manager,
+                     mode, cache, force_size, force_matrix, force_format, force_color_output);
+          frame_index += batch_size;
+        }
 
       } else {
 
-        // Assume single-step video or video download ticket
+        // Assume video download ticket
         QByteArray rendered_hash = watcher->property("hash").toByteArray();
         FrameDownloaded(watcher->Get().value<FramePtr>(), rendered_hash, time_map.value(rendered_hash), job_time);
 
-        double progress_to_add = video_frame_sz;
-        if (TwoStepFrameRendering()) {
-          progress_to_add *= 0.5;
-        }
-        progress_counter += progress_to_add;
+        // Downloads are the second half of two-step rendering
+        progress_counter += video_frame_sz * 0.5;
 
         emit ProgressChanged(progress_counter / total_length);
 
-        if (frame_iterator != frame_render_order.cend()) {
-          StartTicket(frame_iterator->second, &watcher_thread, manager, frame_iterator->first,
-                      mode, cache, force_size, force_matrix, force_format, force_color_output);
-
-          frame_iterator++;
-        }
-
       }
 
       delete watcher;
@@ -194,6 +218,11 @@ bool RenderTask::Render(ColorManager* manager,
       break;
     }
 
+    if (!finished_frames_.empty()) {
+      // More frames were delivered while we were handling watchers
+      continue;
+    }
+
     // Run out of finished watchers. If we still have running tickets, wait for the next one to finish.
     if (running_tickets_ > 0) {
       finished_watcher_wait_cond_.wait(&finished_watcher_mutex_);
@@ -209,10 +238,20 @@ bool RenderTask::Render(ColorManager* manager,
     // Cancel every watcher we created
     foreach (RenderTicketWatcher* watcher, running_watchers_) {
       disconnect(watcher, &RenderTicketWatcher::Finished, this, &RenderTask::TicketDone);
-      RenderManager::instance()->RemoveTicket(watcher->GetTicket());
+
+      if (!RenderManager::instance()->RemoveTicket(watcher->GetTicket())
+          && watcher->GetTicket()->GetJob()->type() == RenderJob::kTypeVideoBatch) {
+        // Running batches call back into this task, so they must be done before we return. They
+        // stop at the next frame now that we're cancelled.
+        watcher->GetTicket()->WaitForFinished();
+      }
     }
   }
 
+  finished_watcher_mutex_.lock();
+  finished_frames_.clear();
+  finished_watcher_mutex_.unlock();
+
   watcher_thread.quit();
   watcher_thread.wait();
 
@@ -246,22 +285,41 @@ void RenderTask::IncrementRunningTickets()
   finished_watcher_mutex_.unlock();
 }
 
-void RenderTask::StartTicket(const QByteArray& hash, QThread* watcher_thread, ColorManager* manager,
-                             const rational& time, RenderMode::Mode mode, FrameHashCache* cache,
-                             const QSize &force_size, const QMatrix4x4 &force_matrix,
-                             VideoParams::Format force_format, ColorProcessorPtr force_color_output)
+void RenderTask::StartBatch(const QVector<QPair<rational, QByteArray> > &frames, QThread* watcher_thread,
+                            ColorManager* manager, RenderMode::Mode mode, FrameHashCache* cache,
+                            const QSize &force_size, const QMatrix4x4 &force_matrix,
+                            VideoParams::Format force_format, ColorProcessorPtr force_color_output)
 {
+  QVector<rational> times(frames.size());
+  QVector<QByteArray> hashes(frames.size());
+  for (int i=0; i<frames.size(); i++) {
+    times[i] = frames.at(i).first;
+    hashes[i] = frames.at(i).second;
+  }
+
   RenderTicketWatcher* watcher = new RenderTicketWatcher();
-  watcher->setProperty("hash", hash);
   PrepareWatcher(watcher, watcher_thread);
 
   IncrementRunningTickets();
 
-  watcher->SetTicket(RenderManager::instance()->RenderFrame(viewer_, manager, time,
-                                                            mode, video_params_, audio_params_,
-                                                            force_size, force_matrix,
-                                                            force_format, force_color_output,
-                                                            cache));
+  watcher->SetTicket(RenderManager::instance()->RenderFrameBatch(viewer_, manager, times,
+                                                                 mode, video_params_, audio_params_,
+                                                                 force_size, force_matrix,
+                                                                 force_format, force_color_output,
+                                                                 [this, hashes](int index, FramePtr frame) {
+    return BatchFrameRendered(hashes.at(index), frame);
+  }, cache));
+}
+
+bool RenderTask::BatchFrameRendered(const QByteArray &hash, FramePtr frame)
+{
+  // Called from the render thread, the frame is picked up by the loop in Render()
+  finished_watcher_mutex_.lock();
+  finished_frames_.push_back({hash, frame});
+  finished_watcher_wait_cond_.wakeAll();
+  finished_watcher_mutex_.unlock();
+
+  return !IsCancelled();
 }
 
 void RenderTask::TicketDone(RenderTicketWatcher* watcher)
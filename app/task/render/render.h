@@ -85,7 +85,15 @@ private:
 
   void IncrementRunningTickets();
 
-  void StartTicket(const QByteArray &hash, QThread *watcher_thread, ColorManager *manager, const rational &time, RenderMode::Mode mode, FrameHashCache *cache, const QSize &force_size, const QMatrix4x4 &force_matrix, VideoParams::Format force_format, ColorProcessorPtr force_color_output);
+  void StartBatch(const QVector<QPair<rational, QByteArray> > &frames, QThread *watcher_thread, ColorManager *manager, RenderMode::Mode mode, FrameHashCache *cache, const QSize &force_size, const QMatrix4x4 &force_matrix, VideoParams::Format force_format, ColorProcessorPtr force_color_output);
+
+  bool BatchFrameRendered(const QByteArray& hash, FramePtr frame);
+
+  /**
+   * @brief Upper limits on how many frames are rendered by a single batch ticket
+   */
+  static const int kMaximumBatchFrames;
+  static const int kMaximumBatchBytes;
 
   ViewerOutput* viewer_;
 
@@ -95,6 +103,7 @@ private:
 
   QVector<RenderTicketWatcher*> running_watchers_;
   std::list<RenderTicketWatcher*> finished_watchers_;
+  std::list<QPair<QByteArray, FramePtr> > finished_frames_;
   int running_tickets_;
   QMutex finished_watcher_mutex_;
   QWaitCondition finished_watcher_wait_cond_;
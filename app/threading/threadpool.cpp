@@ -23,8 +23,14 @@
 namespace olive {
 
 ThreadPool::ThreadPool(QThread::Priority priority, int threads, QObject *parent) :
-  QObject(parent)
+  QObject(parent),
+  next_thread_(0),
+  pending_count_(0)
 {
+  clock_.start();
+
+  ResetStatistics();
+
   all_threads_.resize(threads ? threads : QThread::idealThreadCount());
 
   // Create threads
@@ -34,12 +40,6 @@ ThreadPool::ThreadPool(QThread::Priority priority, int threads, QObject *parent)
     // Add to vector of all threads
     all_threads_[i] = t;
 
-    // Append to list of available threads
-    available_threads_.push_back(t);
-
-    // Connect done signal
-    connect(t, &ThreadPoolThread::Done, this, &ThreadPool::ThreadDone);
-
     // Start the thread at the given priority
     t->start(priority);
   }
@@ -49,6 +49,9 @@ ThreadPool::~ThreadPool()
 {
   foreach (ThreadPoolThread* thread, all_threads_) {
     thread->Cancel();
+  }
+
+  foreach (ThreadPoolThread* thread, all_threads_) {
     thread->wait();
     delete thread;
   }
@@ -56,100 +59,166 @@ ThreadPool::~ThreadPool()
 
 bool ThreadPool::RemoveTicket(RenderTicketPtr ticket)
 {
-  auto it = std::find(ticket_queue_.begin(), ticket_queue_.end(), ticket);
-  if (it == ticket_queue_.end()) {
+  // The entry stays in its worker's queue and is skipped when that worker reaches it
+  if (!ticket->CancelFromQueue()) {
     return false;
   }
 
-  ticket_queue_.erase(it);
+  QMutexLocker locker(&stats_mutex_);
+  stats_[ticket->GetPriority()].removed++;
+
   return true;
 }
 
-void ThreadPool::AddTicket(RenderTicketPtr ticket, bool prioritize)
+void ThreadPool::AddTicket(RenderTicketPtr ticket, RenderTicket::Priority priority)
 {
-  if (prioritize) {
-    ticket_queue_.push_front(ticket);
-  } else {
-    ticket_queue_.push_back(ticket);
-  }
+  QueueEntry entry = {ticket, clock_.nsecsElapsed()};
+
+  ticket->SetQueued(priority);
+
+  // Distribute round-robin, idle workers will steal if this worker is busy
+  int index = (next_thread_.fetchAndAddRelaxed(1) & 0x7FFFFFFF) % all_threads_.size();
+  all_threads_.at(index)->Push(entry, priority);
 
-  RunNext();
+  wake_mutex_.lock();
+  pending_count_.fetchAndAddOrdered(1);
+  wake_cond_.wakeOne();
+  wake_mutex_.unlock();
 }
 
-void ThreadPool::RunNext()
+ThreadPool::Statistics ThreadPool::GetStatistics(RenderTicket::Priority priority)
 {
-  while (!ticket_queue_.empty() && !available_threads_.empty()) {
-    // Run function
-    RenderTicketPtr ticket = ticket_queue_.front();
-    ticket_queue_.pop_front();
+  QMutexLocker locker(&stats_mutex_);
 
-    ThreadPoolThread* thread = available_threads_.front();
-    available_threads_.pop_front();
+  return stats_[priority];
+}
 
-    // Move ticket to other thread so event processing can occur there
-    ticket->Start();
-    ticket->moveToThread(thread);
+void ThreadPool::ResetStatistics()
+{
+  QMutexLocker locker(&stats_mutex_);
 
-    // Run the ticket in the thread, which actually just calls our virtual function RunTicket
-    thread->RunTicket(ticket);
+  for (int i=0; i<RenderTicket::kPriorityCount; i++) {
+    stats_[i] = {0, 0, 0, 0};
   }
 }
 
-void ThreadPool::ThreadDone()
+RenderTicketPtr ThreadPool::WaitForNext(ThreadPoolThread *thread)
 {
-  ThreadPoolThread* thread = static_cast<ThreadPoolThread*>(sender());
+  RenderTicketPtr ticket;
 
-  available_threads_.push_back(thread);
+  while (!thread->IsCancelled()) {
+    if (TakeNext(thread, &ticket)) {
+      return ticket;
+    }
 
-  RunNext();
+    wake_mutex_.lock();
+    while (pending_count_.loadAcquire() == 0 && !thread->IsCancelled()) {
+      wake_cond_.wait(&wake_mutex_);
+    }
+    wake_mutex_.unlock();
+  }
+
+  return nullptr;
 }
 
-ThreadPoolThread::ThreadPoolThread(ThreadPool *parent)
+bool ThreadPool::TakeNext(ThreadPoolThread *thread, RenderTicketPtr *ticket)
 {
-  pool_ = parent;
+  QueueEntry entry;
+  RenderTicket::Priority priority;
+
+  while (PopHighestPriority(thread, &entry, &priority)) {
+    pending_count_.fetchAndAddOrdered(-1);
 
-  // Ensures mutex is definitely locked by the time the thread is running
-  mutex_.lock();
+    if (!entry.ticket->ClaimFromQueue()) {
+      // This ticket was removed while it was queued, look for another
+      continue;
+    }
+
+    qint64 wait = clock_.nsecsElapsed() - entry.queued_time;
+
+    stats_mutex_.lock();
+    Statistics& s = stats_[priority];
+    s.started++;
+    s.total_wait += wait;
+    s.max_wait = qMax(s.max_wait, wait);
+    stats_mutex_.unlock();
+
+    *ticket = entry.ticket;
+    return true;
+  }
+
+  return false;
 }
 
-ThreadPoolThread::~ThreadPoolThread()
+bool ThreadPool::PopHighestPriority(ThreadPoolThread *thread, QueueEntry *entry, RenderTicket::Priority *priority)
 {
-  mutex_.unlock();
+  for (int i=0; i<RenderTicket::kPriorityCount; i++) {
+    RenderTicket::Priority p = static_cast<RenderTicket::Priority>(i);
+
+    // Check our own queue first, then try to steal from the others
+    bool found = thread->Pop(entry, p);
+
+    for (int j=0; !found && j<all_threads_.size(); j++) {
+      ThreadPoolThread* other = all_threads_.at(j);
+
+      if (other != thread) {
+        found = other->Pop(entry, p);
+      }
+    }
+
+    if (found) {
+      *priority = p;
+      return true;
+    }
+  }
+
+  return false;
 }
 
-void ThreadPoolThread::RunTicket(RenderTicketPtr ticket)
+ThreadPoolThread::ThreadPoolThread(ThreadPool *parent)
 {
-  mutex_.lock();
-  ticket_ = ticket;
-  wait_cond_.wakeAll();
-  mutex_.unlock();
+  pool_ = parent;
 }
 
 void ThreadPoolThread::run()
 {
-  while (true) {
-    wait_cond_.wait(&mutex_);
+  RenderTicketPtr ticket;
 
-    if (ticket_) {
-      pool_->RunTicket(ticket_);
+  // Tickets come back already marked as running, see RenderTicket::ClaimFromQueue()
+  while ((ticket = pool_->WaitForNext(this))) {
+    pool_->RunTicket(ticket);
+  }
+}
 
-      // Move back to calling thread (hacky?)
-      ticket_->moveToThread(this->thread());
+void ThreadPoolThread::CancelEvent()
+{
+  // Wake every thread, the others will re-check their own cancelled state and sleep again
+  pool_->wake_mutex_.lock();
+  pool_->wake_cond_.wakeAll();
+  pool_->wake_mutex_.unlock();
+}
 
-      ticket_ = nullptr;
-    }
+void ThreadPoolThread::Push(const ThreadPool::QueueEntry &entry, RenderTicket::Priority priority)
+{
+  QMutexLocker locker(&queue_mutex_);
 
-    if (IsCancelled()) {
-      break;
-    } else {
-      emit Done();
-    }
-  }
+  queues_[priority].push_back(entry);
 }
 
-void ThreadPoolThread::CancelEvent()
+bool ThreadPoolThread::Pop(ThreadPool::QueueEntry *entry, RenderTicket::Priority priority)
 {
-  wait_cond_.wakeAll();
+  QMutexLocker locker(&queue_mutex_);
+
+  std::deque<ThreadPool::QueueEntry>& queue = queues_[priority];
+
+  if (queue.empty()) {
+    return false;
+  }
+
+  *entry = queue.front();
+  queue.pop_front();
+
+  return true;
 }
 
 }
@@ -21,6 +21,8 @@
 #ifndef THREADPOOL_H
 #define THREADPOOL_H
 
+#include <deque>
+#include <QElapsedTimer>
 #include <QThread>
 
 #include "common/cancelableobject.h"
@@ -30,6 +32,20 @@ namespace olive {
 
 class ThreadPoolThread;
 
+/**
+ * @brief Priority-aware pool of worker threads that run RenderTickets
+ *
+ * Each worker owns one FIFO per RenderTicket::Priority. Tickets are distributed round-robin
+ * between workers, and a worker that runs out of work steals from the others. Workers always look
+ * for the highest priority ticket available (their own queue first, then the other workers') before
+ * considering a lower priority, so an interactive frame never waits behind background caching.
+ *
+ * Order is only FIFO within one worker's queue. Tickets of the same priority that were queued on
+ * different workers, or stolen, may start in any order.
+ *
+ * Workers pull tickets themselves so no event loop is involved in scheduling, and all public
+ * functions are thread-safe.
+ */
 class ThreadPool : public QObject
 {
   Q_OBJECT
@@ -38,26 +54,73 @@ public:
 
   virtual ~ThreadPool() override;
 
-  RenderTicketPtr Queue();
-
   virtual void RunTicket(RenderTicketPtr ticket) const = 0;
 
+  /**
+   * @brief Queue a ticket to be run by a worker thread
+   */
+  void AddTicket(RenderTicketPtr ticket, RenderTicket::Priority priority = RenderTicket::kPriorityBackground);
+
+  /**
+   * @brief Remove a ticket from the queue in constant time
+   *
+   * Returns false if the ticket isn't queued, e.g. if it's already running.
+   */
   bool RemoveTicket(RenderTicketPtr ticket);
 
-public slots:
-  void AddTicket(olive::RenderTicketPtr ticket, bool prioritize = false);
+  struct Statistics {
+    /// Number of tickets started
+    qint64 started;
+
+    /// Number of tickets removed before they started
+    qint64 removed;
+
+    /// Total and longest time tickets spent in the queue, in nanoseconds
+    qint64 total_wait;
+    qint64 max_wait;
+  };
+
+  /**
+   * @brief Retrieve queue latency statistics for a priority class
+   */
+  Statistics GetStatistics(RenderTicket::Priority priority);
+
+  void ResetStatistics();
 
 private:
-  void RunNext();
+  friend class ThreadPoolThread;
+
+  struct QueueEntry {
+    RenderTicketPtr ticket;
+    qint64 queued_time;
+  };
+
+  /**
+   * @brief Retrieve the next ticket for a worker, blocking until one is available
+   *
+   * Returns nullptr if the worker has been cancelled.
+   */
+  RenderTicketPtr WaitForNext(ThreadPoolThread* thread);
+
+  bool TakeNext(ThreadPoolThread* thread, RenderTicketPtr* ticket);
+
+  bool PopHighestPriority(ThreadPoolThread* thread, QueueEntry* entry, RenderTicket::Priority* priority);
 
   QVector<ThreadPoolThread*> all_threads_;
 
-  std::list<ThreadPoolThread*> available_threads_;
+  QAtomicInt next_thread_;
+
+  QMutex wake_mutex_;
 
-  std::list<RenderTicketPtr> ticket_queue_;
+  QWaitCondition wake_cond_;
 
-private slots:
-  void ThreadDone();
+  QAtomicInt pending_count_;
+
+  QElapsedTimer clock_;
+
+  QMutex stats_mutex_;
+
+  Statistics stats_[RenderTicket::kPriorityCount];
 
 };
 
@@ -67,26 +130,23 @@ class ThreadPoolThread : public QThread, public CancelableObject
 public:
   ThreadPoolThread(ThreadPool* parent);
 
-  virtual ~ThreadPoolThread() override;
-
-  void RunTicket(RenderTicketPtr ticket);
-
 protected:
   virtual void run() override;
 
   virtual void CancelEvent() override;
 
-signals:
-  void Done();
-
 private:
-  ThreadPool* pool_;
+  friend class ThreadPool;
+
+  void Push(const ThreadPool::QueueEntry& entry, RenderTicket::Priority priority);
 
-  RenderTicketPtr ticket_;
+  bool Pop(ThreadPool::QueueEntry* entry, RenderTicket::Priority priority);
+
+  ThreadPool* pool_;
 
-  QMutex mutex_;
+  QMutex queue_mutex_;
 
-  QWaitCondition wait_cond_;
+  std::deque<ThreadPool::QueueEntry> queues_[RenderTicket::kPriorityCount];
 
 };
 
@@ -25,7 +25,9 @@ namespace olive {
 RenderTicket::RenderTicket() :
   is_running_(false),
   has_result_(false),
-  finish_count_(0)
+  finish_count_(0),
+  queue_state_(kQueueStateNone),
+  priority_(kPriorityBackground)
 {
   SetJobTime();
 }
@@ -46,6 +48,21 @@ void RenderTicket::Start()
   result_.clear();
 }
 
+bool RenderTicket::ClaimFromQueue()
+{
+  QMutexLocker locker(&lock_);
+
+  if (!queue_state_.testAndSetOrdered(kQueueStateQueued, kQueueStateNone)) {
+    return false;
+  }
+
+  is_running_ = true;
+  has_result_ = false;
+  result_.clear();
+
+  return true;
+}
+
 void RenderTicket::Finish()
 {
   FinishInternal(false, QVariant());
@@ -21,6 +21,8 @@
 #ifndef RENDERTICKET_H
 #define RENDERTICKET_H
 
+#include <memory>
+#include <QAtomicInt>
 #include <QDateTime>
 #include <QMutex>
 #include <QWaitCondition>
@@ -32,12 +34,64 @@
 
 namespace olive {
 
+class RenderJob;
+
 class RenderTicket : public QObject
 {
   Q_OBJECT
 public:
   RenderTicket();
 
+  /**
+   * @brief Scheduling class of a ticket, in order of precedence
+   */
+  enum Priority {
+    /// Frames the user is waiting on right now (e.g. seeking)
+    kPriorityInteractive,
+
+    /// Frames queued ahead of the playhead during playback
+    kPriorityPlayback,
+
+    /// Audio chunks
+    kPriorityAudio,
+
+    /// Background caching, downloads and exports
+    kPriorityBackground,
+
+    kPriorityCount
+  };
+
+  /**
+   * @brief Immutable description of the work this ticket represents
+   *
+   * Set once before the ticket is queued. Use RenderJob::type() to determine which RenderJob
+   * subclass it is.
+   */
+  const std::shared_ptr<const RenderJob>& GetJob() const
+  {
+    return job_;
+  }
+
+  void SetJob(const std::shared_ptr<const RenderJob>& job)
+  {
+    job_ = job;
+  }
+
+  /**
+   * @brief Keep some data alive for as long as this ticket exists
+   *
+   * Used to pin the graph snapshot that a ticket renders from.
+   */
+  const std::shared_ptr<void>& GetPinnedData() const
+  {
+    return pinned_data_;
+  }
+
+  void SetPinnedData(const std::shared_ptr<void>& data)
+  {
+    pinned_data_ = data;
+  }
+
   qint64 GetJobTime() const
   {
     return job_time_;
@@ -95,6 +149,43 @@ public:
     return &lock_;
   }
 
+  /**
+   * @brief Mark this ticket as waiting in a queue with the given priority
+   */
+  void SetQueued(Priority priority)
+  {
+    priority_ = priority;
+    queue_state_ = kQueueStateQueued;
+  }
+
+  Priority GetPriority() const
+  {
+    return priority_;
+  }
+
+  /**
+   * @brief Atomically claim this ticket from its queue and mark it as running
+   *
+   * Claiming and starting happen under the ticket's lock so there is no moment where the ticket is
+   * neither queued nor running. Returns false if the ticket was removed from the queue (or already
+   * claimed) in the meantime.
+   */
+  bool ClaimFromQueue();
+
+  /**
+   * @brief Atomically remove this ticket from its queue
+   *
+   * Returns false if the ticket wasn't queued, e.g. because a thread has already claimed it. Since
+   * claiming marks the ticket running under its lock, WaitForFinished() is reliable afterwards. The
+   * queue entry itself is discarded lazily when a thread reaches it.
+   *
+   * Doesn't lock the ticket, so it may be called while holding lock().
+   */
+  bool CancelFromQueue()
+  {
+    return queue_state_.testAndSetOrdered(kQueueStateQueued, kQueueStateCancelled);
+  }
+
   /**
    * @brief Signal to the ticket that it is running
    *
@@ -125,6 +216,10 @@ signals:
 private:
   void FinishInternal(bool has_result, QVariant result);
 
+  std::shared_ptr<const RenderJob> job_;
+
+  std::shared_ptr<void> pinned_data_;
+
   bool is_running_;
 
   QVariant result_;
@@ -139,6 +234,16 @@ private:
 
   qint64 job_time_;
 
+  enum QueueState {
+    kQueueStateNone,
+    kQueueStateQueued,
+    kQueueStateCancelled
+  };
+
+  QAtomicInt queue_state_;
+
+  Priority priority_;
+
 };
 
 using RenderTicketPtr = std::shared_ptr<RenderTicket>;
@@ -146,5 +251,6 @@ using RenderTicketPtr = std::shared_ptr<RenderTicket>;
 }
 
 Q_DECLARE_METATYPE(olive::RenderTicketPtr)
+Q_DECLARE_METATYPE(olive::RenderTicket::Priority)
 
 #endif // RENDERTICKET_H
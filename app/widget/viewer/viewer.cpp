@@ -499,7 +499,7 @@ void ViewerWidget::UpdateTextureFromNode()
 
     if (playback_queue_.empty()) {
       int queue = DeterminePlaybackQueueSize();
-      playback_queue_next_frame_ = GetTimestamp() + playback_speed_;
+      playback_queue_next_frame_ = TickTime(GetTimestamp() + playback_speed_, timebase());
       for (int i=active_queue_jobs_; i<queue; i++) {
         RequestNextFrameForQueue();
       }
@@ -556,7 +556,7 @@ void ViewerWidget::UpdateTextureFromNode()
       RenderTicketWatcher* watcher = new RenderTicketWatcher();
       connect(watcher, &RenderTicketWatcher::Finished, this, &ViewerWidget::RendererGeneratedFrame);
       nonqueue_watchers_.append(watcher);
-      watcher->SetTicket(GetFrame(time, true));
+      watcher->SetTicket(GetFrame(time, RenderTicket::kPriorityInteractive));
     }
   } else {
     // There is definitely no frame here, we can immediately flip to showing nothing
@@ -600,7 +600,7 @@ void ViewerWidget::PlayInternal(int speed, bool in_to_out_only)
   playback_speed_ = speed;
   play_in_to_out_only_ = in_to_out_only;
 
-  playback_queue_next_frame_ = ruler()->GetTime();
+  playback_queue_next_frame_ = TickTime(ruler()->GetTime(), timebase());
 
   controls_->ShowPauseButton();
 
@@ -611,18 +611,12 @@ void ViewerWidget::PlayInternal(int speed, bool in_to_out_only)
     if (prequeue_length_ > 0) {
       prequeuing_ = true;
 
-      // We "prioritize" the frames, which means they're pushed to the top of the render queue,
-      // we queue in reverse so that they're still queued in order
-
-      playback_queue_next_frame_ += playback_speed_ * prequeue_length_;
-      int64_t temp = playback_queue_next_frame_;
-
+      // Playback frames are queued in their own priority class, ahead of any background caching,
+      // and run in the order they're queued
       for (int i=0; i<prequeue_length_; i++) {
-        playback_queue_next_frame_ -= playback_speed_;
-        RequestNextFrameForQueue(true, false);
+        RequestNextFrameForQueue(false);
+        playback_queue_next_frame_ += playback_speed_;
       }
-
-      playback_queue_next_frame_ = temp;
     }
   }
 
@@ -738,10 +732,9 @@ void ViewerWidget::SetDisplayImage(FramePtr frame, bool main_only)
   emit LoadedBuffer(frame.get());
 }
 
-void ViewerWidget::RequestNextFrameForQueue(bool prioritize, bool increment)
+void ViewerWidget::RequestNextFrameForQueue(bool increment)
 {
-  rational next_time = Timecode::timestamp_to_time(playback_queue_next_frame_,
-                                                   timebase());
+  rational next_time = playback_queue_next_frame_.toRational();
 
   if (FrameExistsAtTime(next_time) || ViewerMightBeAStill()) {
     if (increment) {
@@ -750,12 +743,12 @@ void ViewerWidget::RequestNextFrameForQueue(bool prioritize, bool increment)
 
     RenderTicketWatcher* watcher = new RenderTicketWatcher();
     connect(watcher, &RenderTicketWatcher::Finished, this, &ViewerWidget::RendererGeneratedFrameForQueue);
-    watcher->SetTicket(GetFrame(next_time, prioritize));
+    watcher->SetTicket(GetFrame(next_time, RenderTicket::kPriorityPlayback));
     active_queue_jobs_++;
   }
 }
 
-RenderTicketPtr ViewerWidget::GetFrame(const rational &t, bool prioritize)
+RenderTicketPtr ViewerWidget::GetFrame(const rational &t, RenderTicket::Priority priority)
 {
   QByteArray cached_hash = GetConnectedNode()->video_frame_cache()->GetHash(t);
 
@@ -763,7 +756,7 @@ RenderTicketPtr ViewerWidget::GetFrame(const rational &t, bool prioritize)
 
   if (cached_hash.isEmpty() || !QFileInfo::exists(cache_fn)) {
     // Frame hasn't been cached, start render job
-    return auto_cacher_.GetSingleFrame(t, prioritize);
+    return auto_cacher_.GetSingleFrame(t, priority);
   } else {
     // Frame has been cached, grab the frame
     RenderTicketPtr ticket = std::make_shared<RenderTicket>();
@@ -30,6 +30,7 @@
 
 #include "audiowaveformview.h"
 #include "common/rational.h"
+#include "common/ticktime.h"
 #include "node/output/viewer/viewer.h"
 #include "panel/scope/scope.h"
 #include "render/previewautocacher.h"
@@ -187,9 +188,9 @@ private:
 
   void SetDisplayImage(FramePtr frame, bool main_only = false);
 
-  void RequestNextFrameForQueue(bool prioritize = false, bool increment = true);
+  void RequestNextFrameForQueue(bool increment = true);
 
-  RenderTicketPtr GetFrame(const rational& t, bool prioritize);
+  RenderTicketPtr GetFrame(const rational& t, RenderTicket::Priority priority);
 
   void FinishPlayPreprocess();
 
@@ -237,7 +238,7 @@ private:
   QTimer playback_backup_timer_;
 
   ViewerQueue playback_queue_;
-  int64_t playback_queue_next_frame_;
+  TickTime playback_queue_next_frame_;
 
   bool prequeuing_;
 
@@ -0,0 +1,101 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef COUNTINGRENDERER_H
+#define COUNTINGRENDERER_H
+
+#include <QAtomicInt>
+#include <QThread>
+
+#include "render/renderer.h"
+
+namespace olive {
+
+/**
+ * @brief Renderer with no backend that counts the textures and shaders it's asked to manage
+ *
+ * Native handles are just increasing integers. Compiling a shader sleeps for `compile_time` ms
+ * so tests can make other threads ask for a shader while it's still compiling.
+ */
+class CountingRenderer : public Renderer
+{
+public:
+  CountingRenderer(unsigned long compile_time = 0) :
+    compile_time_(compile_time)
+  {
+  }
+
+  virtual bool Init() override {return true;}
+  virtual void PostDestroy() override {}
+  virtual void PostInit() override {}
+  virtual void DestroyInternal() override {}
+  virtual void ClearDestination(double, double, double, double) override {}
+  virtual void UploadToTexture(Texture*, const void*, int) override {}
+  virtual void DownloadFromTexture(Texture*, void*, int) override {}
+  virtual void FinishPendingCommands() override {}
+  virtual QVariant StartDownloadFromTexture(Texture*, int) override {return QVariant();}
+  virtual bool WaitForDownload(QVariant, qint64) override {return true;}
+  virtual void FinishDownload(QVariant, void*) override {}
+
+  virtual QVariant CreateNativeTexture2D(int, int, VideoParams::Format, int, const void*, int) override
+  {
+    return textures_created.fetchAndAddOrdered(1) + 1;
+  }
+
+  virtual QVariant CreateNativeTexture3D(int, int, int, VideoParams::Format, int, const void*, int) override
+  {
+    return textures_created.fetchAndAddOrdered(1) + 1;
+  }
+
+  virtual void DestroyNativeTexture(QVariant) override
+  {
+    textures_destroyed.fetchAndAddOrdered(1);
+  }
+
+  virtual QVariant CreateNativeShader(ShaderCode) override
+  {
+    if (compile_time_) {
+      QThread::msleep(compile_time_);
+    }
+
+    return shaders_compiled.fetchAndAddOrdered(1) + 1;
+  }
+
+  virtual void DestroyNativeShader(QVariant) override
+  {
+    shaders_destroyed.fetchAndAddOrdered(1);
+  }
+
+  QAtomicInt textures_created;
+  QAtomicInt textures_destroyed;
+  QAtomicInt shaders_compiled;
+  QAtomicInt shaders_destroyed;
+
+protected:
+  virtual void Blit(QVariant, ShaderJob, Texture*, VideoParams, bool) override {}
+
+private:
+  unsigned long compile_time_;
+
+};
+
+}
+
+#endif // COUNTINGRENDERER_H
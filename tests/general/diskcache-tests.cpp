@@ -0,0 +1,123 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "testutil.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+#include "render/diskmanager.h"
+
+namespace olive {
+
+static QString CreateCacheFile(const QTemporaryDir& dir, const QString& name)
+{
+  QString filename = dir.filePath(name);
+
+  QFile f(filename);
+  if (f.open(QFile::WriteOnly)) {
+    f.write(QByteArray(100, 'x'));
+    f.close();
+  }
+
+  return filename;
+}
+
+OLIVE_ADD_TEST(DiskCacheEvictsLeastRecent)
+{
+  QTemporaryDir dir;
+  QList<QByteArray> deleted;
+
+  DiskCacheFolder folder(dir.filePath(QStringLiteral("cache")));
+  QObject::connect(&folder, &DiskCacheFolder::DeletedFrame, [&deleted](const QString&, const QByteArray& hash){
+    deleted.append(hash);
+  });
+
+  // Room for three files
+  folder.SetLimit(300);
+
+  folder.CreatedFile(CreateCacheFile(dir, QStringLiteral("a")), QByteArray("a"));
+  folder.CreatedFile(CreateCacheFile(dir, QStringLiteral("b")), QByteArray("b"));
+  folder.CreatedFile(CreateCacheFile(dir, QStringLiteral("c")), QByteArray("c"));
+  OLIVE_ASSERT(deleted.isEmpty());
+
+  // Accessing `a` makes `b` the least recently used
+  folder.Accessed(QByteArray("a"));
+  folder.CreatedFile(CreateCacheFile(dir, QStringLiteral("d")), QByteArray("d"));
+
+  OLIVE_ASSERT(deleted == QList<QByteArray>({QByteArray("b")}));
+  OLIVE_ASSERT(!QFileInfo::exists(dir.filePath(QStringLiteral("b"))));
+
+  // Re-creating an existing entry replaces it rather than counting it twice
+  folder.CreatedFile(CreateCacheFile(dir, QStringLiteral("c")), QByteArray("c"));
+  OLIVE_ASSERT(deleted.size() == 1);
+
+  OLIVE_TEST_END;
+}
+
+OLIVE_ADD_TEST(DiskCacheJournalReplay)
+{
+  QTemporaryDir dir;
+  QString journal_copy = dir.filePath(QStringLiteral("replay/index.journal"));
+
+  {
+    DiskCacheFolder folder(dir.filePath(QStringLiteral("original")));
+
+    folder.SetLimit(1000);
+    folder.CreatedFile(CreateCacheFile(dir, QStringLiteral("a")), QByteArray("a"));
+    folder.CreatedFile(CreateCacheFile(dir, QStringLiteral("b")), QByteArray("b"));
+    folder.CreatedFile(CreateCacheFile(dir, QStringLiteral("c")), QByteArray("c"));
+    folder.Accessed(QByteArray("a"));
+
+    // Append the changes to the journal like the save timer would
+    QMetaObject::invokeMethod(&folder, "SaveDiskCacheIndex");
+
+    // Take the journal as it would be left by a crash, before the folder compacts it on close
+    QDir().mkpath(dir.filePath(QStringLiteral("replay")));
+    OLIVE_ASSERT(QFile::copy(dir.filePath(QStringLiteral("original/index.journal")), journal_copy));
+  }
+
+  // A record cut short mid-write is ignored
+  QFile journal(journal_copy);
+  OLIVE_ASSERT(journal.open(QFile::WriteOnly | QFile::Append));
+  journal.write("\x01", 1);
+  journal.close();
+
+  QList<QByteArray> deleted;
+
+  DiskCacheFolder replayed(dir.filePath(QStringLiteral("replay")));
+  QObject::connect(&replayed, &DiskCacheFolder::DeletedFrame, [&deleted](const QString&, const QByteArray& hash){
+    deleted.append(hash);
+  });
+
+  OLIVE_ASSERT(replayed.GetLimit() == 1000);
+
+  // Access order survives the replay, so `b` is still the first to go
+  replayed.SetLimit(300);
+  replayed.CreatedFile(CreateCacheFile(dir, QStringLiteral("d")), QByteArray("d"));
+
+  OLIVE_ASSERT(deleted == QList<QByteArray>({QByteArray("b")}));
+
+  OLIVE_TEST_END;
+}
+
+}
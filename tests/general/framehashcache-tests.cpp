@@ -0,0 +1,131 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "testutil.h"
+
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+
+#include "render/framehashcache.h"
+
+namespace olive {
+
+static QList<rational> Frames(const QVector<int>& indices)
+{
+  QList<rational> times;
+
+  foreach (int i, indices) {
+    times.append(rational(i, 30));
+  }
+
+  return times;
+}
+
+static QByteArray Digest(int i)
+{
+  return QCryptographicHash::hash(QByteArray::number(i), QCryptographicHash::Sha1);
+}
+
+OLIVE_ADD_TEST(FrameHashCacheReverseIndex)
+{
+  FrameHashCache cache;
+  cache.SetTimebase(rational(1, 30));
+  cache.SetLength(rational(10, 30));
+
+  QByteArray a = Digest(0);
+  QByteArray b = Digest(1);
+
+  for (int i=0; i<10; i++) {
+    cache.SetHash(rational(i, 30), (i % 2) ? b : a, 0, true);
+  }
+
+  OLIVE_ASSERT(cache.GetFramesWithHash(a) == Frames({0, 2, 4, 6, 8}));
+  OLIVE_ASSERT(cache.GetFramesWithHash(b) == Frames({1, 3, 5, 7, 9}));
+
+  // Ripple forward by three frames and back again
+  cache.Shift(rational(2, 30), rational(5, 30));
+  OLIVE_ASSERT(cache.GetFramesWithHash(a) == Frames({0, 5, 7, 9, 11}));
+  OLIVE_ASSERT(cache.GetFramesWithHash(b) == Frames({1, 6, 8, 10, 12}));
+
+  cache.Shift(rational(5, 30), rational(2, 30));
+  OLIVE_ASSERT(cache.GetFramesWithHash(a) == Frames({0, 2, 4, 6, 8}));
+  OLIVE_ASSERT(cache.GetFramesWithHash(b) == Frames({1, 3, 5, 7, 9}));
+
+  // Truncating and invalidating drop frames from the index
+  cache.SetLength(rational(6, 30));
+  OLIVE_ASSERT(cache.GetFramesWithHash(a) == Frames({0, 2, 4}));
+  OLIVE_ASSERT(cache.GetFramesWithHash(b) == Frames({1, 3, 5}));
+
+  cache.Invalidate(TimeRange(rational(2, 30), rational(4, 30)), 1);
+  OLIVE_ASSERT(cache.GetFramesWithHash(a) == Frames({0, 4}));
+  OLIVE_ASSERT(cache.GetFramesWithHash(b) == Frames({1, 5}));
+
+  // Replacing a hash moves the frame between entries
+  cache.SetHash(rational(0, 30), b, 1, true);
+  OLIVE_ASSERT(cache.GetFramesWithHash(a) == Frames({4}));
+  OLIVE_ASSERT(cache.GetFramesWithHash(b) == Frames({0, 1, 5}));
+
+  OLIVE_ASSERT(cache.TakeFramesWithHash(b) == Frames({0, 1, 5}));
+  OLIVE_ASSERT(cache.GetFramesWithHash(b).isEmpty());
+  OLIVE_ASSERT(cache.GetHash(rational(1, 30)).isEmpty());
+  OLIVE_ASSERT(cache.GetHash(rational(4, 30)) == a);
+
+  OLIVE_TEST_END;
+}
+
+OLIVE_ADD_TEST(FrameHashCacheRippleBenchmark)
+{
+  // One hour at 60 fps
+  const int frame_count = 216000;
+  const rational timebase(1, 60);
+
+  FrameHashCache cache;
+  cache.SetTimebase(timebase);
+  cache.SetLength(rational(frame_count, 60));
+
+  for (int i=0; i<frame_count; i++) {
+    cache.SetHash(rational(i, 60), Digest(i), 0, true);
+  }
+
+  QElapsedTimer timer;
+  timer.start();
+
+  // Ripple a frame in and out near the start, moving nearly every frame each time
+  const int ripple_count = 100;
+  for (int i=0; i<ripple_count; i++) {
+    cache.Shift(rational(10, 60), rational(11, 60));
+    cache.Shift(rational(11, 60), rational(10, 60));
+  }
+
+  qint64 elapsed = timer.nsecsElapsed();
+
+  OLIVE_ASSERT(cache.GetHash(rational(9, 60)) == Digest(9));
+  OLIVE_ASSERT(cache.GetHash(rational(10, 60)) == Digest(10));
+  OLIVE_ASSERT(cache.GetHash(rational(frame_count - 1, 60)) == Digest(frame_count - 1));
+
+  // The reverse index is rebuilt after the shifts
+  OLIVE_ASSERT(cache.GetFramesWithHash(Digest(5000)) == QList<rational>({rational(5000, 60)}));
+
+  std::cout << " (" << (elapsed / ripple_count / 2) / 1000 << " us per shift of " << frame_count << " frames)";
+
+  OLIVE_TEST_END;
+}
+
+}
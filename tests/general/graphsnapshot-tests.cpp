@@ -0,0 +1,80 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+#include "testutil.h"
+
+#include "node/math/math/math.h"
+#include "node/project/project.h"
+#include "render/graphsnapshot.h"
+
+namespace olive {
+
+OLIVE_ADD_TEST(GraphSnapshotReusesReleasedVersions)
+{
+  Project project;
+
+  MathNode* math = new MathNode();
+  math->setParent(&project);
+
+  std::shared_ptr<GraphSnapshotManager> manager = GraphSnapshotManager::Get(&project);
+
+  // A render pins the first version, so an edit has to be published in another one
+  GraphSnapshotPtr first = manager->Current();
+  math->SetStandardValue(MathNode::kParamAIn, 1.0);
+
+  GraphSnapshotPtr second = manager->Current();
+  OLIVE_ASSERT(second != first);
+  OLIVE_ASSERT(second->GetCopy(math)->GetStandardValue(MathNode::kParamAIn).toDouble() == 1.0);
+  OLIVE_ASSERT(first->GetCopy(math)->GetStandardValue(MathNode::kParamAIn).toDouble() != 1.0);
+
+  // Once released, the first version is brought up to date instead of copying the graph again
+  GraphSnapshot* first_version = first.get();
+  first = nullptr;
+
+  math->SetStandardValue(MathNode::kParamAIn, 2.0);
+
+  GraphSnapshotPtr third = manager->Current();
+  OLIVE_ASSERT(third.get() == first_version);
+  OLIVE_ASSERT(third->GetCopy(math)->GetStandardValue(MathNode::kParamAIn).toDouble() == 2.0);
+  OLIVE_ASSERT(second->GetCopy(math)->GetStandardValue(MathNode::kParamAIn).toDouble() == 1.0);
+
+  // A node added, changed and deleted while the second version was in use must not be touched
+  // when the second version catches up
+  GraphSnapshot* second_version = second.get();
+  second = nullptr;
+
+  MathNode* temporary = new MathNode();
+  temporary->setParent(&project);
+  temporary->SetStandardValue(MathNode::kParamAIn, 3.0);
+  temporary->setParent(nullptr);
+  delete temporary;
+
+  math->SetStandardValue(MathNode::kParamAIn, 4.0);
+
+  GraphSnapshotPtr fourth = manager->Current();
+  OLIVE_ASSERT(fourth.get() == second_version);
+  OLIVE_ASSERT(fourth->GetCopy(math)->GetStandardValue(MathNode::kParamAIn).toDouble() == 4.0);
+
+  // Nothing changed, so the same version is returned
+  OLIVE_ASSERT(manager->Current() == fourth);
+
+  OLIVE_TEST_END;
+}
+
+}
@@ -0,0 +1,98 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+#include "testutil.h"
+
+#include "codec/imagesequencereader.h"
+
+namespace olive {
+
+OLIVE_ADD_TEST(ImageSequenceReaderPrefetch)
+{
+  // No decoder has this ID so every read fails, which is enough to see what gets queued
+  ImageSequenceReader reader(QStringLiteral("none"), Decoder::CodecStream(QStringLiteral("image%04d.png"), 0), 0, 20);
+  Decoder::RetrieveVideoParams params;
+
+  OLIVE_ASSERT(reader.GetFrame(0, params) == nullptr);
+
+  // The following frames were queued with the first request
+  for (int i=1; i<=ImageSequenceReader::kPrefetchCount; i++) {
+    reader.GetFrame(i, params);
+  }
+
+  ImageSequenceReader::Statistics stats = reader.GetStatistics();
+  OLIVE_ASSERT(stats.misses == 1);
+  OLIVE_ASSERT(stats.hits == ImageSequenceReader::kPrefetchCount);
+
+  // Reversing direction has to read behind the window
+  reader.GetFrame(2, params);
+  stats = reader.GetStatistics();
+  OLIVE_ASSERT(stats.misses == 2);
+
+  reader.GetFrame(1, params);
+  stats = reader.GetStatistics();
+  OLIVE_ASSERT(stats.hits == ImageSequenceReader::kPrefetchCount + 1);
+
+  // New parameters invalidate everything read so far
+  params.divider = 2;
+  reader.GetFrame(1, params);
+  stats = reader.GetStatistics();
+  OLIVE_ASSERT(stats.misses == 3);
+
+  // Prefetching stops at the ends of the sequence
+  reader.GetFrame(19, params);
+  reader.GetFrame(20, params);
+  stats = reader.GetStatistics();
+  OLIVE_ASSERT(stats.misses == 5);
+
+  OLIVE_TEST_END;
+}
+
+OLIVE_ADD_TEST(ImageSequenceReaderConsumers)
+{
+  ImageSequenceReader reader(QStringLiteral("none"), Decoder::CodecStream(QStringLiteral("image%04d.png"), 0), 0, 0);
+
+  Decoder::RetrieveVideoParams full;
+  Decoder::RetrieveVideoParams half;
+  half.divider = 2;
+
+  // Interleaved requests with different parameters keep their own frames
+  reader.GetFrame(0, full);
+  reader.GetFrame(0, half);
+  reader.GetFrame(1, full);
+  reader.GetFrame(1, half);
+
+  ImageSequenceReader::Statistics stats = reader.GetStatistics();
+  OLIVE_ASSERT(stats.misses == 2);
+  OLIVE_ASSERT(stats.hits == 2);
+
+  // Interleaved requests far apart with the same parameters don't move each other's window
+  reader.GetFrame(100, full);
+  reader.GetFrame(2, full);
+  reader.GetFrame(101, full);
+  reader.GetFrame(3, full);
+
+  stats = reader.GetStatistics();
+  OLIVE_ASSERT(stats.misses == 3);
+  OLIVE_ASSERT(stats.hits == 5);
+
+  OLIVE_TEST_END;
+}
+
+}
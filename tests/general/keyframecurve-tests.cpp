@@ -0,0 +1,175 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "testutil.h"
+
+#include <QElapsedTimer>
+
+#include "common/lerp.h"
+#include "node/keyframecurve.h"
+
+namespace olive {
+
+namespace {
+
+NodeKeyframeTrack CreateTrack(const QVector<QPair<rational, QVariant> >& points, NodeKeyframe::Type type)
+{
+  NodeKeyframeTrack track;
+
+  for (int i=0; i<points.size(); i++) {
+    NodeKeyframe* key = new NodeKeyframe(points.at(i).first, points.at(i).second, type, 0, -1, QStringLiteral("test"));
+
+    if (!track.isEmpty()) {
+      key->set_previous(track.last());
+      track.last()->set_next(key);
+    }
+
+    track.append(key);
+  }
+
+  return track;
+}
+
+}
+
+OLIVE_ADD_TEST(KeyframeCurveLinear)
+{
+  NodeKeyframeTrack track = CreateTrack({{rational(0), 0.0}, {rational(1), 10.0}, {rational(3), 30.0}}, NodeKeyframe::kLinear);
+  KeyframeCurve curve(track, NodeValue::kFloat);
+
+  OLIVE_ASSERT(curve.count() == 3);
+  OLIVE_ASSERT(curve.ValueAt(rational(-1)).toDouble() == 0.0);
+  OLIVE_ASSERT(curve.ValueAt(rational(1, 2)).toDouble() == 5.0);
+  OLIVE_ASSERT(curve.ValueAt(rational(1)).toDouble() == 10.0);
+  OLIVE_ASSERT(curve.ValueAt(rational(2)).toDouble() == 20.0);
+  OLIVE_ASSERT(curve.ValueAt(rational(5)).toDouble() == 30.0);
+
+  // Batch evaluation must match single evaluation, sorted or not
+  QVector<rational> times = {rational(-1), rational(1, 4), rational(1), rational(5, 2), rational(1, 2), rational(4)};
+  QVector<QVariant> values = curve.ValuesAt(times);
+  for (int i=0; i<times.size(); i++) {
+    OLIVE_ASSERT(values.at(i) == curve.ValueAt(times.at(i)));
+  }
+
+  qDeleteAll(track);
+
+  OLIVE_TEST_END;
+}
+
+OLIVE_ADD_TEST(KeyframeCurveHold)
+{
+  NodeKeyframeTrack track = CreateTrack({{rational(0), 0.0}, {rational(1), 10.0}, {rational(3), 30.0}}, NodeKeyframe::kHold);
+  KeyframeCurve float_curve(track, NodeValue::kFloat);
+
+  OLIVE_ASSERT(float_curve.ValueAt(rational(1, 2)).toDouble() == 0.0);
+  OLIVE_ASSERT(float_curve.ValueAt(rational(2)).toDouble() == 10.0);
+
+  qDeleteAll(track);
+
+  // Values that can't be interpolated step from keyframe to keyframe
+  track = CreateTrack({{rational(0), QStringLiteral("a")}, {rational(1), QStringLiteral("b")}, {rational(3), QStringLiteral("c")}}, NodeKeyframe::kLinear);
+  KeyframeCurve text_curve(track, NodeValue::kText);
+
+  OLIVE_ASSERT(text_curve.ValueAt(rational(1, 2)).toString() == QStringLiteral("a"));
+  OLIVE_ASSERT(text_curve.ValueAt(rational(2)).toString() == QStringLiteral("b"));
+  OLIVE_ASSERT(text_curve.ValueAt(rational(4)).toString() == QStringLiteral("c"));
+
+  qDeleteAll(track);
+
+  OLIVE_TEST_END;
+}
+
+OLIVE_ADD_TEST(KeyframeCurveBenchmark)
+{
+  // Evaluates a 100 keyframe curve once per sample for one second of 48kHz audio, comparing a
+  // linear scan over the keyframe objects with the compiled curve
+  const int kKeyframeCount = 100;
+  const int kSampleCount = 48000;
+
+  QVector<QPair<rational, QVariant> > points;
+  for (int i=0; i<kKeyframeCount; i++) {
+    points.append({rational(i, kKeyframeCount), static_cast<double>(i % 7)});
+  }
+
+  NodeKeyframeTrack track = CreateTrack(points, NodeKeyframe::kLinear);
+  KeyframeCurve curve(track, NodeValue::kFloat);
+
+  QVector<rational> times(kSampleCount);
+  for (int i=0; i<kSampleCount; i++) {
+    times[i] = rational(i, kSampleCount);
+  }
+
+  QVector<double> scanned(kSampleCount);
+
+  QElapsedTimer timer;
+  timer.start();
+
+  for (int i=0; i<kSampleCount; i++) {
+    const rational& time = times.at(i);
+
+    if (track.last()->time() <= time) {
+      scanned[i] = track.last()->value().toDouble();
+      continue;
+    }
+
+    for (int j=0; j<track.size()-1; j++) {
+      NodeKeyframe* before = track.at(j);
+      NodeKeyframe* after = track.at(j+1);
+
+      if (before->time() <= time && after->time() > time) {
+        double progress = (time.toDouble() - before->time().toDouble()) / (after->time().toDouble() - before->time().toDouble());
+        scanned[i] = lerp(before->value().toDouble(), after->value().toDouble(), progress);
+        break;
+      }
+    }
+  }
+
+  qint64 scan_time = timer.nsecsElapsed();
+
+  timer.restart();
+
+  QVector<QVariant> single(kSampleCount);
+  for (int i=0; i<kSampleCount; i++) {
+    single[i] = curve.ValueAt(times.at(i));
+  }
+
+  qint64 single_time = timer.nsecsElapsed();
+
+  timer.restart();
+
+  QVector<QVariant> batch = curve.ValuesAt(times);
+
+  qint64 batch_time = timer.nsecsElapsed();
+
+  for (int i=0; i<kSampleCount; i++) {
+    OLIVE_ASSERT(qFuzzyCompare(1.0 + scanned.at(i), 1.0 + single.at(i).toDouble()));
+    OLIVE_ASSERT(batch.at(i) == single.at(i));
+  }
+
+  std::cout << " (scan: " << scan_time / kSampleCount << " ns/sample, curve: "
+            << single_time / kSampleCount << " ns/sample, batch: "
+            << batch_time / kSampleCount << " ns/sample)";
+
+  qDeleteAll(track);
+
+  OLIVE_TEST_END;
+}
+
+}
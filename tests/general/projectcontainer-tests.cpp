@@ -0,0 +1,181 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+#include "testutil.h"
+
+#include <QBuffer>
+#include <QDataStream>
+
+#include "node/project/projectcontainer.h"
+
+namespace olive {
+
+OLIVE_ADD_TEST(ProjectContainerRoundTrip)
+{
+  QByteArray file;
+  QByteArray big(100000, 'x');
+
+  {
+    QBuffer buffer(&file);
+    buffer.open(QIODevice::WriteOnly);
+
+    ProjectContainer::Writer writer(&buffer);
+    OLIVE_ASSERT(writer.Start(210122));
+    OLIVE_ASSERT(writer.AddChunk(ProjectContainer::kChunkInfo, QByteArrayLiteral("info")));
+    OLIVE_ASSERT(writer.AddChunk(ProjectContainer::kChunkNode, big));
+    OLIVE_ASSERT(writer.AddChunk(ProjectContainer::kChunkLayout, QByteArray()));
+    OLIVE_ASSERT(writer.Finish());
+  }
+
+  // Chunks are compressed
+  OLIVE_ASSERT(file.size() < big.size());
+
+  QBuffer buffer(&file);
+  buffer.open(QIODevice::ReadOnly);
+
+  ProjectContainer::Reader reader(&buffer);
+  OLIVE_ASSERT(reader.Open());
+  OLIVE_ASSERT(reader.project_version() == 210122);
+  OLIVE_ASSERT(reader.chunks().size() == 3);
+  OLIVE_ASSERT(reader.chunks().at(1).type == static_cast<quint32>(ProjectContainer::kChunkNode));
+
+  // Chunks can be read in any order
+  OLIVE_ASSERT(reader.ReadChunk(2).isEmpty());
+  OLIVE_ASSERT(reader.ReadChunk(1) == big);
+  OLIVE_ASSERT(reader.ReadChunk(0) == QByteArrayLiteral("info"));
+
+  OLIVE_TEST_END;
+}
+
+OLIVE_ADD_TEST(ProjectContainerTruncated)
+{
+  QByteArray file;
+
+  {
+    QBuffer buffer(&file);
+    buffer.open(QIODevice::WriteOnly);
+
+    ProjectContainer::Writer writer(&buffer);
+    writer.Start(210122);
+    writer.AddChunk(ProjectContainer::kChunkNode, QByteArrayLiteral("node"));
+    writer.Finish();
+  }
+
+  // A file that wasn't written to the end has no index
+  file.chop(1);
+
+  QBuffer buffer(&file);
+  buffer.open(QIODevice::ReadOnly);
+
+  ProjectContainer::Reader reader(&buffer);
+  OLIVE_ASSERT(!reader.Open());
+  OLIVE_ASSERT(reader.chunks().isEmpty());
+
+  // Not a container at all
+  QByteArray xml = QByteArrayLiteral("<?xml version=\"1.0\"?><olive/>");
+  QBuffer xml_buffer(&xml);
+  xml_buffer.open(QIODevice::ReadOnly);
+
+  ProjectContainer::Reader xml_reader(&xml_buffer);
+  OLIVE_ASSERT(!xml_reader.Open());
+
+  OLIVE_TEST_END;
+}
+
+OLIVE_ADD_TEST(ProjectContainerApplyDelta)
+{
+  QByteArray base_file, delta_file, merged_file;
+
+  {
+    QBuffer buffer(&base_file);
+    buffer.open(QIODevice::WriteOnly);
+
+    ProjectContainer::Writer writer(&buffer);
+    writer.Start(210122);
+    writer.AddChunk(ProjectContainer::kChunkProject, QByteArrayLiteral("old project"));
+    writer.AddChunk(ProjectContainer::kChunkProjectNode, QByteArrayLiteral("root"), 1);
+    writer.AddChunk(ProjectContainer::kChunkNode, QByteArrayLiteral("a"), 2);
+    writer.AddChunk(ProjectContainer::kChunkNode, QByteArrayLiteral("b"), 3);
+    writer.AddChunk(ProjectContainer::kChunkLayout, QByteArrayLiteral("old layout"));
+    writer.Finish();
+  }
+
+  {
+    QBuffer buffer(&delta_file);
+    buffer.open(QIODevice::WriteOnly);
+
+    QByteArray removed;
+    {
+      QDataStream stream(&removed, QIODevice::WriteOnly);
+      stream << QVector<quint64>({3});
+    }
+
+    ProjectContainer::Writer writer(&buffer);
+    writer.Start(210122);
+    writer.AddChunk(ProjectContainer::kChunkRemoved, removed);
+    writer.AddChunk(ProjectContainer::kChunkProject, QByteArrayLiteral("new project"));
+    writer.AddChunk(ProjectContainer::kChunkNode, QByteArrayLiteral("a2"), 2);
+    writer.AddChunk(ProjectContainer::kChunkNode, QByteArrayLiteral("c"), 4);
+    writer.AddChunk(ProjectContainer::kChunkLayout, QByteArrayLiteral("new layout"));
+    writer.Finish();
+  }
+
+  QBuffer base_buffer(&base_file);
+  base_buffer.open(QIODevice::ReadOnly);
+  ProjectContainer::Reader base(&base_buffer);
+  OLIVE_ASSERT(base.Open());
+
+  QBuffer delta_buffer(&delta_file);
+  delta_buffer.open(QIODevice::ReadOnly);
+  ProjectContainer::Reader delta(&delta_buffer);
+  OLIVE_ASSERT(delta.Open());
+
+  {
+    QBuffer buffer(&merged_file);
+    buffer.open(QIODevice::WriteOnly);
+
+    ProjectContainer::Writer writer(&buffer);
+    OLIVE_ASSERT(writer.Start(210122));
+    OLIVE_ASSERT(ProjectContainer::ApplyDelta(&base, &delta, &writer));
+    OLIVE_ASSERT(writer.Finish());
+  }
+
+  QBuffer merged_buffer(&merged_file);
+  merged_buffer.open(QIODevice::ReadOnly);
+  ProjectContainer::Reader merged(&merged_buffer);
+  OLIVE_ASSERT(merged.Open());
+
+  // Unchanged nodes of the base come first, followed by everything in the delta
+  QVector<QByteArray> expected = {QByteArrayLiteral("root"), QByteArrayLiteral("new project"),
+                                  QByteArrayLiteral("a2"), QByteArrayLiteral("c"),
+                                  QByteArrayLiteral("new layout")};
+
+  OLIVE_ASSERT(merged.chunks().size() == expected.size());
+
+  for (int i=0; i<expected.size(); i++) {
+    OLIVE_ASSERT(merged.ReadChunk(i) == expected.at(i));
+  }
+
+  OLIVE_ASSERT(merged.chunks().at(0).key == 1);
+  OLIVE_ASSERT(merged.FindChunk(ProjectContainer::kChunkRemoved) == -1);
+
+  OLIVE_TEST_END;
+}
+
+}
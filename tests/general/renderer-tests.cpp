@@ -0,0 +1,81 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "testutil.h"
+
+#include "countingrenderer.h"
+
+namespace olive {
+
+OLIVE_ADD_TEST(TexturePoolRecycles)
+{
+  CountingRenderer renderer;
+
+  VideoParams params(64, 64, rational(1, 30), VideoParams::kFormatFloat16, VideoParams::kRGBAChannelCount);
+  VideoParams other_params(32, 32, rational(1, 30), VideoParams::kFormatFloat16, VideoParams::kRGBAChannelCount);
+  qint64 texture_size = static_cast<qint64>(params.effective_width()) * params.effective_height() * params.GetBytesPerPixel();
+
+  QVariant first_id;
+
+  {
+    TexturePtr t = renderer.CreateTexture(params);
+    first_id = t->id();
+  }
+
+  // Released textures go back to the pool instead of being destroyed
+  OLIVE_ASSERT(renderer.textures_destroyed.load() == 0);
+  OLIVE_ASSERT(renderer.GetTexturePoolSize() == texture_size);
+
+  {
+    // Same size and format is recycled, anything else is a new allocation
+    TexturePtr same = renderer.CreateTexture(params);
+    OLIVE_ASSERT(same->id() == first_id);
+
+    TexturePtr other = renderer.CreateTexture(other_params);
+    OLIVE_ASSERT(other->id() != first_id);
+
+    OLIVE_ASSERT(renderer.GetTexturePoolSize() == 0);
+  }
+
+  OLIVE_ASSERT(renderer.textures_created.load() == 2);
+  OLIVE_ASSERT(renderer.GetTextureAllocationCount() == 2);
+  OLIVE_ASSERT(renderer.GetTextureReuseCount() == 1);
+
+  // Shrinking the budget below what's pooled frees everything
+  renderer.SetTexturePoolBudget(texture_size);
+  OLIVE_ASSERT(renderer.GetTexturePoolSize() == 0);
+  OLIVE_ASSERT(renderer.textures_destroyed.load() == 2);
+
+  {
+    TexturePtr a = renderer.CreateTexture(params);
+    TexturePtr b = renderer.CreateTexture(params);
+  }
+
+  // Only one fits in the budget, the other is destroyed straight away
+  OLIVE_ASSERT(renderer.GetTexturePoolSize() == texture_size);
+  OLIVE_ASSERT(renderer.textures_destroyed.load() == 3);
+
+  renderer.ClearTexturePool();
+  OLIVE_ASSERT(renderer.textures_destroyed.load() == 4);
+
+  OLIVE_TEST_END;
+}
+
+}
@@ -0,0 +1,120 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "testutil.h"
+
+extern "C" {
+#include <libavutil/channel_layout.h>
+}
+
+#include <QElapsedTimer>
+
+#include "render/renderjob.h"
+#include "threading/threadticket.h"
+
+namespace olive {
+
+OLIVE_ADD_TEST(RenderJobTypes)
+{
+  VideoParams vparams(64, 64, rational(1, 30), VideoParams::kFormatFloat16, VideoParams::kRGBAChannelCount);
+
+  RenderTicket ticket;
+  ticket.SetJob(std::make_shared<VideoRenderJob>(nullptr, nullptr, rational(12, 30), RenderMode::kOffline,
+                                                 vparams, AudioParams(), QSize(32, 32), QMatrix4x4(),
+                                                 VideoParams::kFormatInvalid, nullptr, QString()));
+
+  OLIVE_ASSERT(ticket.GetJob()->type() == RenderJob::kTypeVideo);
+
+  const VideoRenderJob* job = static_cast<const VideoRenderJob*>(ticket.GetJob().get());
+  OLIVE_ASSERT(job->time() == rational(12, 30));
+  OLIVE_ASSERT(job->force_size() == QSize(32, 32));
+  OLIVE_ASSERT(job->video_params().width() == 64);
+  OLIVE_ASSERT(job->cache().isEmpty());
+
+  DownloadRenderJob download(QStringLiteral("cache"), nullptr, QByteArray("hash"));
+  OLIVE_ASSERT(download.type() == RenderJob::kTypeVideoDownload);
+  OLIVE_ASSERT(download.hash() == QByteArray("hash"));
+
+  OLIVE_TEST_END;
+}
+
+OLIVE_ADD_TEST(RenderJobTicketOverhead)
+{
+  // Compares the per-ticket cost of describing a small frame render through dynamic QObject
+  // properties against a typed job, including the reads RenderProcessor does per frame
+  const int kIterations = 20000;
+
+  VideoParams vparams(64, 64, rational(1, 30), VideoParams::kFormatFloat16, VideoParams::kRGBAChannelCount);
+  AudioParams aparams(48000, AV_CH_LAYOUT_STEREO, AudioParams::kFormatFloat32);
+
+  QElapsedTimer timer;
+  qint64 checksum_property = 0;
+  qint64 checksum_typed = 0;
+
+  timer.start();
+  for (int i=0; i<kIterations; i++) {
+    RenderTicket ticket;
+    ticket.setProperty("time", QVariant::fromValue(rational(i, 30)));
+    ticket.setProperty("size", QSize(0, 0));
+    ticket.setProperty("matrix", QMatrix4x4());
+    ticket.setProperty("format", VideoParams::kFormatInvalid);
+    ticket.setProperty("vparam", QVariant::fromValue(vparams));
+    ticket.setProperty("aparam", QVariant::fromValue(aparams));
+    ticket.setProperty("cache", QString());
+
+    checksum_property += ticket.property("time").value<rational>().numerator();
+    checksum_property += ticket.property("size").value<QSize>().width();
+    checksum_property += ticket.property("format").toInt();
+    checksum_property += ticket.property("vparam").value<VideoParams>().width();
+    for (int j=0; j<4; j++) {
+      checksum_property += ticket.property("aparam").value<AudioParams>().sample_rate();
+      checksum_property += ticket.property("cache").toString().size();
+    }
+  }
+  qint64 property_time = timer.nsecsElapsed();
+
+  timer.restart();
+  for (int i=0; i<kIterations; i++) {
+    RenderTicket ticket;
+    ticket.SetJob(std::make_shared<VideoRenderJob>(nullptr, nullptr, rational(i, 30), RenderMode::kOffline,
+                                                   vparams, aparams, QSize(0, 0), QMatrix4x4(),
+                                                   VideoParams::kFormatInvalid, nullptr, QString()));
+
+    const VideoRenderJob* job = static_cast<const VideoRenderJob*>(ticket.GetJob().get());
+    checksum_typed += job->time().numerator();
+    checksum_typed += job->force_size().width();
+    checksum_typed += job->force_format();
+    checksum_typed += job->video_params().width();
+    for (int j=0; j<4; j++) {
+      checksum_typed += job->audio_params().sample_rate();
+      checksum_typed += job->cache().size();
+    }
+  }
+  qint64 typed_time = timer.nsecsElapsed();
+
+  std::cout << " (property bag: " << property_time / kIterations << " ns/ticket, typed job: "
+            << typed_time / kIterations << " ns/ticket)";
+
+  OLIVE_ASSERT(checksum_property == checksum_typed);
+
+  OLIVE_TEST_END;
+}
+
+}
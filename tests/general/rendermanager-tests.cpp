@@ -0,0 +1,186 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "testutil.h"
+
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QOpenGLContext>
+#include <QThread>
+
+#include "config/config.h"
+#include "node/distort/crop/cropdistortnode.h"
+#include "node/generator/solid/solid.h"
+#include "node/math/merge/merge.h"
+#include "node/output/viewer/viewer.h"
+#include "node/project/project.h"
+#include "render/rendermanager.h"
+
+namespace olive {
+
+/**
+ * @brief Sets an environment variable for its lifetime and restores the previous state afterwards
+ */
+class ScopedEnvironmentVariable
+{
+public:
+  ScopedEnvironmentVariable(const char* name, const QByteArray& value) :
+    name_(name),
+    was_set_(qEnvironmentVariableIsSet(name)),
+    old_value_(qgetenv(name))
+  {
+    qputenv(name_, value);
+  }
+
+  ~ScopedEnvironmentVariable()
+  {
+    if (was_set_) {
+      qputenv(name_, old_value_);
+    } else {
+      qunsetenv(name_);
+    }
+  }
+
+  DISABLE_COPY_MOVE(ScopedEnvironmentVariable)
+
+private:
+  const char* name_;
+
+  bool was_set_;
+
+  QByteArray old_value_;
+
+};
+
+/**
+ * @brief Restores a config entry to its current value when destroyed
+ */
+class ScopedConfigValue
+{
+public:
+  ScopedConfigValue(const QString& key) :
+    key_(key),
+    old_value_(Config::Current()[key])
+  {
+  }
+
+  ~ScopedConfigValue()
+  {
+    Config::Current()[key_] = old_value_;
+  }
+
+  DISABLE_COPY_MOVE(ScopedConfigValue)
+
+private:
+  QString key_;
+
+  QVariant old_value_;
+
+};
+
+OLIVE_ADD_TEST(RendererCountBenchmark)
+{
+  // Render offscreen with Mesa's software rasterizer so this runs the same without a GPU
+  ScopedEnvironmentVariable platform("QT_QPA_PLATFORM", "offscreen");
+  ScopedEnvironmentVariable software_gl("LIBGL_ALWAYS_SOFTWARE", "1");
+
+  ScopedConfigValue renderer_count_config(QStringLiteral("RendererCount"));
+
+  int argc = 1;
+  char arg0[] = "rendermanager-tests";
+  char* argv[] = {arg0, nullptr};
+  QGuiApplication app(argc, argv);
+
+  {
+    QOpenGLContext probe;
+    if (!probe.create()) {
+      std::cout << " (no OpenGL implementation available, skipped)";
+      OLIVE_TEST_END;
+    }
+  }
+
+  Project project;
+
+  ViewerOutput* viewer = new ViewerOutput();
+  viewer->setParent(&project);
+  viewer->SetVideoParams(VideoParams(640, 360, rational(1, 30), VideoParams::kFormatFloat16, VideoParams::kRGBAChannelCount));
+
+  // Animate the base so no part of the graph is cached between frames
+  SolidGenerator* base = new SolidGenerator();
+  base->setParent(&project);
+  base->SetInputIsKeyframing(SolidGenerator::kColorInput, true);
+  new NodeKeyframe(rational(0), 0.0, NodeKeyframe::kLinear, 0, -1, SolidGenerator::kColorInput, base);
+  new NodeKeyframe(rational(10), 1.0, NodeKeyframe::kLinear, 0, -1, SolidGenerator::kColorInput, base);
+
+  SolidGenerator* blend = new SolidGenerator();
+  blend->setParent(&project);
+
+  CropDistortNode* crop = new CropDistortNode();
+  crop->setParent(&project);
+  crop->SetStandardValue(CropDistortNode::kLeftInput, 0.5);
+
+  MergeNode* merge = new MergeNode();
+  merge->setParent(&project);
+
+  Node::ConnectEdge(blend, NodeInput(crop, CropDistortNode::kTextureInput));
+  Node::ConnectEdge(base, NodeInput(merge, MergeNode::kBaseIn));
+  Node::ConnectEdge(crop, NodeInput(merge, MergeNode::kBlendIn));
+  Node::ConnectEdge(merge, NodeInput(viewer, ViewerOutput::kTextureInput));
+
+  const int frame_count = 120;
+  const QVector<int> renderer_counts = {1, 2, 4};
+
+  foreach (int renderer_count, renderer_counts) {
+    Config::Current()[QStringLiteral("RendererCount")] = renderer_count;
+    RenderManager::CreateInstance();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QVector<RenderTicketPtr> tickets(frame_count);
+    for (int i=0; i<frame_count; i++) {
+      tickets[i] = RenderManager::instance()->RenderFrame(viewer, project.color_manager(), rational(i, 30), RenderMode::kOffline);
+    }
+
+    bool all_rendered = true;
+    foreach (RenderTicketPtr t, tickets) {
+      // WaitForFinished() returns immediately for tickets that haven't left the queue yet
+      while (!t->GetFinishCount()) {
+        QThread::msleep(1);
+      }
+
+      if (!t->HasResult() || !t->Get().value<FramePtr>()) {
+        all_rendered = false;
+      }
+    }
+
+    double seconds = timer.nsecsElapsed() * 1e-9;
+
+    RenderManager::DestroyInstance();
+
+    OLIVE_ASSERT(all_rendered);
+
+    std::cout << " (" << renderer_count << " renderer(s): " << frame_count / seconds << " fps)";
+  }
+
+  OLIVE_TEST_END;
+}
+
+}
@@ -0,0 +1,92 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "testutil.h"
+
+#include <QtConcurrent/QtConcurrent>
+
+#include "countingrenderer.h"
+
+#include "node/block/clip/clip.h"
+#include "node/distort/transform/transformdistortnode.h"
+#include "node/math/math/math.h"
+#include "render/shadercache.h"
+
+namespace olive {
+
+OLIVE_ADD_TEST(ShaderCacheCompilesOnce)
+{
+  // Long enough for other threads to ask for the same shader while it's compiling
+  CountingRenderer renderer(50);
+  TransformDistortNode transform;
+  ClipBlock clip;
+
+  {
+    ShaderCache cache(&renderer);
+
+    // Many threads asking for the same shader at once only compile it once
+    QVector<QFuture<QVariant> > futures;
+    for (int i=0; i<8; i++) {
+      futures.append(QtConcurrent::run([&cache, &transform]{
+        return cache.Get(&transform, QString());
+      }));
+    }
+
+    foreach (const QFuture<QVariant>& f, futures) {
+      OLIVE_ASSERT(f.result() == QVariant(1));
+    }
+
+    OLIVE_ASSERT(renderer.shaders_compiled.load() == 1);
+
+    // Both nodes use the default shader, so they share one program
+    OLIVE_ASSERT(cache.Get(&clip, QString()) == QVariant(1));
+    OLIVE_ASSERT(renderer.shaders_compiled.load() == 1);
+  }
+
+  OLIVE_ASSERT(renderer.shaders_destroyed.load() == 1);
+
+  OLIVE_TEST_END;
+}
+
+OLIVE_ADD_TEST(ShaderCachePrecompile)
+{
+  // Long enough for other threads to ask for the same shader while it's compiling
+  CountingRenderer renderer(50);
+  TransformDistortNode transform_a;
+  TransformDistortNode transform_b;
+  MathNode math;
+
+  {
+    ShaderCache cache(&renderer);
+
+    // Math's shaders depend on its inputs so it has nothing to precompile
+    cache.Precompile({&transform_a, &transform_b, &math});
+
+    // Waits for the precompiled program instead of compiling another one
+    OLIVE_ASSERT(cache.Get(&transform_b, QString()) == QVariant(1));
+    OLIVE_ASSERT(renderer.shaders_compiled.load() == 1);
+  }
+
+  OLIVE_ASSERT(renderer.shaders_destroyed.load() == 1);
+
+  OLIVE_TEST_END;
+}
+
+}
@@ -0,0 +1,103 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "testutil.h"
+
+#include <QtConcurrent/QtConcurrent>
+
+#include "render/stillimagecache.h"
+#include "render/texturecache.h"
+
+namespace olive {
+
+namespace {
+
+StillImageCache::Key CreateKey(const rational& time)
+{
+  return {Decoder::CodecStream(QStringLiteral("image.png"), 0), QStringLiteral("sRGB"), false, 1, time};
+}
+
+}
+
+OLIVE_ADD_TEST(StillImageCacheBudget)
+{
+  VideoParams params(64, 64, rational(1, 30), VideoParams::kFormatFloat16, VideoParams::kRGBAChannelCount);
+  TexturePtr texture = std::make_shared<Texture>(params);
+  qint64 texture_size = TextureCache::GetTextureSize(texture.get());
+
+  StillImageCache cache(texture_size * 2);
+  bool claimed;
+
+  // First request claims the entry, the next gets the finished texture
+  OLIVE_ASSERT(cache.Acquire(CreateKey(0), &claimed) == nullptr);
+  OLIVE_ASSERT(claimed);
+  cache.Finish(CreateKey(0), texture);
+
+  OLIVE_ASSERT(cache.Acquire(CreateKey(0), &claimed) == texture);
+  OLIVE_ASSERT(!claimed);
+
+  // Fill past the budget, the least recently used texture is dropped
+  for (int i=1; i<3; i++) {
+    cache.Acquire(CreateKey(i), &claimed);
+    OLIVE_ASSERT(claimed);
+    cache.Finish(CreateKey(i), std::make_shared<Texture>(params));
+  }
+
+  OLIVE_ASSERT(cache.GetSize() == texture_size * 2);
+  OLIVE_ASSERT(cache.Acquire(CreateKey(0), &claimed) == nullptr);
+  OLIVE_ASSERT(claimed);
+
+  // Failing to produce a texture releases the claim
+  cache.Finish(CreateKey(0), nullptr);
+  cache.Acquire(CreateKey(0), &claimed);
+  OLIVE_ASSERT(claimed);
+  cache.Finish(CreateKey(0), texture);
+
+  OLIVE_TEST_END;
+}
+
+OLIVE_ADD_TEST(StillImageCacheWaitsForWorker)
+{
+  VideoParams params(64, 64, rational(1, 30), VideoParams::kFormatFloat16, VideoParams::kRGBAChannelCount);
+  TexturePtr texture = std::make_shared<Texture>(params);
+
+  StillImageCache cache;
+  bool claimed;
+
+  cache.Acquire(CreateKey(0), &claimed);
+  OLIVE_ASSERT(claimed);
+
+  // Another thread asking for the same texture waits until it's finished
+  QFuture<TexturePtr> waiter = QtConcurrent::run([&cache]{
+    bool waiter_claimed;
+    return cache.Acquire(CreateKey(0), &waiter_claimed);
+  });
+
+  QThread::msleep(50);
+  OLIVE_ASSERT(!waiter.isFinished());
+
+  cache.Finish(CreateKey(0), texture);
+
+  OLIVE_ASSERT(waiter.result() == texture);
+
+  OLIVE_TEST_END;
+}
+
+}
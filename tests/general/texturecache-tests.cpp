@@ -0,0 +1,66 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "testutil.h"
+
+#include "render/texturecache.h"
+
+namespace olive {
+
+OLIVE_ADD_TEST(TextureCacheBudget)
+{
+  VideoParams params(64, 64, rational(1, 30), VideoParams::kFormatFloat16, VideoParams::kRGBAChannelCount);
+  qint64 texture_size = static_cast<qint64>(params.effective_width()) * params.effective_height() * params.GetBytesPerPixel();
+
+  // Room for exactly two textures
+  TextureCache cache(texture_size * 2);
+
+  TexturePtr a = std::make_shared<Texture>(params);
+  TexturePtr b = std::make_shared<Texture>(params);
+  TexturePtr c = std::make_shared<Texture>(params);
+
+  cache.Insert(QByteArray("a"), a);
+  cache.Insert(QByteArray("b"), b);
+  OLIVE_ASSERT(cache.GetSize() == texture_size * 2);
+
+  // Using `a` makes `b` the least recently used, so it's the one dropped for `c`
+  OLIVE_ASSERT(cache.Get(QByteArray("a")) == a);
+  cache.Insert(QByteArray("c"), c);
+
+  OLIVE_ASSERT(cache.Get(QByteArray("a")) == a);
+  OLIVE_ASSERT(cache.Get(QByteArray("b")) == nullptr);
+  OLIVE_ASSERT(cache.Get(QByteArray("c")) == c);
+  OLIVE_ASSERT(cache.GetSize() == texture_size * 2);
+
+  // Replacing an entry doesn't count it twice
+  cache.Insert(QByteArray("c"), b);
+  OLIVE_ASSERT(cache.Get(QByteArray("c")) == b);
+  OLIVE_ASSERT(cache.GetSize() == texture_size * 2);
+
+  // Textures larger than the budget are never stored
+  TextureCache small_cache(texture_size - 1);
+  small_cache.Insert(QByteArray("a"), a);
+  OLIVE_ASSERT(small_cache.Get(QByteArray("a")) == nullptr);
+  OLIVE_ASSERT(small_cache.GetSize() == 0);
+
+  OLIVE_TEST_END;
+}
+
+}
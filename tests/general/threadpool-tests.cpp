@@ -0,0 +1,280 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+#include "testutil.h"
+
+#include <QSemaphore>
+
+#include "threading/threadpool.h"
+
+namespace olive {
+
+/**
+ * @brief What the test pool's workers did
+ *
+ * Kept outside the pool so it outlives the workers, which are only joined in ~ThreadPool().
+ */
+struct ThreadPoolLog
+{
+  QMutex lock;
+
+  QVector<RenderTicket*> blockers;
+
+  QVector<RenderTicket*> order;
+
+  QVector<QThread*> threads;
+
+  QSemaphore blocked;
+
+  QSemaphore gate;
+
+  QSemaphore done;
+};
+
+class TestThreadPool : public ThreadPool
+{
+public:
+  TestThreadPool(ThreadPoolLog* log, int threads) :
+    ThreadPool(QThread::InheritPriority, threads),
+    log_(log)
+  {
+  }
+
+  virtual ~TestThreadPool() override
+  {
+    // Don't leave a worker blocked if a test bailed out early
+    log_->gate.release(kMaxBlockers);
+  }
+
+  virtual void RunTicket(RenderTicketPtr ticket) const override
+  {
+    log_->lock.lock();
+    bool blocker = log_->blockers.contains(ticket.get());
+    log_->lock.unlock();
+
+    if (blocker) {
+      log_->blocked.release();
+      log_->gate.acquire();
+    } else {
+      QThread::usleep(50);
+    }
+
+    log_->lock.lock();
+    log_->order.append(ticket.get());
+    log_->threads.append(QThread::currentThread());
+    log_->lock.unlock();
+
+    ticket->Finish();
+
+    if (!blocker) {
+      log_->done.release();
+    }
+  }
+
+  /**
+   * @brief Occupy a worker until Release() is called
+   *
+   * Returns once a worker is running the ticket.
+   */
+  RenderTicketPtr Block()
+  {
+    RenderTicketPtr ticket = std::make_shared<RenderTicket>();
+
+    log_->lock.lock();
+    log_->blockers.append(ticket.get());
+    log_->lock.unlock();
+
+    AddTicket(ticket, RenderTicket::kPriorityInteractive);
+    log_->blocked.acquire();
+
+    return ticket;
+  }
+
+  void Release()
+  {
+    log_->gate.release();
+  }
+
+  /**
+   * @brief Wait for `count` tickets (not counting blockers) to have run
+   */
+  bool WaitForRun(int count)
+  {
+    return log_->done.tryAcquire(count, 10000);
+  }
+
+  QVector<RenderTicket*> GetOrder()
+  {
+    QMutexLocker locker(&log_->lock);
+    return log_->order;
+  }
+
+  QThread* GetThread(RenderTicket* ticket)
+  {
+    QMutexLocker locker(&log_->lock);
+    return log_->threads.at(log_->order.indexOf(ticket));
+  }
+
+private:
+  static const int kMaxBlockers = 16;
+
+  ThreadPoolLog* log_;
+
+};
+
+OLIVE_ADD_TEST(ThreadPoolPriority)
+{
+  ThreadPoolLog log;
+  TestThreadPool pool(&log, 1);
+
+  RenderTicketPtr blocker = pool.Block();
+
+  // Queue lowest priority first, the worker must still take them highest first
+  QVector<RenderTicketPtr> tickets;
+  for (int i=RenderTicket::kPriorityCount-1; i>=0; i--) {
+    for (int j=0; j<5; j++) {
+      RenderTicketPtr t = std::make_shared<RenderTicket>();
+      pool.AddTicket(t, static_cast<RenderTicket::Priority>(i));
+      tickets.append(t);
+    }
+  }
+
+  pool.Release();
+  OLIVE_ASSERT(pool.WaitForRun(tickets.size()));
+
+  QVector<RenderTicket*> order = pool.GetOrder();
+  OLIVE_ASSERT(order.size() == tickets.size() + 1);
+  OLIVE_ASSERT(order.first() == blocker.get());
+
+  for (int i=1; i<order.size(); i++) {
+    OLIVE_ASSERT(order.at(i-1)->GetPriority() <= order.at(i)->GetPriority());
+  }
+
+  OLIVE_TEST_END;
+}
+
+OLIVE_ADD_TEST(ThreadPoolWorkStealing)
+{
+  ThreadPoolLog log;
+  TestThreadPool pool(&log, 2);
+
+  // Occupy both workers, then queue tickets that are distributed round-robin between them
+  RenderTicketPtr first_blocker = pool.Block();
+  RenderTicketPtr second_blocker = pool.Block();
+
+  const int kTickets = 20;
+
+  QVector<RenderTicketPtr> tickets(kTickets);
+  for (int i=0; i<kTickets; i++) {
+    tickets[i] = std::make_shared<RenderTicket>();
+    pool.AddTicket(tickets[i]);
+  }
+
+  // Free only one worker, it has to steal the other worker's half to finish them all
+  pool.Release();
+  OLIVE_ASSERT(pool.WaitForRun(kTickets));
+
+  QThread* runner = pool.GetThread(tickets.first().get());
+  foreach (const RenderTicketPtr& t, tickets) {
+    OLIVE_ASSERT(pool.GetThread(t.get()) == runner);
+  }
+
+  OLIVE_ASSERT(first_blocker->IsRunning() != second_blocker->IsRunning());
+
+  pool.Release();
+  first_blocker->WaitForFinished();
+  second_blocker->WaitForFinished();
+
+  OLIVE_TEST_END;
+}
+
+OLIVE_ADD_TEST(ThreadPoolCancellation)
+{
+  ThreadPoolLog log;
+  TestThreadPool pool(&log, 1);
+
+  RenderTicketPtr blocker = pool.Block();
+
+  // Running tickets can't be removed
+  OLIVE_ASSERT(!pool.RemoveTicket(blocker));
+
+  const int kTickets = 10;
+
+  QVector<RenderTicketPtr> tickets(kTickets);
+  for (int i=0; i<kTickets; i++) {
+    tickets[i] = std::make_shared<RenderTicket>();
+    pool.AddTicket(tickets[i]);
+  }
+
+  for (int i=0; i<kTickets; i+=2) {
+    OLIVE_ASSERT(pool.RemoveTicket(tickets.at(i)));
+
+    // Removing twice fails
+    OLIVE_ASSERT(!pool.RemoveTicket(tickets.at(i)));
+  }
+
+  pool.Release();
+  OLIVE_ASSERT(pool.WaitForRun(kTickets/2));
+
+  QVector<RenderTicket*> order = pool.GetOrder();
+  for (int i=0; i<kTickets; i++) {
+    bool removed = (i%2 == 0);
+    OLIVE_ASSERT(order.contains(tickets.at(i).get()) != removed);
+    OLIVE_ASSERT(tickets.at(i)->GetFinishCount() == (removed ? 0 : 1));
+  }
+
+  ThreadPool::Statistics stats = pool.GetStatistics(RenderTicket::kPriorityBackground);
+  OLIVE_ASSERT(stats.started == kTickets/2);
+  OLIVE_ASSERT(stats.removed == kTickets/2);
+
+  OLIVE_TEST_END;
+}
+
+OLIVE_ADD_TEST(ThreadPoolCancelWhileClaiming)
+{
+  const int kTickets = 2000;
+
+  ThreadPoolLog log;
+  TestThreadPool pool(&log, 4);
+
+  QVector<RenderTicketPtr> tickets(kTickets);
+  for (int i=0; i<kTickets; i++) {
+    tickets[i] = std::make_shared<RenderTicket>();
+    pool.AddTicket(tickets[i]);
+  }
+
+  // Cancel while the workers are claiming, the same way RenderTask does. A ticket that can't be
+  // removed must be running or finished, so waiting on it can't return before it has run.
+  foreach (const RenderTicketPtr& ticket, tickets) {
+    if (pool.RemoveTicket(ticket)) {
+      OLIVE_ASSERT(ticket->GetFinishCount() == 0);
+    } else {
+      ticket->WaitForFinished();
+      OLIVE_ASSERT(!ticket->IsRunning());
+      OLIVE_ASSERT(ticket->GetFinishCount() == 1);
+    }
+  }
+
+  ThreadPool::Statistics stats = pool.GetStatistics(RenderTicket::kPriorityBackground);
+  OLIVE_ASSERT(stats.started + stats.removed == kTickets);
+
+  OLIVE_TEST_END;
+}
+
+}
@@ -0,0 +1,176 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "testutil.h"
+
+#include <QElapsedTimer>
+
+#include "common/ticktime.h"
+
+namespace olive {
+
+OLIVE_ADD_TEST(TickTimeConversion)
+{
+  rational timebase(1001, 30000);
+
+  bool exact;
+  TickTime t = TickTime::fromRational(rational(1001 * 7, 30000), timebase, &exact);
+  OLIVE_ASSERT(exact);
+  OLIVE_ASSERT(t.ticks() == 7);
+  OLIVE_ASSERT(t.toRational() == rational(7007, 30000));
+
+  // Times between ticks round down, including negative ones
+  t = TickTime::fromRational(rational(1, 10), rational(1, 3), &exact);
+  OLIVE_ASSERT(!exact);
+  OLIVE_ASSERT(t.ticks() == 0);
+
+  t = TickTime::fromRational(rational(-1, 10), rational(1, 3), &exact);
+  OLIVE_ASSERT(!exact);
+  OLIVE_ASSERT(t.ticks() == -1);
+
+  // One second at 48kHz is 30 frames at 30 fps
+  TickTime second(48000, rational(1, 48000));
+  OLIVE_ASSERT(second.rescaled(rational(1, 30)) == TickTime(30, rational(1, 30)));
+
+  OLIVE_TEST_END;
+}
+
+OLIVE_ADD_TEST(TickTimeConverter)
+{
+  // Converted ticks must match a normally reduced rational, including zero and negative ticks
+  QVector<rational> timebases = {rational(1, 48000), rational(1001, 30000), rational(1, 1)};
+
+  foreach (const rational& timebase, timebases) {
+    TickTimeConverter converter(timebase);
+
+    for (int64_t i=-1000; i<=1000; i++) {
+      OLIVE_ASSERT(converter.toRational(i) == TickTime(i, timebase).toRational());
+    }
+  }
+
+  // Times off the sample timebase can still be counted in ticks of a common timebase
+  rational in(1, 30);
+  rational sample_timebase(1, 44100);
+  rational common = TickTime::commonTimebase(in, sample_timebase);
+
+  bool exact;
+  TickTime::fromRational(in, common, &exact);
+  OLIVE_ASSERT(exact);
+  TickTime::fromRational(sample_timebase, common, &exact);
+  OLIVE_ASSERT(exact);
+
+  OLIVE_TEST_END;
+}
+
+OLIVE_ADD_TEST(TickTimeArithmetic)
+{
+  rational timebase(1, 24);
+
+  TickTime a(10, timebase);
+  TickTime b = a + 5;
+
+  OLIVE_ASSERT(b - a == 5);
+  OLIVE_ASSERT(a < b);
+  OLIVE_ASSERT(b >= a);
+  OLIVE_ASSERT(a != b);
+
+  ++a;
+  a += 4;
+  OLIVE_ASSERT(a == b);
+  OLIVE_ASSERT(a.toRational() == rational(15, 24));
+
+  OLIVE_TEST_END;
+}
+
+OLIVE_ADD_TEST(TickTimeBenchmark)
+{
+  // An hour of frames at 60 fps, and a second of samples at 48kHz
+  const int frame_count = 216000;
+  const int sample_count = 48000;
+  const rational frame_timebase(1, 60);
+
+  QElapsedTimer timer;
+
+  // Stepping and comparing frame times
+  timer.start();
+
+  rational rational_time;
+  rational rational_end(frame_count, 60);
+  int rational_steps = 0;
+  while (rational_time < rational_end) {
+    rational_time += frame_timebase;
+    rational_steps++;
+  }
+
+  qint64 rational_step_time = timer.nsecsElapsed();
+  timer.restart();
+
+  TickTime tick_time(0, frame_timebase);
+  TickTime tick_end = TickTime::fromRational(rational_end, frame_timebase);
+  int tick_steps = 0;
+  while (tick_time < tick_end) {
+    ++tick_time;
+    tick_steps++;
+  }
+
+  qint64 tick_step_time = timer.nsecsElapsed();
+
+  OLIVE_ASSERT(rational_steps == frame_count);
+  OLIVE_ASSERT(tick_steps == frame_count);
+  OLIVE_ASSERT(tick_time.toRational() == rational_time);
+
+  // Generating the time of every audio sample, as RenderProcessor::ProcessSamples does
+  rational start(1, 2);
+  QVector<rational> double_times(sample_count);
+  QVector<rational> tick_times(sample_count);
+
+  timer.restart();
+
+  for (int i=0; i<sample_count; i++) {
+    double_times[i] = rational::fromDouble(start.toDouble() + static_cast<double>(i) / 48000.0);
+  }
+
+  qint64 double_sample_time = timer.nsecsElapsed();
+  timer.restart();
+
+  TickTime sample = TickTime::fromRational(start, rational(1, 48000));
+  TickTimeConverter converter(sample.timebase());
+  for (int i=0; i<sample_count; i++) {
+    tick_times[i] = converter.toRational(sample);
+    ++sample;
+  }
+
+  qint64 tick_sample_time = timer.nsecsElapsed();
+
+  bool tick_times_exact = true;
+  for (int i=0; i<sample_count; i++) {
+    tick_times_exact &= (tick_times.at(i) == start + rational(i, 48000));
+  }
+  OLIVE_ASSERT(tick_times_exact);
+
+  std::cout << " (frame steps: rational " << rational_step_time / frame_count
+            << " ns, ticks " << tick_step_time / frame_count
+            << " ns; sample times: fromDouble " << double_sample_time / sample_count
+            << " ns, ticks " << tick_sample_time / sample_count << " ns)";
+
+  OLIVE_TEST_END;
+}
+
+}
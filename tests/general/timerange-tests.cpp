@@ -0,0 +1,184 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "testutil.h"
+
+#include <QElapsedTimer>
+
+#include "common/timerange.h"
+
+namespace olive {
+
+OLIVE_ADD_TEST(TimeRangeListInsert)
+{
+  TimeRangeList list;
+
+  // Out of order inserts end up sorted
+  list.insert(TimeRange(0, 1));
+  list.insert(TimeRange(4, 5));
+  list.insert(TimeRange(2, 3));
+  OLIVE_ASSERT(list.size() == 3);
+  OLIVE_ASSERT(list.at(0) == TimeRange(0, 1));
+  OLIVE_ASSERT(list.at(1) == TimeRange(2, 3));
+  OLIVE_ASSERT(list.at(2) == TimeRange(4, 5));
+
+  // Touching ranges are merged
+  list.insert(TimeRange(1, 2));
+  OLIVE_ASSERT(list.size() == 2);
+  OLIVE_ASSERT(list.at(0) == TimeRange(0, 3));
+
+  list.insert(TimeRange(rational(7, 2), 4));
+  OLIVE_ASSERT(list.size() == 2);
+  OLIVE_ASSERT(list.at(1) == TimeRange(rational(7, 2), 5));
+
+  list.insert(TimeRange(0, 5));
+  OLIVE_ASSERT(list.size() == 1);
+  OLIVE_ASSERT(list.first() == TimeRange(0, 5));
+
+  OLIVE_ASSERT(list.contains(TimeRange(1, 2)));
+  OLIVE_ASSERT(!list.contains(TimeRange(4, 6)));
+  OLIVE_ASSERT(!list.contains(TimeRange(0, 5), false, true));
+
+  OLIVE_TEST_END;
+}
+
+OLIVE_ADD_TEST(TimeRangeListRemove)
+{
+  TimeRangeList list = {TimeRange(0, 10)};
+
+  list.remove(TimeRange(2, 3));
+  OLIVE_ASSERT(list.size() == 2);
+  OLIVE_ASSERT(list.at(0) == TimeRange(0, 2));
+  OLIVE_ASSERT(list.at(1) == TimeRange(3, 10));
+
+  // Spanning a gap trims both sides
+  list.remove(TimeRange(1, 5));
+  OLIVE_ASSERT(list.size() == 2);
+  OLIVE_ASSERT(list.at(0) == TimeRange(0, 1));
+  OLIVE_ASSERT(list.at(1) == TimeRange(5, 10));
+
+  list.remove(TimeRange(5, 6));
+  OLIVE_ASSERT(list.at(1) == TimeRange(6, 10));
+
+  // Only touching the remaining ranges does nothing
+  list.remove(TimeRange(1, 6));
+  OLIVE_ASSERT(list.size() == 2);
+
+  list.remove(TimeRange(-1, 20));
+  OLIVE_ASSERT(list.isEmpty());
+
+  OLIVE_TEST_END;
+}
+
+OLIVE_ADD_TEST(TimeRangeListIntersects)
+{
+  TimeRangeList list = {TimeRange(0, 2), TimeRange(3, 5), TimeRange(7, 9)};
+
+  TimeRangeList intersect = list.Intersects(TimeRange(1, 8));
+  OLIVE_ASSERT(intersect.size() == 3);
+  OLIVE_ASSERT(intersect.at(0) == TimeRange(1, 2));
+  OLIVE_ASSERT(intersect.at(1) == TimeRange(3, 5));
+  OLIVE_ASSERT(intersect.at(2) == TimeRange(7, 8));
+
+  OLIVE_ASSERT(list.Intersects(TimeRange(5, 7)).isEmpty());
+
+  OLIVE_TEST_END;
+}
+
+OLIVE_ADD_TEST(TimeRangeListFrameIterator)
+{
+  // Two ranges less than a frame apart share frame 2
+  TimeRangeList list = {TimeRange(0, rational(1, 4)), TimeRange(rational(7, 25), rational(1, 2))};
+  OLIVE_ASSERT(list.size() == 2);
+
+  TimeRangeListFrameIterator iterator(list, rational(1, 10));
+  OLIVE_ASSERT(iterator.size() == 5);
+
+  QVector<rational> frames = iterator.ToVector();
+  OLIVE_ASSERT(frames.size() == 5);
+
+  for (int i=0; i<frames.size(); i++) {
+    OLIVE_ASSERT(frames.at(i) == rational(i, 10));
+  }
+
+  rational t;
+  int count = 0;
+  while (iterator.GetNext(&t)) {
+    count++;
+  }
+  OLIVE_ASSERT(count == 5);
+  OLIVE_ASSERT(!iterator.HasNext());
+
+  OLIVE_TEST_END;
+}
+
+OLIVE_ADD_TEST(TimeRangeListFragmentedBenchmark)
+{
+  // One range for every other frame, inserted out of order like a cache after many edits
+  const int range_count = 20000;
+  TimeRangeList list;
+
+  QElapsedTimer timer;
+  timer.start();
+
+  for (int i=0; i<range_count; i++) {
+    int j = static_cast<int>((static_cast<int64_t>(i) * 7919) % range_count);
+    list.insert(TimeRange(rational(j * 2, 30), rational(j * 2 + 1, 30)));
+  }
+
+  qint64 insert_time = timer.nsecsElapsed();
+  OLIVE_ASSERT(list.size() == range_count);
+
+  timer.restart();
+
+  bool all_contained = true;
+  for (int i=0; i<range_count; i++) {
+    all_contained &= list.contains(TimeRange(rational(i * 2, 30), rational(i * 2 + 1, 30)));
+  }
+
+  qint64 contains_time = timer.nsecsElapsed();
+  OLIVE_ASSERT(all_contained);
+
+  timer.restart();
+
+  // Trim the second half off every range
+  for (int i=0; i<range_count; i++) {
+    list.remove(TimeRange(rational(i * 4 + 1, 60), rational(i * 4 + 2, 60)));
+  }
+
+  qint64 remove_time = timer.nsecsElapsed();
+  OLIVE_ASSERT(list.size() == range_count);
+
+  timer.restart();
+
+  int frame_count = TimeRangeListFrameIterator(list, rational(1, 60)).ToVector().size();
+
+  qint64 iterate_time = timer.nsecsElapsed();
+  OLIVE_ASSERT(frame_count == range_count);
+
+  std::cout << " (" << range_count << " ranges: insert " << insert_time / range_count
+            << " ns, contains " << contains_time / range_count
+            << " ns, remove " << remove_time / range_count
+            << " ns, frames " << iterate_time / 1000 << " us)";
+
+  OLIVE_TEST_END;
+}
+
+}
@@ -0,0 +1,240 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2021 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "testutil.h"
+
+#include <QElapsedTimer>
+
+#include "node/block/clip/clip.h"
+#include "node/math/math/math.h"
+#include "node/project/project.h"
+#include "node/project/sequence/sequence.h"
+#include "node/traverser.h"
+#include "node/valuedatabase.h"
+
+namespace olive {
+
+OLIVE_ADD_TEST(InputHandleInterning)
+{
+  InputHandle a = InputHandleRegistry::Intern(QStringLiteral("traversal_test_input"));
+  InputHandle b = InputHandleRegistry::Intern(QStringLiteral("traversal_test_input"));
+
+  OLIVE_ASSERT(a == b);
+  OLIVE_ASSERT(a != InputHandleRegistry::kGlobalHandle);
+  OLIVE_ASSERT(InputHandleRegistry::Find(QStringLiteral("traversal_test_input")) == a);
+  OLIVE_ASSERT(InputHandleRegistry::GetID(a) == QStringLiteral("traversal_test_input"));
+  OLIVE_ASSERT(InputHandleRegistry::Find(QStringLiteral("traversal_test_never_used")) == InputHandleRegistry::kInvalidHandle);
+
+  OLIVE_TEST_END;
+}
+
+OLIVE_ADD_TEST(ValueDatabaseCompatibility)
+{
+  NodeValueDatabase db;
+
+  NodeValueTable table;
+  table.Push(NodeValue::kFloat, 1.0, nullptr);
+
+  db.Insert(QStringLiteral("traversal_test_input"), table);
+
+  // String and handle access must address the same table
+  InputHandle handle = InputHandleRegistry::Find(QStringLiteral("traversal_test_input"));
+  OLIVE_ASSERT(db.contains(handle));
+  OLIVE_ASSERT(db[handle].Count() == 1);
+  OLIVE_ASSERT(!db.contains(QStringLiteral("traversal_test_never_used")));
+
+  int count = 0;
+  for (auto it=db.begin(); it!=db.end(); it++) {
+    OLIVE_ASSERT(it.key() == QStringLiteral("traversal_test_input"));
+    count++;
+  }
+  OLIVE_ASSERT(count == 1);
+
+  OLIVE_TEST_END;
+}
+
+OLIVE_ADD_TEST(ValueDatabaseHandleOrder)
+{
+  InputHandle late = InputHandleRegistry::Intern(QStringLiteral("traversal_test_late"));
+  InputHandle early = InputHandleRegistry::Intern(QStringLiteral("traversal_test_early"));
+
+  NodeValueDatabase db;
+
+  // Tables keep their own handle regardless of the order they're inserted in
+  db[late].Push(NodeValue::kFloat, 2.0, nullptr);
+  db[early].Push(NodeValue::kFloat, 1.0, nullptr);
+  db[late].Push(NodeValue::kFloat, 3.0, nullptr);
+
+  OLIVE_ASSERT(db[early].Count() == 1);
+  OLIVE_ASSERT(db[late].Count() == 2);
+  OLIVE_ASSERT(db[early].at(0).data().toDouble() == 1.0);
+
+  auto it = db.begin();
+  OLIVE_ASSERT(it.handle() == late);
+  OLIVE_ASSERT(it.value().Count() == 2);
+  it++;
+  OLIVE_ASSERT(it.handle() == early);
+  it++;
+  OLIVE_ASSERT(it == db.end());
+
+  OLIVE_TEST_END;
+}
+
+/**
+ * @brief Math node that counts how many times its value was generated
+ */
+class CountingMathNode : public MathNode
+{
+public:
+  CountingMathNode() :
+    value_count_(0)
+  {
+  }
+
+  virtual NodeValueTable Value(const QString& output, NodeValueDatabase &value) const override
+  {
+    value_count_++;
+    return MathNode::Value(output, value);
+  }
+
+  int GetValueCount() const
+  {
+    return value_count_;
+  }
+
+private:
+  mutable int value_count_;
+
+};
+
+/**
+ * @brief Traverser that exposes the per-sample input path used when rendering audio
+ */
+class SampleTraverser : public NodeTraverser
+{
+public:
+  NodeValueTable GenerateSampleInput(const Node* node, const QString& input, const rational& time)
+  {
+    return ProcessInputForSample(node, input, time);
+  }
+};
+
+OLIVE_ADD_TEST(TraversalMemoizesSharedNodes)
+{
+  Project project;
+
+  CountingMathNode* shared = new CountingMathNode();
+  shared->setParent(&project);
+
+  MathNode* consumer = new MathNode();
+  consumer->setParent(&project);
+
+  // The same node feeds both inputs, so it should only be generated once per frame
+  Node::ConnectEdge(NodeOutput(shared), NodeInput(consumer, MathNode::kParamAIn));
+  Node::ConnectEdge(NodeOutput(shared), NodeInput(consumer, MathNode::kParamBIn));
+
+  NodeTraverser traverser;
+  NodeValueTable table = traverser.GenerateTable(NodeOutput(consumer), TimeRange(0, rational(1, 30)));
+
+  OLIVE_ASSERT(table.Count() > 0);
+  OLIVE_ASSERT(shared->GetValueCount() == 1);
+
+#ifndef QT_NO_DEBUG
+  // The consumer and the shared node's first use miss, its second use hits
+  OLIVE_ASSERT(traverser.GetMemoHitCount() == 1);
+  OLIVE_ASSERT(traverser.GetMemoMissCount() == 2);
+#endif
+
+  // A new frame starts from an empty memo
+  traverser.GenerateTable(NodeOutput(consumer), TimeRange(0, rational(1, 30)));
+  OLIVE_ASSERT(shared->GetValueCount() == 2);
+
+  OLIVE_TEST_END;
+}
+
+OLIVE_ADD_TEST(TraversalSkipsMemoForSamples)
+{
+  Project project;
+
+  CountingMathNode* shared = new CountingMathNode();
+  shared->setParent(&project);
+
+  MathNode* consumer = new MathNode();
+  consumer->setParent(&project);
+
+  Node::ConnectEdge(NodeOutput(shared), NodeInput(consumer, MathNode::kParamAIn));
+  Node::ConnectEdge(NodeOutput(shared), NodeInput(consumer, MathNode::kParamBIn));
+
+  SampleTraverser traverser;
+
+  // Per-sample inputs are generated every time they're asked for rather than kept in the memo
+  traverser.GenerateSampleInput(consumer, MathNode::kParamAIn, 0);
+  traverser.GenerateSampleInput(consumer, MathNode::kParamBIn, 0);
+  OLIVE_ASSERT(shared->GetValueCount() == 2);
+
+  // Whole ranges are still memoized afterwards
+  traverser.GenerateTable(NodeOutput(consumer), TimeRange(0, rational(1, 30)));
+  OLIVE_ASSERT(shared->GetValueCount() == 3);
+
+  OLIVE_TEST_END;
+}
+
+OLIVE_ADD_TEST(TraversalBenchmark)
+{
+  // Traverses a 500 clip timeline once per clip and prints the average time per traversal
+  const int kClipCount = 500;
+
+  Project project;
+  Sequence sequence;
+  sequence.setParent(&project);
+  sequence.add_default_nodes();
+
+  Track* track = sequence.GetTracks().first();
+
+  for (int i=0; i<kClipCount; i++) {
+    ClipBlock* clip = new ClipBlock();
+    clip->set_length_and_media_out(1);
+    clip->setParent(&project);
+    track->AppendBlock(clip);
+  }
+
+  OLIVE_ASSERT(track->Blocks().size() == kClipCount);
+
+  NodeTraverser traverser;
+
+  NodeOutput output = sequence.GetConnectedTextureOutput();
+  rational frame_length(1, 30);
+
+  QElapsedTimer timer;
+  timer.start();
+
+  for (int i=0; i<kClipCount; i++) {
+    rational time(i * 2 + 1, 2);
+    traverser.GenerateTable(output, TimeRange(time, time + frame_length));
+  }
+
+  qint64 elapsed = timer.nsecsElapsed();
+
+  std::cout << " (" << elapsed / kClipCount << " ns/traversal)";
+
+  OLIVE_TEST_END;
+}
+
+}